@@ -0,0 +1,25 @@
+#version 330 core
+
+// Passe plein écran du rendu deferred : lumière directionnelle et SpotLights, une fois par pixel
+in vec2 TexCoords;
+
+out vec4 FragColor;
+
+#include "frameData.glsl"
+#include "lighting.glsl"
+#include "gBufferRead.glsl"
+
+void main()
+{
+    Surface surface;
+    if (!ReadSurface(TexCoords, surface))
+        discard;
+
+    vec3 viewDir = normalize(viewPos.xyz - surface.position);
+
+    vec3 result = CalcDirLight(dirLight, surface, viewDir);
+    for(int i = 0; i < numSpotLights; i++)
+        result += CalcSpotLight(FetchSpotLight(i), surface, viewDir);
+
+    FragColor = vec4(result, 1.0);
+}
@@ -0,0 +1,6 @@
+#version 330 core
+
+// Aucune couleur écrite : seule la profondeur compte
+void main()
+{
+}
@@ -0,0 +1,16 @@
+#version 330 core
+
+// Passe de profondeur : seul le flux des positions est lu
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 aInstanceModel;
+
+invariant gl_Position;
+
+#include "frameData.glsl"
+#include "vertexFormat.glsl"
+
+void main()
+{
+    vec3 fragPos = vec3(aInstanceModel * vec4(decodePosition(aPos), 1.0));
+    gl_Position = projection * view * vec4(fragPos, 1.0);
+}
@@ -0,0 +1,6 @@
+// Données de la frame, partagées par tous les programmes via un UBO
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos;
+};
@@ -0,0 +1,34 @@
+#version 330 core
+
+// Passe géométrie du rendu deferred : on écrit les propriétés de la surface dans le G-buffer
+layout (location = 0) out vec4 gPosition;
+layout (location = 1) out vec4 gNormal;
+layout (location = 2) out vec4 gAlbedoSpec;
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+
+struct Material {
+    sampler2D texture_diffuse1;
+#ifdef HAS_SPECULAR_MAP
+    sampler2D texture_specular1;
+#endif
+    float shininess;
+};
+uniform Material material;
+
+void main()
+{
+    // alpha = 1 : un objet a été dessiné sur ce pixel
+    gPosition = vec4(FragPos, 1.0);
+    // La brillance est stockée dans l'alpha de la normale
+    gNormal = vec4(normalize(Normal), material.shininess);
+    gAlbedoSpec.rgb = texture(material.texture_diffuse1, TexCoords).rgb;
+    // Variante sans texture spéculaire (voir ShaderVariants) : pas de reflet
+#ifdef HAS_SPECULAR_MAP
+    gAlbedoSpec.a = texture(material.texture_specular1, TexCoords).r;
+#else
+    gAlbedoSpec.a = 0.0;
+#endif
+}
@@ -0,0 +1,20 @@
+// Lecture du G-buffer pour les passes d'éclairage du rendu deferred (nécessite lighting.glsl)
+
+uniform sampler2D gPosition;
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedoSpec;
+
+// Lit la surface stockée dans le G-buffer, renvoie false si aucun objet n'a été dessiné sur ce pixel
+bool ReadSurface(vec2 uv, out Surface surface)
+{
+    vec4 position = texture(gPosition, uv);
+    vec4 normal = texture(gNormal, uv);
+    vec4 albedoSpec = texture(gAlbedoSpec, uv);
+
+    surface.position = position.xyz;
+    surface.normal = normal.xyz;
+    surface.shininess = normal.w;
+    surface.albedo = albedoSpec.rgb;
+    surface.specular = vec3(albedoSpec.a);
+    return position.w != 0.0;
+}
@@ -1,10 +1,10 @@
 #version 330 core
 
-out vec4 FragColor;
+in vec3 LightColor;
 
-uniform vec3 lightColor;
+out vec4 FragColor;
 
 void main()
 {
-    FragColor = vec4(lightColor, 1.0);
-}
\ No newline at end of file
+    FragColor = vec4(LightColor, 1.0);
+}
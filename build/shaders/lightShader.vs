@@ -1,12 +1,16 @@
 #version 330 core
 
 layout (location = 0) in vec3 aPos;
+// Données d'instance : une matrice de modèle et une couleur par cube
+layout (location = 1) in mat4 aInstanceModel;
+layout (location = 5) in vec3 aInstanceColor;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+out vec3 LightColor;
+
+#include "frameData.glsl"
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-}
\ No newline at end of file
+    gl_Position = projection * view * aInstanceModel * vec4(aPos, 1.0);
+    LightColor = aInstanceColor;
+}
@@ -0,0 +1,26 @@
+#version 330 core
+
+// Éclairage d'une PointLight du rendu deferred : seuls les pixels couverts par son volume sont évalués
+flat in int LightIndex;
+
+out vec4 FragColor;
+
+#include "frameData.glsl"
+#include "lighting.glsl"
+#include "gBufferRead.glsl"
+
+uniform vec2 screenSize;
+
+void main()
+{
+    Surface surface;
+    if (!ReadSurface(gl_FragCoord.xy / screenSize, surface))
+        discard;
+
+    PointLight light = FetchPointLight(LightIndex);
+    if (distance(light.position, surface.position) > light.range)
+        discard;
+
+    vec3 viewDir = normalize(viewPos.xyz - surface.position);
+    FragColor = vec4(CalcPointLight(light, surface, viewDir), 1.0);
+}
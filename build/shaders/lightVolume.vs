@@ -0,0 +1,20 @@
+#version 330 core
+
+// Volume d'une PointLight du rendu deferred : une sphère par instance, de la taille de la portée de la lumière
+layout (location = 0) in vec3 aPos;
+
+flat out int LightIndex;
+
+#include "frameData.glsl"
+#include "lighting.glsl"
+
+// Agrandit la sphère pour que ses faces (et pas seulement ses sommets) englobent la portée
+uniform float volumeScale;
+
+void main()
+{
+    PointLight light = FetchPointLight(gl_InstanceID);
+    LightIndex = gl_InstanceID;
+    vec3 worldPos = light.position + aPos * light.range * volumeScale;
+    gl_Position = projection * view * vec4(worldPos, 1.0);
+}
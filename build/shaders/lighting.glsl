@@ -0,0 +1,174 @@
+// Données et fonctions d'éclairage communes au rendu forward et au rendu deferred
+
+// Les structures suivent le layout std140 : chaque vec3 est complété par un float
+struct DirLight {
+    vec3 direction;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct PointLight {    
+    vec3 position;
+    float constant;
+    vec3 ambient;
+    float linear;
+    vec3 diffuse;
+    float quadratic;
+    vec3 specular;
+    float range;
+};
+
+struct SpotLight {
+    vec3 position;
+    float constant;
+    vec3 direction;
+    float linear;
+    vec3 ambient;
+    float quadratic;
+    vec3 diffuse;
+    float cosCutOff;
+    vec3 specular;
+    float cosOuterCutOff;
+};
+
+// Lumière directionnelle, nombre de lumières et paramètres de la grille de clusters, envoyés via un UBO
+layout (std140) uniform Lights {
+    DirLight dirLight;
+    int numPointLights;
+    int numSpotLights;
+    // Tuiles en x, tuiles en y, tranches de profondeur, mode clustered activé
+    ivec4 clusterGrid;
+    // Échelle et biais de la tranche (slice = log(profondeur) * x + y), taille d'une tuile en pixels (z, w)
+    vec4 clusterParams;
+};
+
+// Tableaux de lumières de taille quelconque, stockés dans des texture buffers RGBA32F
+// (4 texels par PointLight, 5 texels par SpotLight, dans l'ordre des champs des structures)
+uniform samplerBuffer pointLightData;
+uniform samplerBuffer spotLightData;
+
+// Propriétés de la surface éclairée, lues une seule fois par fragment
+struct Surface {
+    vec3 position;
+    vec3 normal;
+    vec3 albedo;
+    vec3 specular;
+    float shininess;
+};
+
+PointLight FetchPointLight(int index)
+{
+    int base = index * 4;
+    vec4 t0 = texelFetch(pointLightData, base);
+    vec4 t1 = texelFetch(pointLightData, base + 1);
+    vec4 t2 = texelFetch(pointLightData, base + 2);
+    vec4 t3 = texelFetch(pointLightData, base + 3);
+
+    PointLight light;
+    light.position = t0.xyz;
+    light.constant = t0.w;
+    light.ambient = t1.xyz;
+    light.linear = t1.w;
+    light.diffuse = t2.xyz;
+    light.quadratic = t2.w;
+    light.specular = t3.xyz;
+    light.range = t3.w;
+    return light;
+}
+
+SpotLight FetchSpotLight(int index)
+{
+    int base = index * 5;
+    vec4 t0 = texelFetch(spotLightData, base);
+    vec4 t1 = texelFetch(spotLightData, base + 1);
+    vec4 t2 = texelFetch(spotLightData, base + 2);
+    vec4 t3 = texelFetch(spotLightData, base + 3);
+    vec4 t4 = texelFetch(spotLightData, base + 4);
+
+    SpotLight light;
+    light.position = t0.xyz;
+    light.constant = t0.w;
+    light.direction = t1.xyz;
+    light.linear = t1.w;
+    light.ambient = t2.xyz;
+    light.quadratic = t2.w;
+    light.diffuse = t3.xyz;
+    light.cosCutOff = t3.w;
+    light.specular = t4.xyz;
+    light.cosOuterCutOff = t4.w;
+    return light;
+}
+
+// Reflet spéculaire d'une lumière (NO_SPECULAR : la surface n'en a pas, rien n'est calculé)
+vec3 CalcSpecular(vec3 lightSpecular, vec3 lightDir, Surface surface, vec3 viewDir)
+{
+#ifdef NO_SPECULAR
+    return vec3(0.0);
+#else
+    vec3 reflectDir = reflect(-lightDir, surface.normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), surface.shininess);
+    return lightSpecular * spec * surface.specular;
+#endif
+}
+
+vec3 CalcDirLight(DirLight light, Surface surface, vec3 viewDir)
+{
+    vec3 lightDir = normalize(-light.direction);
+    // Diffuse
+    float diff = max(dot(surface.normal, lightDir), 0.0);
+    // On combine les résultats
+    vec3 ambient  = light.ambient  * surface.albedo;
+    vec3 diffuse  = light.diffuse  * diff * surface.albedo;
+    vec3 specular = CalcSpecular(light.specular, lightDir, surface, viewDir);
+    return (ambient + diffuse + specular);
+}
+
+vec3 CalcPointLight(PointLight light, Surface surface, vec3 viewDir)
+{
+    // Calcul de l'éclairage ambiant
+    vec3 ambient  = light.ambient  * surface.albedo;
+
+    // Calcul de l'éclairage diffus
+    vec3 lightDir = normalize(light.position - surface.position);
+    float diff = max(dot(surface.normal, lightDir), 0.0);
+    vec3 diffuse = light.diffuse * surface.albedo * diff;
+
+    // Calcul de l'éclairage spéculaire
+    vec3 specular = CalcSpecular(light.specular, lightDir, surface, viewDir);
+
+    // Calcul de l'atténuation
+    float distance = length(light.position - surface.position);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+
+    // On combine les résultats
+    ambient *= attenuation;
+    diffuse *= attenuation;
+    specular *= attenuation;
+
+    return (ambient + diffuse + specular);
+}
+
+vec3 CalcSpotLight(SpotLight light, Surface surface, vec3 viewDir)
+{
+    vec3 lightDir = normalize(light.position - surface.position);
+    // Diffuse
+    float diff = max(dot(surface.normal, lightDir), 0.0);
+    // Atténuation
+    float distance = length(light.position - surface.position);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+    // Intensité
+    float cosTheta = dot(lightDir, normalize(-light.direction));
+    float epsilon = light.cosCutOff - light.cosOuterCutOff;
+    float intensity = clamp((cosTheta - light.cosOuterCutOff) / epsilon, 0.0, 1.0);
+    // On combine les résultats
+    vec3 ambient = light.ambient * surface.albedo;
+    vec3 diffuse = light.diffuse * diff * surface.albedo;
+    vec3 specular = CalcSpecular(light.specular, lightDir, surface, viewDir);
+    ambient *= attenuation * intensity;
+    diffuse *= attenuation * intensity;
+    specular *= attenuation * intensity;
+
+    return (ambient + diffuse + specular);
+}
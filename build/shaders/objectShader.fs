@@ -9,145 +9,92 @@ out vec4 FragColor;
 struct Material {
     vec3 ambient;
     sampler2D texture_diffuse1;
+#ifdef HAS_SPECULAR_MAP
     sampler2D texture_specular1;
+#endif
     float shininess;
 };
 uniform Material material;
 
-struct DirLight {
-    vec3 direction;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-uniform DirLight dirLight;
-
-struct PointLight {    
-    vec3 position;
-
-    float constant;
-    float linear;
-    float quadratic;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-#define NR_POINT_LIGHTS 5
-uniform PointLight pointLights[NR_POINT_LIGHTS];
-
-struct SpotLight {
-    vec3 position;
-    vec3 direction;
-    float cosCutOff;
-    float cosOuterCutOff;
-
-    float constant;
-    float linear;
-    float quadratic;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-#define NR_SPOT_LIGHTS 4
-uniform SpotLight spotLights[NR_SPOT_LIGHTS];
-
-uniform vec3 viewPos;
-
-// Prototypes des fonctions
-
-vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-
-void main()
+// Variantes (voir ShaderVariants) :
+//   HAS_SPECULAR_MAP : le matériau a une texture spéculaire. Sans elle, la surface n'a pas de reflet
+//                      et les termes spéculaires ne sont pas calculés.
+//   LIGHTING_CLUSTERED : seules les lumières du cluster du fragment sont parcourues
+//   NUM_POINT_LIGHTS, NUM_SPOT_LIGHTS : nombre fixe de lumières (boucles déroulables, une boucle vide disparaît)
+// Sans define d'éclairage, le mode et le nombre de lumières sont lus dans le bloc Lights.
+#ifndef HAS_SPECULAR_MAP
+#define NO_SPECULAR
+#endif
+
+#include "frameData.glsl"
+#include "lighting.glsl"
+
+// Mode clustered : pour chaque cluster (offset, nombre de PointLights, nombre de SpotLights) dans la liste d'indices
+uniform usamplerBuffer clusterData;
+uniform usamplerBuffer clusterLightIndices;
+
+// Lumières du cluster qui contient le fragment
+vec3 CalcClusterLights(Surface surface, vec3 viewDir)
 {
-    vec3 norm = normalize(Normal);
-    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 result = vec3(0.0);
+    float viewDepth = -(view * vec4(surface.position, 1.0)).z;
+    int slice = clamp(int(floor(log(viewDepth) * clusterParams.x + clusterParams.y)), 0, clusterGrid.z - 1);
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / clusterParams.zw), ivec2(0), clusterGrid.xy - 1);
+    uvec4 cluster = texelFetch(clusterData, tile.x + clusterGrid.x * (tile.y + clusterGrid.y * slice));
+
+    int offset = int(cluster.x);
+    for(int i = 0; i < int(cluster.y); i++)
+        result += CalcPointLight(FetchPointLight(int(texelFetch(clusterLightIndices, offset + i).r)), surface, viewDir);
+
+    offset += int(cluster.y);
+    for(int i = 0; i < int(cluster.z); i++)
+        result += CalcSpotLight(FetchSpotLight(int(texelFetch(clusterLightIndices, offset + i).r)), surface, viewDir);
+    return result;
+}
 
-    // Directional light
-    vec3 result = CalcDirLight(dirLight, norm, viewDir);
-    
+// Toutes les PointLights et SpotLights
+vec3 CalcAllLights(int pointLightCount, int spotLightCount, Surface surface, vec3 viewDir)
+{
+    vec3 result = vec3(0.0);
     // Point lights
-    for(int i = 0; i < NR_POINT_LIGHTS; i++)
-        result += CalcPointLight(pointLights[i], norm, FragPos, viewDir);
+    for(int i = 0; i < pointLightCount; i++)
+        result += CalcPointLight(FetchPointLight(i), surface, viewDir);
 
     // Spot lights
-    for(int i = 0; i < NR_SPOT_LIGHTS; i++)
-        result += CalcSpotLight(spotLights[i], norm, FragPos, viewDir);
-
-    FragColor = vec4(result, 1.0);
+    for(int i = 0; i < spotLightCount; i++)
+        result += CalcSpotLight(FetchSpotLight(i), surface, viewDir);
+    return result;
 }
 
-// Définition des fonctions
-
-vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
+void main()
 {
-    vec3 lightDir = normalize(-light.direction);
-    // Diffuse
-    float diff = max(dot(normal, lightDir), 0.0);
-    // Specular
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    // On combine les résultats
-    vec3 ambient  = light.ambient  * texture(material.texture_diffuse1, TexCoords).rgb;
-    vec3 diffuse  = light.diffuse  * diff * texture(material.texture_diffuse1, TexCoords).rgb;
-    vec3 specular = light.specular * spec * texture(material.texture_specular1, TexCoords).rgb;
-    return (ambient + diffuse + specular);
-}
+    // Les textures ne sont lues qu'une fois par fragment, puis partagées par toutes les lumières
+    Surface surface;
+    surface.position = FragPos;
+    surface.normal = normalize(Normal);
+    surface.albedo = texture(material.texture_diffuse1, TexCoords).rgb;
+#ifdef HAS_SPECULAR_MAP
+    surface.specular = texture(material.texture_specular1, TexCoords).rgb;
+#else
+    surface.specular = vec3(0.0);
+#endif
+    surface.shininess = material.shininess;
+
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
 
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
-{
-    // Calcul de l'éclairage ambiant
-    vec3 ambient  = light.ambient  * texture(material.texture_diffuse1, TexCoords).rgb;
-    // vec3 ambient = light.ambient * material.ambient;
-
-    // Calcul de l'éclairage diffus
-    vec3 lightDir = normalize(light.position - fragPos);
-    float diff = max(dot(normal, lightDir), 0.0);
-    vec3 diffuse = light.diffuse * texture(material.texture_diffuse1, TexCoords).rgb * diff;
-
-    // Calcul de l'éclairage spéculaire
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    vec3 specular = light.specular * texture(material.texture_specular1, TexCoords).rgb * spec;
-
-    // Calcul de l'atténuation
-    float distance = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
-
-    // On combine les résultats
-    ambient *= attenuation;
-    diffuse *= attenuation;
-    specular *= attenuation;
-
-    return (ambient + diffuse + specular);
-}
+    // Directional light
+    vec3 result = CalcDirLight(dirLight, surface, viewDir);
+
+#if defined(LIGHTING_CLUSTERED)
+    result += CalcClusterLights(surface, viewDir);
+#elif defined(NUM_POINT_LIGHTS) && defined(NUM_SPOT_LIGHTS)
+    result += CalcAllLights(NUM_POINT_LIGHTS, NUM_SPOT_LIGHTS, surface, viewDir);
+#else
+    if (clusterGrid.w != 0)
+        result += CalcClusterLights(surface, viewDir);
+    else
+        result += CalcAllLights(numPointLights, numSpotLights, surface, viewDir);
+#endif
 
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
-{
-    vec3 lightDir = normalize(light.position - fragPos);
-    // Diffuse
-    float diff = max(dot(normal, lightDir), 0.0);
-    // Specular
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    // Atténuation
-    float distance = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
-    // Intensité
-    float cosTheta = dot(lightDir, normalize(-light.direction));
-    float epsilon = light.cosCutOff - light.cosOuterCutOff;
-    float intensity = clamp((cosTheta - light.cosOuterCutOff) / epsilon, 0.0, 1.0);
-    // On combine les résultats
-    vec3 ambient = light.ambient * texture(material.texture_diffuse1, TexCoords).rgb;
-    vec3 diffuse = light.diffuse * diff * texture(material.texture_diffuse1, TexCoords).rgb;
-    vec3 specular = light.specular * spec * texture(material.texture_specular1, TexCoords).rgb;
-    ambient *= attenuation * intensity;
-    diffuse *= attenuation * intensity;
-    specular *= attenuation * intensity;
-
-    return (ambient + diffuse + specular);
-}
\ No newline at end of file
+    FragColor = vec4(result, 1.0);
+}
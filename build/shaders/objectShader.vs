@@ -1,21 +1,26 @@
 #version 330 core
 
+// Sommets compacts : position (unorm16 ou half), normale octaédrique (snorm16), UV (half)
 layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
+layout (location = 1) in vec2 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+// Matrice de modèle de l'instance (locations 3 à 6)
+layout (location = 3) in mat4 aInstanceModel;
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// Même calcul que depthShader.vs : la passe de profondeur doit donner exactement les mêmes profondeurs
+invariant gl_Position;
+
+#include "frameData.glsl"
+#include "vertexFormat.glsl"
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-    Normal = mat3(transpose(inverse(model))) * aNormal;
-    FragPos = vec3(model * vec4(aPos, 1.0));
+    FragPos = vec3(aInstanceModel * vec4(decodePosition(aPos), 1.0));
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+    Normal = mat3(transpose(inverse(aInstanceModel))) * decodeNormal(aNormal);
     TexCoords = aTexCoords;
-}
\ No newline at end of file
+}
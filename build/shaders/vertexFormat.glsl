@@ -0,0 +1,20 @@
+// Décodage des sommets compacts (voir PackedVertex dans vertexFormat.hpp)
+// Position : quantifiée dans la boîte englobante du mesh (offset = min, scale = taille) ou en demi-flottants (offset = 0, scale = 1).
+// Le décodage vient des données d'instance pour les meshes du pool de géométrie, d'une valeur constante de l'attribut sinon.
+layout (location = 7) in vec3 aPositionOffset;
+layout (location = 8) in vec3 aPositionScale;
+
+vec3 decodePosition(vec3 position)
+{
+    return aPositionOffset + position * aPositionScale;
+}
+
+// Normale en encodage octaédrique : le carré [-1, 1]² est replié sur l'octaèdre puis projeté sur la sphère
+vec3 decodeNormal(vec2 encoded)
+{
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
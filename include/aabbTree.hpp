@@ -0,0 +1,84 @@
+#ifndef AABBTREE_HPP
+#define AABBTREE_HPP
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "bounds.hpp"
+#include "frustum.hpp"
+
+// Hiérarchie de volumes englobants dynamique (arbre binaire de AABB).
+// Chaque feuille (proxy) contient une boîte élargie d'une marge : un objet qui bouge peu ne modifie pas l'arbre.
+// Les boîtes élargies ne servent qu'à parcourir l'arbre : les requêtes testent les feuilles avec leur boîte exacte
+// (sauf queryFrustum, conservatif, dont les résultats sont de toute façon re-testés par le rendu).
+// L'insertion choisit le frère qui minimise l'augmentation de surface et rééquilibre par rotations ;
+// rebuild() reconstruit tout l'arbre avec l'heuristique SAH quand sa qualité s'est dégradée.
+// Cette classe n'utilise pas OpenGL.
+class AABBTree
+{
+public:
+    static constexpr int NULL_NODE = -1;
+
+    explicit AABBTree(float margin = 0.1f) : margin(margin) {}
+
+    // Ajoute une feuille et renvoie son identifiant (proxy)
+    int createProxy(const AABB &box, void *userData);
+    void destroyProxy(int proxy);
+    // Met à jour la boîte d'une feuille. Renvoie true si l'arbre a été modifié (la boîte sortait de la boîte élargie).
+    bool moveProxy(int proxy, const AABB &box);
+
+    void *getUserData(int proxy) const { return nodes[proxy].userData; }
+    const AABB &getFatAABB(int proxy) const { return nodes[proxy].box; }
+    size_t getProxyCount() const { return proxyCount; }
+    int getHeight() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+    // Somme des surfaces des noeuds divisée par la surface de la racine (plus c'est bas, meilleur est l'arbre)
+    float getAreaRatio() const;
+
+    // Reconstruction complète par SAH (les identifiants des proxies sont conservés)
+    void rebuild();
+    void clear();
+
+    // Feuilles dont la boîte touche le frustum
+    void queryFrustum(const Frustum &frustum, std::vector<void *> &results) const;
+    // Feuilles dont la boîte touche la sphère
+    void querySphere(const glm::vec3 &center, float radius, std::vector<void *> &results) const;
+    // Au moins une feuille touche-t-elle la sphère ?
+    bool overlapsSphere(const glm::vec3 &center, float radius) const;
+    // Feuille la plus proche touchée par le rayon (direction normalisée), nullptr sinon
+    void *raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, float *hitDistance) const;
+    // Les k feuilles les plus proches du point (distance point / boîte), de la plus proche à la plus lointaine
+    void queryNearest(const glm::vec3 &point, size_t k, std::vector<void *> &results) const;
+
+private:
+    struct Node
+    {
+        AABB box;
+        // Boîte exacte d'une feuille (sans la marge) : impacts des rayons, distances et tests des sphères
+        AABB tightBox;
+        void *userData = nullptr;
+        int parent = NULL_NODE; // ou le noeud libre suivant quand le noeud est dans la liste libre
+        int left = NULL_NODE;
+        int right = NULL_NODE;
+        int height = 0; // 0 pour une feuille, -1 pour un noeud libre
+
+        bool isLeaf() const { return left == NULL_NODE; }
+    };
+
+    std::vector<Node> nodes;
+    int root = NULL_NODE;
+    int freeList = NULL_NODE;
+    size_t proxyCount = 0;
+    float margin;
+
+    int allocateNode();
+    void freeNode(int node);
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    int balance(int node);
+    void refit(int node);
+    int buildSAH(std::vector<int> &leaves, size_t begin, size_t end);
+    void addSubtree(int node, std::vector<void *> &results) const;
+};
+
+#endif
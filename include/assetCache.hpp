@@ -0,0 +1,88 @@
+#ifndef ASSETCACHE_HPP
+#define ASSETCACHE_HPP
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "shader.hpp"
+#include "glState.hpp"
+#include "model.hpp"
+#include "jobSystem.hpp"
+
+// Texture OpenGL partagée : elle est supprimée quand le dernier mesh qui l'utilise disparaît
+struct TextureAsset
+{
+    unsigned int id = 0;
+    // Vrai quand l'image est sur le GPU (ou que son chargement a échoué) : id vaut 0 avant
+    std::atomic<bool> ready{false};
+
+    TextureAsset() = default;
+    TextureAsset(const TextureAsset &) = delete;
+    TextureAsset &operator=(const TextureAsset &) = delete;
+    ~TextureAsset()
+    {
+        if (id != 0)
+            GLState::deleteTextures(1, &id);
+    }
+};
+
+// Liste des textures d'un matériau avec le sampler de chacune ("material.texture_diffuse1", ...)
+using MaterialKey = std::vector<std::pair<const TextureAsset *, std::string>>;
+
+// Matériau partagé par les meshes qui ont la même liste de textures : son identifiant regroupe leurs draws
+// dans la file de rendu. L'identifiant est rendu quand le dernier mesh qui l'utilise disparaît.
+struct MaterialAsset
+{
+    unsigned int id = 0;
+    MaterialKey key;
+};
+
+// Registre global des modèles, textures et shaders, indexé par chemin canonique.
+// Les ressources sont distribuées par shared_ptr et le registre ne garde que des weak_ptr :
+// chaque fichier n'est chargé qu'une fois, et libéré quand plus personne ne l'utilise.
+class AssetCache
+{
+public:
+    // Après cet appel, modèles et textures sont lus et décodés sur les threads de jobs,
+    // et envoyés au GPU par la file du thread OpenGL : les ressources renvoyées ne sont pas encore prêtes
+    static void enableAsyncLoading(JobSystem &jobs, MainThreadQueue &uploads);
+    static void disableAsyncLoading();
+
+    static std::shared_ptr<Model> loadModel(const std::string &path, bool flipTextureVertically);
+    // Appelable depuis un thread de travail en mode asynchrone (l'envoi au GPU est alors différé)
+    static std::shared_ptr<TextureAsset> loadTexture(const std::string &path, bool flipVertically);
+    static std::shared_ptr<Shader> loadShader(const std::string &vertexPath, const std::string &fragmentPath);
+    // Texture 1x1 noire partagée, liée à la place de la texture spéculaire des matériaux qui n'en ont pas
+    // (sur le thread OpenGL)
+    static std::shared_ptr<TextureAsset> getBlackTexture();
+    // Matériau de cette liste de textures (les textures doivent rester en vie tant que le matériau est utilisé).
+    // Les identifiants sont réutilisés : ils restent inférieurs au nombre de matériaux en vie.
+    static std::shared_ptr<MaterialAsset> getMaterial(const MaterialKey &key);
+
+    // Chemin absolu et normalisé ("a/./b/../c.png" et "a/c.png" donnent la même clé)
+    static std::string canonicalPath(const std::string &path);
+
+private:
+    static std::unordered_map<std::string, std::weak_ptr<Model>> models;
+    static std::unordered_map<std::string, std::weak_ptr<TextureAsset>> textures;
+    static std::unordered_map<std::string, std::weak_ptr<Shader>> shaders;
+    static std::mutex modelsMutex, texturesMutex, shadersMutex;
+    static std::weak_ptr<TextureAsset> blackTexture;
+    static std::map<MaterialKey, std::weak_ptr<MaterialAsset>> materials;
+    static std::vector<unsigned int> freeMaterialIds;
+    static unsigned int nextMaterialId;
+    static std::mutex materialsMutex;
+
+    static void releaseMaterial(MaterialAsset *material);
+
+    static JobSystem *jobs;
+    static MainThreadQueue *uploads;
+};
+
+#endif
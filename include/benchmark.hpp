@@ -0,0 +1,37 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "instancedRenderer.hpp"
+
+// Résultats du mode "--bench" : temps de chargement, durée de chaque frame mesurée (GPU compris, la frame se termine
+// par glFinish) et statistiques de rendu. Écrits en JSON avec la configuration pour comparer deux commits.
+class BenchmarkReport
+{
+public:
+    // Options de la ligne de commande et driver : deux résultats ne se comparent qu'à configuration égale
+    void setConfiguration(const std::string &name, const std::string &value);
+    // Temps (ms) d'une étape du chargement ("contexte", "shaders", "scene"...)
+    void addLoadTime(const std::string &name, double milliseconds);
+    void addFrame(double milliseconds, const RenderStats &stats, size_t glCalls);
+
+    size_t getFrameCount() const { return frameTimes.size(); }
+    // Affiche le résumé (percentiles des durées de frame)
+    void print() const;
+    bool writeJson(const std::string &path) const;
+
+private:
+    std::vector<std::pair<std::string, std::string>> configuration;
+    std::vector<std::pair<std::string, double>> loadTimes;
+    std::vector<double> frameTimes;
+    // Moyennes sur les frames mesurées
+    double drawCalls = 0.0, triangles = 0.0, visibleObjects = 0.0, programSwitches = 0.0, glCalls = 0.0;
+
+    // Durée de frame au centile percent (0 à 100)
+    double percentile(const std::vector<double> &sorted, double percent) const;
+};
+
+#endif
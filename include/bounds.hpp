@@ -0,0 +1,32 @@
+#ifndef BOUNDS_HPP
+#define BOUNDS_HPP
+
+#include <cstddef>
+#include <glm/glm.hpp>
+
+// Boîte englobante alignée sur les axes
+struct AABB
+{
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+
+    glm::vec3 getCenter() const { return 0.5f * (min + max); }
+    glm::vec3 getExtents() const { return 0.5f * (max - min); }
+};
+
+struct BoundingSphere
+{
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+};
+
+// Boîte englobante d'un tableau de positions (les sommets sont lus avec un pas de stride octets)
+AABB computeAABB(const void *positions, size_t count, size_t stride);
+// Sphère centrée sur la boîte, de rayon la distance au sommet le plus éloigné
+BoundingSphere computeBoundingSphere(const void *positions, size_t count, size_t stride, const AABB &box);
+// Union de deux boîtes
+AABB mergeAABB(const AABB &a, const AABB &b);
+// Boîte (alignée sur les axes du monde) qui englobe la boîte transformée par la matrice
+AABB transformAABB(const glm::mat4 &matrix, const AABB &box);
+
+#endif
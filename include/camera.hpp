@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "constants.hpp"
+#include "frustum.hpp"
 
 // Une classe de caméra abstraite qui traite les entrées et calcule les angles d'Euler, les vecteurs et les matrices correspondants pour une utilisation dans OpenGL
 class Camera
@@ -20,12 +21,18 @@ public:
     // Renvoie la matrice de vue calculée à l'aide des angles d'Euler et de la matrice LookAt
     glm::mat4 getViewMatrix();
 
+    // Renvoie les plans du frustum de la caméra (extraits de projection * vue)
+    Frustum getFrustum(const glm::mat4 &projection);
+
     float getZoom() { return _zoom; }
 
     glm::vec3 getPosition() { return _position; }
 
     glm::vec3 getFront() { return _front; }
 
+    // Place la caméra en position, regard tourné vers target (chemins scriptés du mode "--bench")
+    void setPose(const glm::vec3 &position, const glm::vec3 &target);
+
     // Traite l'entrée reçue de tout système d'entrée de type clavier. Accepte le paramètre d'entrée sous la forme d'une énumération définie par la caméra.
     void processKeyboard(CameraMovement direction, float deltaTime);
 
@@ -0,0 +1,32 @@
+#ifndef CAMERAPATH_HPP
+#define CAMERAPATH_HPP
+
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+// Chemin fermé de la caméra pour le mode "--bench" : une spline de Catmull-Rom passe par les points de passage
+// (position et point regardé), parcourus à vitesse constante par segment. Le même temps donne toujours la même vue.
+class CameraPath
+{
+public:
+    // Une ligne par point de passage : "x y z cibleX cibleY cibleZ"
+    bool load(const std::string &path);
+    void addKey(const glm::vec3 &position, const glm::vec3 &target);
+    // Tour de la scène sur un cercle, quand aucun fichier de chemin n'est fourni
+    void makeOrbit(const glm::vec3 &center, float radius, float height, int keyCount);
+
+    bool empty() const { return keys.empty(); }
+    // t : fraction du tour (bouclée sur [0, 1[)
+    void sample(float t, glm::vec3 &position, glm::vec3 &target) const;
+
+private:
+    struct Key
+    {
+        glm::vec3 position;
+        glm::vec3 target;
+    };
+    std::vector<Key> keys;
+};
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef CLUSTERGRID_HPP
+#define CLUSTERGRID_HPP
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "workerPool.hpp"
+
+// Volume d'influence d'une lumière : une sphère dans l'espace monde
+struct LightVolume
+{
+    glm::vec3 position;
+    float radius; // une portée nulle retire la lumière de tous les clusters
+};
+
+// Plage de la liste d'indices de lumières appartenant à un cluster
+// (les indices des PointLights sont suivis de ceux des SpotLights)
+struct ClusterRange
+{
+    uint32_t offset;
+    uint32_t pointCount;
+    uint32_t spotCount;
+    uint32_t padding;
+};
+
+// Découpe le frustum de la caméra en une grille 3D de clusters (tuiles écran x tranches de profondeur exponentielles)
+// et répartit les lumières dans les clusters qu'elles touchent.
+// Cette classe n'utilise pas OpenGL : le binning peut être exécuté et testé sans GPU.
+class ClusterGrid
+{
+public:
+    ClusterGrid(int tilesX, int tilesY, int slicesZ);
+
+    // Calcule les boîtes englobantes (espace vue) des clusters. Ne fait rien si la projection n'a pas changé.
+    void setProjection(float fovY, float aspect, float nearPlane, float farPlane);
+
+    // Répartit les lumières (sphères en espace monde) dans les clusters, sur threadCount threads
+    // (gardés d'une frame à l'autre tant que threadCount ne change pas)
+    void build(const glm::mat4 &view, const std::vector<LightVolume> &pointLights, const std::vector<LightVolume> &spotLights, unsigned int threadCount);
+
+    int getTilesX() const { return tilesX; }
+    int getTilesY() const { return tilesY; }
+    int getSlicesZ() const { return slicesZ; }
+    float getNearPlane() const { return nearPlane; }
+    float getFarPlane() const { return farPlane; }
+    // Paramètres pour retrouver la tranche depuis la profondeur d en espace vue : slice = floor(log(d) * scale + bias)
+    float getSliceScale() const { return sliceScale; }
+    float getSliceBias() const { return sliceBias; }
+
+    int getClusterIndex(int x, int y, int z) const { return x + tilesX * (y + tilesY * z); }
+    int getSlice(float viewDepth) const;
+
+    const std::vector<ClusterRange> &getClusters() const { return clusters; }
+    const std::vector<uint32_t> &getLightIndices() const { return lightIndices; }
+
+private:
+    // Boîte englobante d'un cluster en espace vue
+    struct ClusterBounds
+    {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    // Lumière transformée en espace vue avec la plage de tranches qu'elle touche
+    struct ViewLight
+    {
+        glm::vec3 position;
+        float radius;
+        int firstSlice;
+        int lastSlice;
+    };
+
+    int tilesX, tilesY, slicesZ;
+    float fovY = 0.0f, aspect = 0.0f, nearPlane = 0.0f, farPlane = 0.0f;
+    float tanHalfFovY = 0.0f, tanHalfFovX = 0.0f;
+    float sliceScale = 0.0f, sliceBias = 0.0f;
+
+    std::vector<ClusterBounds> bounds;
+    // Profondeur (positive) du début de chaque tranche, sliceDepths[slicesZ] = farPlane
+    std::vector<float> sliceDepths;
+
+    std::vector<ViewLight> viewPointLights;
+    std::vector<ViewLight> viewSpotLights;
+    // Listes de lumières par cluster, gardées d'une frame à l'autre pour ne pas ré-allouer
+    std::vector<std::vector<uint32_t>> clusterPointLights;
+    std::vector<std::vector<uint32_t>> clusterSpotLights;
+
+    std::vector<ClusterRange> clusters;
+    std::vector<uint32_t> lightIndices;
+
+    std::unique_ptr<WorkerPool> workerPool;
+
+    void transformLights(const glm::mat4 &view, const std::vector<LightVolume> &lights, std::vector<ViewLight> &viewLights) const;
+    void binSlice(int slice);
+    void binLightInSlice(const ViewLight &light, uint32_t lightIndex, int slice, std::vector<std::vector<uint32_t>> &clusterLights);
+};
+
+#endif
@@ -29,9 +29,24 @@ constexpr float PITCH_LIMIT = 89.0f;
 constexpr const char * OBJECT_VERTEX_SHADER_PATH = "shaders/objectShader.vs";
 constexpr const char * OBJECT_FRAGMENT_SHADER_PATH = "shaders/objectShader.fs";
 
+// Passe de profondeur ("--depth-prepass") : ne lit que le flux des positions des meshes
+constexpr const char * DEPTH_VERTEX_SHADER_PATH = "shaders/depthShader.vs";
+constexpr const char * DEPTH_FRAGMENT_SHADER_PATH = "shaders/depthShader.fs";
+
 constexpr const char * LIGHT_VERTEX_SHADER_PATH = "shaders/lightShader.vs";
 constexpr const char * LIGHT_FRAGMENT_SHADER_PATH = "shaders/lightShader.fs";
 
+// Rendu deferred ("--deferred") : la passe géométrie réutilise le vertex shader des objets
+constexpr const char * GBUFFER_VERTEX_SHADER_PATH = "shaders/objectShader.vs";
+constexpr const char * GBUFFER_FRAGMENT_SHADER_PATH = "shaders/gBuffer.fs";
+constexpr const char * DEFERRED_LIGHTING_VERTEX_SHADER_PATH = "shaders/deferredLighting.vs";
+constexpr const char * DEFERRED_LIGHTING_FRAGMENT_SHADER_PATH = "shaders/deferredLighting.fs";
+constexpr const char * LIGHT_VOLUME_VERTEX_SHADER_PATH = "shaders/lightVolume.vs";
+constexpr const char * LIGHT_VOLUME_FRAGMENT_SHADER_PATH = "shaders/lightVolume.fs";
+
+// Dossier du cache des programmes compilés (un fichier par programme, voir ProgramCache)
+constexpr const char * SHADER_CACHE_DIRECTORY = "shaderCache";
+
 constexpr const char * TEXTURE_1_PATH = "resources/textures/wall.jpg";
 constexpr const char * TEXTURE_2_PATH = "resources/textures/smiley.png";
 
@@ -59,6 +74,103 @@ constexpr float LIGHT_SPEED = 2.5f;
 
 constexpr glm::vec3 LIGHT_SOURCE_POSITION(1.2f, 1.0f, -2.0f);
 
+// Brillance du matériau des objets
+constexpr float MATERIAL_SHININESS = 32.0f;
+
+// Portée maximale envoyée au GPU pour une lumière (une lumière sans atténuation a une portée infinie)
+constexpr float MAX_LIGHT_RANGE = 1000.0f;
+
+// Rendu deferred : subdivisions de la sphère des volumes de PointLights et agrandissement pour que ses faces englobent la portée
+constexpr int LIGHT_VOLUME_STACKS = 8;
+constexpr int LIGHT_VOLUME_SLICES = 12;
+constexpr float LIGHT_VOLUME_SCALE = 1.15f;
+
+// Lumière directionnelle
+constexpr glm::vec3 DIR_LIGHT_DIRECTION(-0.2f, -1.0f, -0.3f);
+constexpr glm::vec3 DIR_LIGHT_AMBIENT(0.05f, 0.05f, 0.05f);
+constexpr glm::vec3 DIR_LIGHT_DIFFUSE(0.4f, 0.4f, 0.4f);
+constexpr glm::vec3 DIR_LIGHT_SPECULAR(0.5f, 0.5f, 0.5f);
+
+// Spot Light attachée à la caméra (lampe torche)
+constexpr float CAMERA_SPOT_LIGHT_CUTOFF = 12.5f;
+constexpr float CAMERA_SPOT_LIGHT_OUTER_CUTOFF = 15.0f;
+
+// Unités de texture réservées aux texture buffers des lumières (les textures des meshes utilisent les premières unités)
+constexpr unsigned int POINT_LIGHTS_TEXTURE_UNIT = 8;
+constexpr unsigned int SPOT_LIGHTS_TEXTURE_UNIT = 9;
+constexpr unsigned int CLUSTER_DATA_TEXTURE_UNIT = 10;
+constexpr unsigned int CLUSTER_INDICES_TEXTURE_UNIT = 11;
+
+// Mode "--clustered" : taille de la grille de clusters (tuiles en x, en y et tranches de profondeur)
+constexpr int CLUSTER_GRID_X = 16;
+constexpr int CLUSTER_GRID_Y = 9;
+constexpr int CLUSTER_GRID_Z = 24;
+
+// Mode "--lights N" : zone dans laquelle les PointLights sont générées
+constexpr glm::vec3 STRESS_LIGHTS_AREA_MIN(-20.0f, -5.0f, -20.0f);
+constexpr glm::vec3 STRESS_LIGHTS_AREA_MAX(20.0f, 5.0f, 20.0f);
+
+// Chargement asynchrone des assets : temps maximal passé par frame à envoyer les meshes et textures au GPU
+constexpr double ASSET_UPLOAD_BUDGET_MS = 2.0;
+
+// Intervalle (en secondes) de mise à jour des statistiques affichées dans le titre de la fenêtre
+constexpr float STATS_TITLE_INTERVAL = 0.5f;
+
+// BVH de la scène : marge ajoutée autour des boîtes des objets (un petit déplacement ne modifie pas l'arbre)
+// et dégradation tolérée (rapport des surfaces) avant une reconstruction complète
+constexpr float SCENE_BVH_MARGIN = 0.1f;
+constexpr float SCENE_BVH_REBUILD_RATIO = 1.5f;
+
+// Occlusion culling logiciel (mode "--occlusion") : résolution du tampon de profondeur et nombre maximal de triangles d'un occulteur
+constexpr int OCCLUSION_BUFFER_WIDTH = 256;
+constexpr int OCCLUSION_BUFFER_HEIGHT = 144;
+constexpr size_t OCCLUDER_MAX_TRIANGLES = 4096;
+
+// Niveaux de détail des meshes : nombre maximal de LODs (générés à l'import, chacun avec environ deux fois moins de triangles),
+// taille à l'écran (rayon projeté / demi-hauteur de l'écran) en dessous de laquelle on passe au LOD suivant,
+// et marge autour de ces seuils pour ne pas alterner entre deux LODs d'une frame à l'autre
+constexpr int MESH_LOD_COUNT = 4;
+constexpr float MESH_LOD_SCREEN_SIZES[MESH_LOD_COUNT - 1] = {0.4f, 0.2f, 0.1f};
+constexpr float MESH_LOD_HYSTERESIS = 0.15f;
+// Un LOD qui garde plus de cette fraction des triangles du précédent n'est pas conservé
+constexpr float MESH_LOD_MIN_REDUCTION = 0.85f;
+
+// Pool de géométrie (mode "--geometry-pool") : capacités en sommets (16 octets) et en indices (16 bits).
+// Les meshes qui n'y tiennent plus gardent leurs propres buffers.
+constexpr size_t GEOMETRY_POOL_VERTEX_CAPACITY = 4 * 1024 * 1024;
+constexpr size_t GEOMETRY_POOL_INDEX_CAPACITY = 16 * 1024 * 1024;
+
+// Profiler ("--profile", "--trace fichier.json") : nombre de frames entre une mesure GPU et sa lecture (anneau de requêtes),
+// nombre de mesures gardées par scope pour les statistiques et nombre maximal de frames de la chronologie exportée
+constexpr size_t PROFILER_FRAME_LATENCY = 4;
+constexpr size_t PROFILER_HISTORY_FRAMES = 600;
+constexpr size_t PROFILER_TRACE_MAX_FRAMES = 3000;
+
+// Mode "--bench N" : chemin de la caméra (points de passage et cibles), durée d'un tour du chemin (s), pas de temps fixe (s),
+// frames non mesurées au début (caches, compilations tardives du driver) et fichier de résultats par défaut
+constexpr const char * CAMERA_PATH_PATH = "resources/CameraPath.txt";
+constexpr float BENCHMARK_PATH_DURATION = 20.0f;
+constexpr float BENCHMARK_TIMESTEP = 1.0f / 60.0f;
+constexpr int BENCHMARK_WARMUP_FRAMES = 30;
+constexpr int BENCHMARK_DEFAULT_FRAMES = 1200;
+constexpr const char * BENCHMARK_OUTPUT_PATH = "benchmark.json";
+
+// Mode "--replay-input fichier" : pas de temps fixe (s) avec lequel les entrées enregistrées sont rejouées
+constexpr float INPUT_REPLAY_TIMESTEP = 1.0f / 60.0f;
+
+// Capture OpenGL ("--gl-trace fichier N") : frames de mise en place avant la capture (chargements, premières compilations)
+// et nombre de frames capturées par défaut ; rejeu ("--replay-trace fichier N") : nombre de passages par défaut
+constexpr int GL_TRACE_FIRST_FRAME = 60;
+constexpr int GL_TRACE_DEFAULT_FRAMES = 1;
+constexpr int GL_TRACE_REPLAY_LOOPS = 200;
+
+// Distance maximale de sélection d'un GameObject avec la touche P
+constexpr float PICKING_DISTANCE = 100.0f;
+
+// Points de liaison des Uniform Buffer Objects
+constexpr unsigned int FRAME_UBO_BINDING = 0;
+constexpr unsigned int LIGHTS_UBO_BINDING = 1;
+
 enum CameraMovement
 {
     FORWARD,
@@ -0,0 +1,118 @@
+#ifndef COOKEDMESH_HPP
+#define COOKEDMESH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "hash.hpp"
+#include "mesh.hpp"
+#include "occlusionBuffer.hpp"
+
+// Format binaire des modèles précompilés ("cuisinés") à partir des fichiers lus par Assimp.
+// Les sommets sont stockés au format compact envoyé au GPU : le chargement n'a plus qu'à copier les plages projetées.
+// Disposition du fichier :
+//   CookedMeshHeader
+//   CookedMeshEntry[meshCount]
+//   CookedTextureEntry[textureCount]
+//   CookedLodEntry[somme des lodCount des meshes]
+//   table des chaînes (types et chemins des textures)
+//   sommets compacts de tous les meshes (tableaux de PackedVertex), alignés sur 16 octets
+//   flux des positions seules de tous les meshes (4 uint16_t par sommet)
+//   indices de tous les meshes (uint16_t ou unsigned int selon le mesh, alignés sur 4 octets)
+//   occulteur du modèle (positions en float puis indices en unsigned int)
+// Tous les offsets sont relatifs au début du fichier, sauf ceux des chaînes (relatifs à la table des chaînes).
+
+constexpr char COOKED_MESH_MAGIC[4] = {'Y', 'M', 'S', 'H'};
+// À incrémenter à chaque changement du format, de la structure PackedVertex, de l'encodage des sommets
+// ou des traitements de l'import (optimisations, LODs, occulteur)
+constexpr uint32_t COOKED_MESH_VERSION = 5;
+// Le fichier précompilé est écrit à côté du fichier source ("modele.obj" -> "modele.obj.ymesh")
+constexpr const char *COOKED_MESH_EXTENSION = ".ymesh";
+
+struct CookedMeshHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t vertexSize; // sizeof(PackedVertex) au moment de la cuisson
+    uint32_t meshCount;
+    uint32_t textureCount;
+    uint32_t stringTableSize;
+    // Identification du fichier source : taille et date pour une vérification rapide, hash du contenu sinon
+    uint64_t sourceSize;
+    int64_t sourceModifiedTime;
+    uint64_t sourceHash;
+    // Encodage des positions (PositionEncoding) : un fichier cuisiné avec un autre encodage est recuisiné
+    uint32_t positionEncoding;
+    // Occulteur du modèle (0 triangle si le modèle ne peut pas en servir)
+    uint32_t occluderVertexCount;
+    uint32_t occluderIndexCount;
+    uint32_t padding;
+    uint64_t occluderVertexOffset;
+    uint64_t occluderIndexOffset;
+};
+
+struct CookedMeshEntry
+{
+    uint64_t vertexOffset;
+    uint64_t positionOffset;
+    uint64_t indexOffset;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexSize; // 2 (uint16_t) si le mesh a au plus 65536 sommets, 4 sinon
+    uint32_t firstTexture;
+    uint32_t textureCount;
+    // Nombre de LODs du mesh (au moins 1), dont les entrées suivent celles du mesh précédent
+    uint32_t lodCount;
+    // Volumes englobants dans l'espace du modèle (la sphère est centrée sur la boîte)
+    float boundsMin[3];
+    float boundsMax[3];
+    float boundingRadius;
+    // Décodage des positions compactes (PositionDecode)
+    float decodeOffset[3];
+    float decodeScale[3];
+    uint32_t padding;
+};
+
+struct CookedTextureEntry
+{
+    uint32_t typeOffset;
+    uint32_t typeLength;
+    uint32_t pathOffset;
+    uint32_t pathLength;
+};
+
+// Plage d'indices d'un LOD, relative aux indices du mesh
+struct CookedLodEntry
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float error;
+    uint32_t padding;
+};
+
+static_assert(sizeof(CookedMeshHeader) == 80, "CookedMeshHeader doit faire 80 octets");
+static_assert(sizeof(CookedMeshEntry) == 104, "CookedMeshEntry doit faire 104 octets");
+static_assert(sizeof(CookedTextureEntry) == 16, "CookedTextureEntry doit faire 16 octets");
+static_assert(sizeof(CookedLodEntry) == 16, "CookedLodEntry doit faire 16 octets");
+
+// Description du fichier source enregistrée dans l'en-tête
+struct CookedSourceInfo
+{
+    uint64_t size = 0;
+    int64_t modifiedTime = 0;
+    uint64_t hash = 0;
+};
+
+// Lit la taille et la date du fichier source, et son hash si computeHash est vrai. Renvoie false si le fichier n'existe pas.
+bool readCookedSourceInfo(const std::string &sourcePath, CookedSourceInfo &info, bool computeHash);
+
+// Le fichier précompilé correspond-il encore à la source ? (la date seule ne suffit pas à l'invalider : on compare alors le contenu)
+bool isCookedMeshUpToDate(const CookedMeshHeader &header, const std::string &sourcePath);
+
+// Écrit les meshes (données compactes de Mesh::packMeshData, références de textures) et l'occulteur dans un fichier précompilé
+bool writeCookedMesh(const std::string &cookedPath, const CookedSourceInfo &source, const std::vector<MeshData> &meshes,
+                     const OccluderMesh &occluder);
+
+#endif
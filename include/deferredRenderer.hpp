@@ -0,0 +1,49 @@
+#ifndef DEFERREDRENDERER_HPP
+#define DEFERREDRENDERER_HPP
+
+#include <glad/glad.h>
+
+#include "shader.hpp"
+#include "shaderVariants.hpp"
+#include "lightBuffer.hpp"
+
+// Rendu deferred : une passe géométrie remplit le G-buffer (position, normale, albedo et specular),
+// puis les lumières sont évaluées une seule fois par pixel visible au lieu d'une fois par fragment dessiné.
+// Chaque PointLight n'éclaire que les pixels couverts par sa sphère de portée (volumes dessinés en un seul appel instancié).
+class DeferredRenderer
+{
+public:
+    // Crée le G-buffer et les shaders, et relie les blocs d'uniforms communs
+    // (shaderVariants faux : la passe géométrie utilise un seul programme pour tous les matériaux)
+    void create(int width, int height, const FrameDataBuffer &frameDataBuffer, LightBuffer &lightBuffer, bool shaderVariants);
+    // Passe géométrie : le G-buffer (redimensionné si besoin) devient la cible de rendu, renvoie les shaders à utiliser
+    ShaderVariants &beginGeometryPass(int width, int height);
+    const ShaderVariants &getGeometryShaders() const { return geometryShaders; }
+    ShaderVariants &getGeometryShaders() { return geometryShaders; }
+    // Passe d'éclairage dans le framebuffer par défaut, puis recopie de la profondeur pour les passes forward suivantes
+    void lightingPass(int pointLightCount);
+    // Suppression des ressources OpenGL
+    void deleteResources();
+
+private:
+    // G-buffer
+    unsigned int gBufferFBO = 0;
+    unsigned int gPosition = 0, gNormal = 0, gAlbedoSpec = 0;
+    unsigned int depthRBO = 0;
+    int width = 0, height = 0;
+
+    ShaderVariants geometryShaders;
+    Shader lightingShader;
+    Shader lightVolumeShader;
+
+    // VAO vide du triangle plein écran et sphère des volumes de lumière
+    unsigned int fullscreenVAO = 0;
+    unsigned int sphereVAO = 0, sphereVBO = 0, sphereEBO = 0;
+    unsigned int sphereIndexCount = 0;
+
+    void createGBuffer();
+    void deleteGBuffer();
+    void createSphere();
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef FRUSTUM_HPP
+#define FRUSTUM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "bounds.hpp"
+
+// Les 6 plans du frustum de la caméra (normales vers l'intérieur, normalisées), extraits de la matrice vue-projection
+class Frustum
+{
+public:
+    enum Plane
+    {
+        LEFT_PLANE,
+        RIGHT_PLANE,
+        BOTTOM_PLANE,
+        TOP_PLANE,
+        NEAR_PLANE,
+        FAR_PLANE,
+        PLANE_COUNT
+    };
+
+    Frustum() = default;
+    explicit Frustum(const glm::mat4 &viewProjection);
+
+    // Plan sous la forme (normale, distance) : un point p est à l'intérieur si dot(normale, p) + distance >= 0
+    const glm::vec4 &getPlane(int plane) const { return planes[plane]; }
+
+    bool intersects(const AABB &box) const;
+    bool intersects(const BoundingSphere &sphere) const;
+    // Teste count boîtes à la fois (4 par 4 avec SSE) : visible[i] vaut 1 si la boîte i touche le frustum, 0 sinon
+    void intersects(const AABB *boxes, size_t count, uint8_t *visible) const;
+
+private:
+    glm::vec4 planes[PLANE_COUNT];
+};
+
+#endif
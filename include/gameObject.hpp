@@ -9,45 +9,85 @@
 #include <memory>
 
 #include "model.hpp"
+#include "assetCache.hpp"
 #include "shader.hpp"
+#include "bounds.hpp"
 
 using namespace std;
 
+class Scene;
+
 class GameObject
 {
 public:
+    // Les modèles peuvent être chargés en arrière-plan (voir AssetCache::enableAsyncLoading)
+    enum class LoadState
+    {
+        Loading,
+        Ready
+    };
+
     // Constructeur principal
-    GameObject(string name, string path, bool flipTextureVertically, Shader &shader, glm::mat4 modelMatrix, std::vector<std::unique_ptr<GameObject>> &gameObjects);
+    GameObject(string name, string path, bool flipTextureVertically, Shader &shader, glm::mat4 modelMatrix, Scene &scene);
 
     // Constructeur sans nom (utilise le chemin comme nom)
-    GameObject(string path, bool flipTextureVertically, Shader &shader, glm::mat4 modelMatrix, std::vector<std::unique_ptr<GameObject>> &gameObjects)
-        : GameObject("", path, flipTextureVertically, shader, modelMatrix, gameObjects) {}
+    GameObject(string path, bool flipTextureVertically, Shader &shader, glm::mat4 modelMatrix, Scene &scene)
+        : GameObject("", path, flipTextureVertically, shader, modelMatrix, scene) {}
 
     // Constructeur sans transformation (utilise une matrice identité)
-    GameObject(string name, string path, bool flipTextureVertically, Shader &shader, std::vector<std::unique_ptr<GameObject>> &gameObjects)
-        : GameObject(name, path, flipTextureVertically, shader, glm::mat4(1.0f), gameObjects) {}
+    GameObject(string name, string path, bool flipTextureVertically, Shader &shader, Scene &scene)
+        : GameObject(name, path, flipTextureVertically, shader, glm::mat4(1.0f), scene) {}
 
     // Constructeur sans nom et sans transformation
-    GameObject(string path, bool flipTextureVertically, Shader &shader, std::vector<std::unique_ptr<GameObject>> &gameObjects)
-        : GameObject("", path, flipTextureVertically, shader, glm::mat4(1.0f), gameObjects) {}
-
-    ~GameObject() { graphicModel.CleanUp(); }
+    GameObject(string path, bool flipTextureVertically, Shader &shader, Scene &scene)
+        : GameObject("", path, flipTextureVertically, shader, glm::mat4(1.0f), scene) {}
 
     void Draw();
+    // Dessine l'objet avec un autre shader que le sien (ex : passe géométrie du rendu deferred)
+    void Draw(Shader &shader);
 
     string getName() { return name; }
+    // Modèle partagé avec les autres GameObjects chargés à partir du même fichier
+    Model *getModel() { return graphicModel.get(); }
+    // Ready quand le modèle et ses textures sont sur le GPU
+    LoadState getLoadState() { return graphicModel->isReady() ? LoadState::Ready : LoadState::Loading; }
+
+    const glm::mat4 &getModelMatrix() const { return modelMatrix; }
+    // Les transformations préviennent la scène pour qu'elle remette à jour sa BVH
+    void modelMatrixTranslate(glm::vec3 translation);
+    void modelMatrixRotate(float angle, glm::vec3 axis);
+    void modelMatrixScale(glm::vec3 scale);
 
-    glm::mat4 getModelMatrix() { return modelMatrix; }
-    void modelMatrixTranslate(glm::vec3 translation) { modelMatrix = glm::translate(modelMatrix, translation); }
-    void modelMatrixRotate(float angle, glm::vec3 axis) { modelMatrix = glm::rotate(modelMatrix, angle, axis); }
-    void modelMatrixScale(glm::vec3 scale) { modelMatrix = glm::scale(modelMatrix, scale); }
+    // Un occulteur est rastérisé dans le tampon de l'occlusion culling pour cacher les objets derrière lui
+    // (à réserver aux grands objets simples : murs, sols, bâtiments...)
+    void setOccluder(bool occluder) { this->occluder = occluder; }
+    bool isOccluder() const { return occluder; }
+
+    // LOD choisi à la dernière frame où l'objet était visible (voir InstancedRenderer)
+    int getLod() const { return lod; }
+    void setLod(int lod) { this->lod = lod; }
+
+    // Boîte dans l'espace du monde, calculée par la scène lors de sa dernière mise à jour
+    const AABB &getWorldBounds() const { return worldBounds; }
 
 private:
+    // La scène gère la boîte et la place de l'objet dans sa BVH
+    friend class Scene;
+
     string name;
-    Model graphicModel;
+    std::shared_ptr<Model> graphicModel;
     Shader &shader;
     glm::mat4 modelMatrix = glm::mat4(1.0f);
-    std::vector<std::unique_ptr<GameObject>> &gameObjects;
+    Scene &scene;
+    AABB worldBounds;
+    // Feuille de l'objet dans la BVH de la scène
+    int bvhProxy = -1;
+    // Déjà dans la liste des objets à remettre à jour de la scène
+    bool transformChanged = false;
+    bool occluder = false;
+    int lod = 0;
+
+    void updateWorldBounds();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,142 @@
+#ifndef GEOMETRYPOOL_HPP
+#define GEOMETRYPOOL_HPP
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "shaderVariants.hpp"
+#include "vertexFormat.hpp"
+
+class Mesh;
+struct MeshLod;
+
+// Allocation first-fit dans une plage [0, capacity) (en éléments), avec une liste des blocs libres fusionnés à la libération
+class RangeAllocator
+{
+public:
+    explicit RangeAllocator(size_t capacity = 0) { reset(capacity); }
+    void reset(size_t capacity);
+    // Renvoie false si aucun bloc libre n'est assez grand
+    bool allocate(size_t size, size_t &offset);
+    void free(size_t offset, size_t size);
+    size_t getCapacity() const { return capacity; }
+    size_t getUsed() const { return used; }
+
+private:
+    // Blocs libres : début -> taille
+    std::map<size_t, size_t> freeBlocks;
+    size_t capacity = 0;
+    size_t used = 0;
+};
+
+// Place d'un mesh dans le pool : ses sommets et ses indices (16 bits, relatifs à firstVertex)
+struct GeometryAllocation
+{
+    size_t firstVertex = 0;
+    size_t vertexCount = 0;
+    size_t firstIndex = 0;
+    size_t indexCount = 0;
+};
+
+// Données d'instance des draws du pool : la matrice de modèle et le décodage des positions du mesh (attributs 3 à 8)
+struct PoolInstance
+{
+    glm::mat4 model;
+    glm::vec3 positionOffset;
+    glm::vec3 positionScale;
+};
+
+// Un grand buffer de sommets et un grand buffer d'indices partagés par les meshes, dessinés avec un seul VAO.
+// Les draws d'une frame sont regroupés par matériau puis envoyés avec glMultiDrawElementsIndirect (OpenGL 4.3
+// ou GL_ARB_multi_draw_indirect), ou à défaut avec un glDrawElementsInstancedBaseVertex par draw sans changer de VAO.
+class GeometryPool
+{
+public:
+    // Crée les buffers (capacités en nombre de sommets et d'indices), avec un flux des positions seules si positionStream.
+    // loader sert à charger glMultiDrawElementsIndirect, absent de GLAD (OpenGL 3.3).
+    void create(size_t vertexCapacity, size_t indexCapacity, bool positionStream, GLADloadproc loader);
+    void deleteResources();
+    bool isCreated() const { return VAO != 0; }
+    // Force les appels glDrawElementsInstancedBaseVertex même si le multi-draw indirect est disponible
+    void setUseMultiDrawIndirect(bool use) { useMultiDrawIndirect = use && multiDrawIndirectSupported; }
+    bool isUsingMultiDrawIndirect() const { return useMultiDrawIndirect; }
+
+    // Copie les sommets compacts, le flux des positions seules (4 valeurs par sommet) et les indices d'un mesh dans le pool
+    // (false si le pool est plein)
+    bool allocate(const PackedVertex *vertices, const uint16_t *positions, size_t vertexCount, const uint16_t *indices, size_t indexCount,
+                  GeometryAllocation &allocation);
+    void free(const GeometryAllocation &allocation);
+    bool hasPositionStream() const { return positionVBO != 0; }
+    unsigned int getVertexArray(bool depthOnly) const { return depthOnly ? depthVAO : VAO; }
+
+    // Draws de la frame : à remplir après beginFrame, puis à envoyer au GPU une seule fois avec upload
+    void beginFrame();
+    void addDraw(const Mesh &mesh, int lod, const glm::mat4 *modelMatrices, GLsizei instanceCount);
+    void upload();
+    // Dessine les draws envoyés par upload avec la variante du shader et les textures de chaque matériau
+    // (sauf pour la passe de profondeur). Renvoie le nombre d'appels de dessin.
+    size_t submit(ShaderVariants &variants);
+    size_t submitDepth();
+    // Dessin immédiat d'un seul mesh (hors regroupement de la frame)
+    void drawInstanced(const Mesh &mesh, int lod, const glm::mat4 *modelMatrices, GLsizei instanceCount, bool depthOnly);
+
+    // Nombre de groupes de draws de même matériau de la frame (un changement de textures par groupe)
+    size_t getMaterialGroupCount() const { return groups.size(); }
+    // Changements de variante du dernier submit
+    size_t getProgramSwitchCount() const { return programSwitches; }
+    size_t getUsedVertices() const { return vertexAllocator.getUsed(); }
+    size_t getUsedIndices() const { return indexAllocator.getUsed(); }
+
+private:
+    // Commande de glMultiDrawElementsIndirect (format imposé par OpenGL)
+    struct DrawElementsIndirectCommand
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+    struct PoolDraw
+    {
+        const Mesh *mesh;
+        DrawElementsIndirectCommand command;
+    };
+    // Suite de commandes consécutives qui partagent le même matériau
+    struct MaterialGroup
+    {
+        const Mesh *mesh; // mesh dont on lie les textures
+        size_t firstCommand;
+        size_t commandCount;
+    };
+
+    typedef void(APIENTRYP MultiDrawElementsIndirectProc)(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride);
+    MultiDrawElementsIndirectProc multiDrawElementsIndirect = nullptr;
+    bool multiDrawIndirectSupported = false;
+    bool useMultiDrawIndirect = false;
+
+    unsigned int VAO = 0, VBO = 0, EBO = 0;
+    // Flux des positions seules (même indexation que VBO) et son VAO
+    unsigned int depthVAO = 0, positionVBO = 0;
+    // Instances et commandes de la frame (ré-allouées à chaque upload), buffer d'instances du dessin immédiat
+    unsigned int instanceVBO = 0, indirectBuffer = 0, immediateInstanceVBO = 0;
+    RangeAllocator vertexAllocator;
+    RangeAllocator indexAllocator;
+
+    std::vector<PoolDraw> draws;
+    std::vector<PoolInstance> instances;
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<MaterialGroup> groups;
+    std::vector<PoolInstance> immediateInstances;
+    size_t programSwitches = 0;
+
+    // Fait pointer les attributs d'instance du VAO lié sur buffer, à partir de l'instance firstInstance
+    static void bindInstances(unsigned int buffer, size_t firstInstance);
+    size_t submitGroups(unsigned int vao, ShaderVariants *variants);
+    static void fillInstances(const Mesh &mesh, const glm::mat4 *modelMatrices, GLsizei instanceCount, std::vector<PoolInstance> &out);
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef GLSTATE_HPP
+#define GLSTATE_HPP
+
+#include <glad/glad.h>
+#include <cstddef>
+
+// Copie côté CPU de l'état OpenGL (programme, VAO, buffers, textures, framebuffers, tests de profondeur et de mélange, viewport) :
+// les appels qui ne changent rien ne sont pas transmis au driver. Tout le code doit passer par GLState pour ces états,
+// sinon la copie n'est plus à jour (reset la relit).
+class GLState
+{
+public:
+    // Appels transmis au driver et appels écartés car l'état était déjà le bon
+    struct Counters
+    {
+        size_t forwarded = 0;
+        size_t filtered = 0;
+    };
+
+    // Lit l'état réel du contexte (après la création du contexte, ou après du code qui appelle OpenGL directement)
+    static void reset();
+
+    static void useProgram(GLuint program);
+    static void bindVertexArray(GLuint vertexArray);
+    // GL_ELEMENT_ARRAY_BUFFER fait partie de l'état du VAO : sa copie est oubliée à chaque changement de VAO
+    static void bindBuffer(GLenum target, GLuint buffer);
+    static void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+    static void bindFramebuffer(GLenum target, GLuint framebuffer);
+    // unit : numéro de l'unité de texture (0, 1...), pas GL_TEXTURE0 + unit
+    static void activeTexture(GLuint unit);
+    // Lie la texture à l'unité (GL_TEXTURE_2D ou GL_TEXTURE_BUFFER), en ne changeant l'unité active que si nécessaire
+    static void bindTexture(GLuint unit, GLenum target, GLuint texture);
+
+    static void setEnabled(GLenum capability, bool enabled);
+    static void enable(GLenum capability) { setEnabled(capability, true); }
+    static void disable(GLenum capability) { setEnabled(capability, false); }
+    static void depthFunc(GLenum function);
+    static void depthMask(bool write);
+    static void colorMask(bool write);
+    static void blendFunc(GLenum source, GLenum destination);
+    static void cullFace(GLenum face);
+    static void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    // Suppressions : OpenGL délie les objets supprimés, la copie doit suivre
+    static void deleteProgram(GLuint program);
+    static void deleteVertexArrays(GLsizei count, const GLuint *vertexArrays);
+    static void deleteBuffers(GLsizei count, const GLuint *buffers);
+    static void deleteTextures(GLsizei count, const GLuint *textures);
+    static void deleteFramebuffers(GLsizei count, const GLuint *framebuffers);
+
+    // Mode debug : chaque appel écarté est vérifié avec glGet*, et validate compare toute la copie à l'état réel
+    static void setValidation(bool enabled) { validation = enabled; }
+    static bool isValidating() { return validation; }
+    // Affiche les différences et remet la copie à jour. Renvoie true si la copie était exacte.
+    static bool validate();
+
+    static const Counters &getCounters() { return counters; }
+    static void resetCounters() { counters = Counters(); }
+
+private:
+    static bool validation;
+    static Counters counters;
+};
+
+#endif
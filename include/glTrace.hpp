@@ -0,0 +1,137 @@
+#ifndef GLTRACE_HPP
+#define GLTRACE_HPP
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Fichier de trace : GLTraceHeader suivi des appels. Chaque appel est enregistré sous la forme
+// identifiant (uint16), nombre d'arguments (uint8), arguments (uint32), taille des données (uint32) puis les données
+// (contenu des buffers et textures envoyés, sources des shaders, noms des uniforms, tableaux de valeurs).
+constexpr char GL_TRACE_MAGIC[4] = {'Y', 'G', 'L', 'T'};
+// À incrémenter à chaque changement du format des appels
+constexpr uint32_t GL_TRACE_VERSION = 1;
+constexpr int GL_TRACE_MAX_ARGUMENTS = 10;
+
+struct GLTraceHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t width, height; // taille du framebuffer par défaut
+    uint32_t frameCount;    // frames capturées après la mise en place
+};
+
+// Appels enregistrés. Les noms des objets (buffers, textures, programmes...) sont ceux de l'application :
+// le rejeu les associe à ses propres objets. Les pointeurs vers des buffers liés sont enregistrés comme des décalages.
+enum GLTraceCall : uint16_t
+{
+    GL_TRACE_SETUP_END, // fin de la mise en place (tout ce qui précède la première frame capturée)
+    GL_TRACE_FRAME_END,
+    GL_TRACE_GEN_BUFFERS,
+    GL_TRACE_DELETE_BUFFERS,
+    GL_TRACE_BIND_BUFFER,
+    GL_TRACE_BUFFER_DATA,
+    GL_TRACE_BUFFER_SUB_DATA,
+    GL_TRACE_BIND_BUFFER_BASE,
+    GL_TRACE_MAPPED_WRITE, // octets écrits dans un buffer mappé, enregistrés à glUnmapBuffer
+    GL_TRACE_GEN_VERTEX_ARRAYS,
+    GL_TRACE_DELETE_VERTEX_ARRAYS,
+    GL_TRACE_BIND_VERTEX_ARRAY,
+    GL_TRACE_VERTEX_ATTRIB_POINTER,
+    GL_TRACE_ENABLE_VERTEX_ATTRIB_ARRAY,
+    GL_TRACE_VERTEX_ATTRIB_DIVISOR,
+    GL_TRACE_VERTEX_ATTRIB_3FV,
+    GL_TRACE_GEN_TEXTURES,
+    GL_TRACE_DELETE_TEXTURES,
+    GL_TRACE_ACTIVE_TEXTURE,
+    GL_TRACE_BIND_TEXTURE,
+    GL_TRACE_TEX_IMAGE_2D,
+    GL_TRACE_TEX_PARAMETERI,
+    GL_TRACE_GENERATE_MIPMAP,
+    GL_TRACE_PIXEL_STOREI,
+    GL_TRACE_TEX_BUFFER,
+    GL_TRACE_GEN_FRAMEBUFFERS,
+    GL_TRACE_DELETE_FRAMEBUFFERS,
+    GL_TRACE_BIND_FRAMEBUFFER,
+    GL_TRACE_FRAMEBUFFER_TEXTURE_2D,
+    GL_TRACE_GEN_RENDERBUFFERS,
+    GL_TRACE_DELETE_RENDERBUFFERS,
+    GL_TRACE_BIND_RENDERBUFFER,
+    GL_TRACE_RENDERBUFFER_STORAGE,
+    GL_TRACE_FRAMEBUFFER_RENDERBUFFER,
+    GL_TRACE_DRAW_BUFFERS,
+    GL_TRACE_BLIT_FRAMEBUFFER,
+    GL_TRACE_CREATE_SHADER,
+    GL_TRACE_DELETE_SHADER,
+    GL_TRACE_SHADER_SOURCE,
+    GL_TRACE_COMPILE_SHADER,
+    GL_TRACE_CREATE_PROGRAM,
+    GL_TRACE_DELETE_PROGRAM,
+    GL_TRACE_ATTACH_SHADER,
+    GL_TRACE_DETACH_SHADER,
+    GL_TRACE_LINK_PROGRAM,
+    GL_TRACE_USE_PROGRAM,
+    GL_TRACE_GET_UNIFORM_LOCATION,
+    GL_TRACE_GET_UNIFORM_BLOCK_INDEX,
+    GL_TRACE_UNIFORM_BLOCK_BINDING,
+    GL_TRACE_UNIFORM_1I,
+    GL_TRACE_UNIFORM_1F,
+    GL_TRACE_UNIFORM_2FV,
+    GL_TRACE_UNIFORM_3FV,
+    GL_TRACE_UNIFORM_MATRIX_4FV,
+    GL_TRACE_ENABLE,
+    GL_TRACE_DISABLE,
+    GL_TRACE_DEPTH_MASK,
+    GL_TRACE_DEPTH_FUNC,
+    GL_TRACE_CULL_FACE,
+    GL_TRACE_COLOR_MASK,
+    GL_TRACE_BLEND_FUNC,
+    GL_TRACE_VIEWPORT,
+    GL_TRACE_CLEAR_COLOR,
+    GL_TRACE_CLEAR,
+    GL_TRACE_DRAW_ARRAYS,
+    GL_TRACE_DRAW_ARRAYS_INSTANCED,
+    GL_TRACE_DRAW_ELEMENTS_INSTANCED,
+    GL_TRACE_DRAW_ELEMENTS_INSTANCED_BASE_VERTEX,
+    GL_TRACE_MULTI_DRAW_ELEMENTS_INDIRECT,
+    GL_TRACE_CALL_COUNT
+};
+
+// Capture des appels OpenGL (mode "--gl-trace fichier N") : les pointeurs de fonctions de GLAD sont remplacés
+// par des fonctions qui enregistrent chaque appel avant de le transmettre au driver. Tout ce qui précède la première
+// frame capturée (création des buffers, textures et programmes) est enregistré comme mise en place, sans les draws.
+// Les N frames suivantes sont enregistrées en entier, puis les pointeurs d'origine sont remis.
+// Les requêtes (glGet*, requêtes du profiler) ne sont pas enregistrées. Le cache des programmes doit être désactivé :
+// un programme chargé depuis un binaire n'aurait pas de sources dans la trace.
+class GLTrace
+{
+public:
+    // À appeler juste après gladLoadGLLoader, avant toute création d'objet
+    static bool start(const std::string &path, GLADloadproc loader, int width, int height, int firstFrame, int frameCount);
+    static bool isCapturing() { return recording; }
+    // Vrai pendant les frames capturées (les draws de la mise en place ne sont pas enregistrés)
+    static bool isCapturingFrames() { return recording && frame >= firstFrame; }
+    // Remplace le loader pour les fonctions chargées hors de GLAD (glMultiDrawElementsIndirect du pool de géométrie)
+    static void *getProcAddress(const char *name);
+    // Fin de chaque frame de la boucle de rendu (avant glfwSwapBuffers)
+    static void endFrame();
+    // Ferme le fichier et remet les pointeurs de GLAD (appelé automatiquement après la dernière frame)
+    static void stop();
+
+private:
+    static bool recording;
+    static int frame;
+    static int firstFrame;
+    static int lastFrame;
+
+    static void install();
+    static void uninstall();
+};
+
+// Mode "--replay-trace fichier N" : rejoue une trace dans sa propre fenêtre, sans le reste de l'application.
+// La mise en place est exécutée une fois, puis les frames capturées N fois de suite. Affiche le temps de soumission
+// (appels seuls) et le temps total (jusqu'à glFinish) par frame. Renvoie le code de sortie du programme.
+int runGLTraceReplay(const std::string &path, int loopCount);
+
+#endif
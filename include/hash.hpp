@@ -0,0 +1,19 @@
+#ifndef HASH_HPP
+#define HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Hash FNV-1a 64 bits (fichiers sources des modèles précompilés, clés du cache des programmes)
+inline uint64_t fnv1aHash(const unsigned char *data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef INPUTRECORDER_HPP
+#define INPUTRECORDER_HPP
+
+#include <GLFW/glfw3.h>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Fichier d'entrées enregistrées : InputRecordingHeader suivi des évènements (type sur un octet, temps en secondes
+// depuis le début de l'enregistrement sur 4 octets, puis les données du type)
+constexpr char INPUT_RECORDING_MAGIC[4] = {'Y', 'I', 'N', 'P'};
+// À incrémenter à chaque changement du format des évènements
+constexpr uint32_t INPUT_RECORDING_VERSION = 1;
+
+struct InputRecordingHeader
+{
+    char magic[4];
+    uint32_t version;
+};
+
+enum InputEventType : uint8_t
+{
+    INPUT_EVENT_KEY = 0,    // touche (int16) et état GLFW_PRESS / GLFW_RELEASE (uint8)
+    INPUT_EVENT_MOUSE = 1,  // déplacement de la souris déjà converti pour la caméra (2 float)
+    INPUT_EVENT_SCROLL = 2, // molette (float)
+    INPUT_EVENT_LINE = 3,   // ligne saisie dans la console (longueur uint16 puis caractères)
+    INPUT_EVENT_END = 4,    // fin de l'enregistrement (sans données)
+};
+
+// Enregistrement et rejeu des entrées : touches du clavier, souris, molette et lignes de la console.
+// Enregistrées, les entrées réelles passent par getKey / readLine / record* et sont écrites avec leur temps.
+// Au rejeu, elles sont remplacées par celles du fichier, appliquées sur un pas de temps fixe : la caméra refait
+// le même parcours, frame après frame, quelle que soit la vitesse de la machine.
+class InputRecorder
+{
+public:
+    ~InputRecorder() { stop(); }
+
+    bool startRecording(const std::string &path);
+    bool startReplay(const std::string &path, float timestep);
+    // Termine l'enregistrement (évènement de fin) ou le rejeu
+    void stop();
+    bool isRecording() const { return recording; }
+    bool isReplaying() const { return replaying; }
+
+    // Appelés au rejeu pour les déplacements de la souris et de la molette, dans l'ordre de l'enregistrement
+    void setPointerHandlers(std::function<void(float, float)> mouseMovement, std::function<void(float)> scroll);
+
+    // Début de frame : relève l'état des touches suivies (enregistrement), ou avance le temps du rejeu d'un pas
+    // et applique les évènements jusque-là. Renvoie faux quand le rejeu est terminé.
+    bool beginFrame(GLFWwindow *window);
+    // Remplace glfwGetKey : l'état relevé en début de frame, ou celui du rejeu
+    int getKey(GLFWwindow *window, int key) const;
+    // Remplace std::getline(std::cin, ...) pour les menus de la console
+    bool readLine(std::string &line);
+    void recordMouseMovement(float xoffset, float yoffset);
+    void recordScroll(float yoffset);
+
+    float getTimestep() const { return timestep; }
+
+private:
+    struct Event
+    {
+        InputEventType type;
+        float time;
+        int key;
+        int action;
+        float x, y;
+        std::string line;
+    };
+
+    bool recording = false;
+    bool replaying = false;
+    std::ofstream output;
+    double startTime = 0.0;
+    // État des touches suivies (relevé ou rejoué)
+    std::vector<int> keyStates;
+    // Rejeu : évènements du fichier, prochain à appliquer, temps écoulé et lignes en attente de readLine
+    std::vector<Event> events;
+    size_t nextEvent = 0;
+    float timestep = 0.0f;
+    double replayTime = 0.0;
+    std::vector<std::string> pendingLines;
+    size_t nextLine = 0;
+    std::function<void(float, float)> mouseMovement;
+    std::function<void(float)> scroll;
+
+    float now() const;
+    void writeEvent(InputEventType type, const void *data, size_t size);
+    bool readEvents(std::ifstream &file);
+};
+
+#endif
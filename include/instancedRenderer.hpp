@@ -0,0 +1,151 @@
+#ifndef INSTANCEDRENDERER_HPP
+#define INSTANCEDRENDERER_HPP
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "gameObject.hpp"
+#include "scene.hpp"
+#include "shader.hpp"
+#include "shaderVariants.hpp"
+#include "frustum.hpp"
+#include "occlusionBuffer.hpp"
+#include "geometryPool.hpp"
+#include "renderQueue.hpp"
+#include "constants.hpp"
+
+// Compteurs de la dernière frame, pour vérifier l'efficacité du culling
+struct RenderStats
+{
+    size_t visibleObjects = 0;
+    size_t culledObjects = 0;
+    size_t visibleMeshes = 0;
+    size_t culledMeshes = 0; // sans les meshes des objets déjà écartés par la BVH
+    size_t drawCalls = 0;
+    // Occlusion culling : objets et meshes cachés par les occulteurs, temps de rastérisation (ms)
+    size_t occludedObjects = 0;
+    size_t occludedMeshes = 0;
+    double occlusionRasterizeTime = 0.0;
+    // Triangles envoyés au GPU (toutes instances comprises) et nombre d'objets dessinés à chaque LOD
+    size_t triangles = 0;
+    size_t lodHistogram[MESH_LOD_COUNT] = {};
+    // Changements d'état pendant la soumission (passe de profondeur comprise)
+    size_t programSwitches = 0;
+    size_t textureSwitches = 0;
+    size_t vertexArraySwitches = 0;
+    // Variantes du shader compilées (toutes frames confondues)
+    size_t shaderVariants = 0;
+};
+
+// Point de vue de la frame
+struct RenderView
+{
+    Frustum frustum;
+    glm::mat4 viewProjection;
+    glm::vec3 cameraPosition;
+    // projection[1][1] = 1 / tan(fov / 2) : rayon / distance * projectionScale = taille à l'écran (1 = demi-hauteur)
+    float projectionScale;
+};
+
+// Élimine les GameObjects (via la BVH de la scène) et les meshes hors du frustum, choisit le LOD de chaque objet
+// selon sa taille à l'écran, puis regroupe les meshes visibles pour dessiner toutes leurs copies
+// avec un seul glDrawElementsInstanced par mesh et par LOD (ou un multi-draw par matériau pour le pool de géométrie),
+// dans l'ordre d'une file de rendu triée par état OpenGL puis par profondeur
+class InstancedRenderer
+{
+public:
+    // Crée le cube dessiné à la place des GameObjects dont le modèle est encore en chargement
+    void createPlaceholder();
+    // Libère le cube de remplacement (avant la destruction du contexte OpenGL)
+    void deleteResources() { placeholder.reset(); }
+    // Active l'occlusion culling logiciel : à chaque draw, les occulteurs visibles sont rastérisés dans le tampon
+    // (sur threadCount threads), puis les objets et meshes qu'ils cachent ne sont pas dessinés
+    void enableOcclusionCulling(OcclusionBuffer *buffer, unsigned int threadCount)
+    {
+        occlusionBuffer = buffer;
+        occlusionThreadCount = threadCount;
+    }
+    // Active la passe de profondeur : les batches sont d'abord dessinés avec depthShader et le flux des positions seules,
+    // puis la passe principale ne colore que les fragments visibles (les meshes doivent avoir été créés avec ce flux)
+    void enableDepthPrepass(Shader *depthShader) { depthPrepassShader = depthShader; }
+    // Les meshes rangés dans ce pool sont dessinés avec quelques multi-draws au lieu d'un appel par mesh
+    void enableGeometryPool(GeometryPool *pool) { geometryPool = pool; }
+    // Dessine les GameObjects visibles, chaque mesh avec la variante du shader qui correspond à son matériau
+    // (les shaders doivent lire la matrice de modèle dans l'attribut d'instance)
+    void draw(const Scene &scene, ShaderVariants &shaders, const RenderView &view);
+
+    const RenderStats &getStats() const { return stats; }
+
+private:
+    struct Batch
+    {
+        Mesh *mesh;
+        int lod;
+        std::vector<glm::mat4> modelMatrices;
+        // Position de la première matrice dans le buffer d'instances du mesh (voir uploadInstances)
+        GLint firstInstance;
+        // Distance à la caméra de l'instance la plus proche, pour le tri de la file de rendu
+        float distance;
+    };
+
+    struct BatchKey
+    {
+        Mesh *mesh;
+        int lod;
+
+        bool operator==(const BatchKey &other) const { return mesh == other.mesh && lod == other.lod; }
+    };
+    struct BatchKeyHash
+    {
+        size_t operator()(const BatchKey &key) const { return std::hash<Mesh *>()(key.mesh) ^ (size_t)key.lod; }
+    };
+
+    // Un GameObject candidat : son modèle (ou le cube de remplacement), sa matrice, sa géométrie d'occulteur éventuelle
+    // et son LOD (choisi une fois l'objet reconnu visible)
+    struct Candidate
+    {
+        GameObject *gameObject;
+        Model *model;
+        const glm::mat4 *modelMatrix;
+        const OccluderMesh *occluder;
+        int lod;
+    };
+
+    // Les tableaux sont conservés d'une frame à l'autre pour ne pas ré-allouer
+    std::vector<GameObject *> sceneCandidates;
+    std::vector<Candidate> candidates;
+    std::vector<AABB> worldBounds;
+    std::vector<uint8_t> visible;
+    std::vector<Candidate> meshCandidates;
+    std::vector<Mesh *> candidateMeshes;
+    std::vector<Batch> batches;
+    std::unordered_map<BatchKey, size_t, BatchKeyHash> batchIndices;
+    size_t batchCount = 0;
+    RenderQueue renderQueue;
+    // Batches hors du pool regroupés par mesh, et matrices des meshes qui ont plusieurs batches
+    std::vector<size_t> instanceUploads;
+    std::vector<glm::mat4> instanceMatrices;
+    RenderStats stats;
+    // Cube unité gris utilisé tant qu'un modèle n'est pas prêt
+    std::unique_ptr<Model> placeholder;
+    // Tampon de l'occlusion culling (nullptr si désactivé)
+    OcclusionBuffer *occlusionBuffer = nullptr;
+    unsigned int occlusionThreadCount = 1;
+    // Shader de la passe de profondeur (nullptr si désactivée)
+    Shader *depthPrepassShader = nullptr;
+    // Pool de géométrie (nullptr si désactivé)
+    GeometryPool *geometryPool = nullptr;
+
+    void addInstance(Mesh *mesh, int lod, const glm::mat4 &modelMatrix, float distance);
+    // Envoie une fois par frame les matrices des batches hors du pool dans les buffers d'instances de leurs meshes
+    void uploadInstances();
+    // Dessine les batches dans l'ordre de la file avec leurs variantes (nullptr : passe de profondeur, shader déjà actif)
+    void submit(ShaderVariants *shaders);
+    // LOD d'un objet selon sa taille à l'écran, avec une marge autour des seuils pour garder le LOD actuel
+    static int selectLod(float screenSize, int currentLod);
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef JOBSYSTEM_HPP
+#define JOBSYSTEM_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool de threads de travail : les jobs ne doivent pas appeler OpenGL (le contexte n'existe que sur le thread principal)
+class JobSystem
+{
+public:
+    explicit JobSystem(unsigned int threadCount);
+    ~JobSystem() { shutdown(); }
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    // Ajoute un job à la file (appelable depuis n'importe quel thread)
+    void submit(std::function<void()> job);
+    // Termine les jobs en cours, abandonne ceux qui attendent et arrête les threads
+    void shutdown();
+    // Jobs en attente ou en cours d'exécution
+    size_t pendingCount();
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    size_t runningCount = 0;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    bool stopping = false;
+
+    void workerLoop();
+};
+
+// File de tâches exécutées par le thread OpenGL (envois au GPU), dans une limite de temps par frame
+class MainThreadQueue
+{
+public:
+    // Ajoute une tâche (appelable depuis n'importe quel thread)
+    void push(std::function<void()> task);
+    // Exécute les tâches dans l'ordre tant que le budget (en millisecondes) n'est pas dépassé, au moins une par appel
+    void process(double budgetMilliseconds);
+    // Supprime les tâches en attente (sur le thread OpenGL : elles peuvent libérer des ressources GPU)
+    void clear();
+
+    size_t pendingCount();
+
+private:
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+};
+
+#endif
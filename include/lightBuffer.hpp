@@ -0,0 +1,130 @@
+#ifndef LIGHTBUFFER_HPP
+#define LIGHTBUFFER_HPP
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "uniformBuffer.hpp"
+#include "textureBuffer.hpp"
+#include "clusterGrid.hpp"
+#include "constants.hpp"
+#include "pointLight.hpp"
+#include "spotLight.hpp"
+
+// Structures miroirs des données GLSL en layout std140 : chaque vec3 est suivi d'un float pour remplir 16 octets.
+// Les PointLights (4 texels) et SpotLights (5 texels) sont lues dans des texture buffers RGBA32F avec ce même layout.
+
+struct DirLightStd140
+{
+    glm::vec3 direction;
+    float padding0;
+    glm::vec3 ambient;
+    float padding1;
+    glm::vec3 diffuse;
+    float padding2;
+    glm::vec3 specular;
+    float padding3;
+};
+
+struct PointLightStd140
+{
+    glm::vec3 position;
+    float constant;
+    glm::vec3 ambient;
+    float linear;
+    glm::vec3 diffuse;
+    float quadratic;
+    glm::vec3 specular;
+    // Portée de la lumière, utilisée pour la taille des volumes du rendu deferred
+    float range;
+};
+
+struct SpotLightStd140
+{
+    glm::vec3 position;
+    float constant;
+    glm::vec3 direction;
+    float linear;
+    glm::vec3 ambient;
+    float quadratic;
+    glm::vec3 diffuse;
+    float cosCutOff;
+    glm::vec3 specular;
+    float cosOuterCutOff;
+};
+
+// Bloc "Lights" de objectShader.fs : les tableaux de lumières sont dans des texture buffers, le bloc ne contient que leur taille
+struct LightsBlockStd140
+{
+    DirLightStd140 dirLight;
+    int numPointLights;
+    int numSpotLights;
+    int padding[2];
+    // Mode clustered : tuiles en x, tuiles en y, tranches, 1 si le mode est activé
+    glm::ivec4 clusterGrid;
+    // Mode clustered : échelle et biais de la tranche (slice = log(profondeur) * x + y), taille d'une tuile en pixels (z, w)
+    glm::vec4 clusterParams;
+};
+
+// Bloc "FrameData" partagé par tous les programmes
+struct FrameDataStd140
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 viewPos;
+};
+
+static_assert(sizeof(DirLightStd140) == 64, "DirLightStd140 ne respecte pas le layout std140");
+static_assert(sizeof(PointLightStd140) == 64, "PointLightStd140 ne respecte pas le layout std140");
+static_assert(sizeof(SpotLightStd140) == 80, "SpotLightStd140 ne respecte pas le layout std140");
+static_assert(sizeof(FrameDataStd140) == 144, "FrameDataStd140 ne respecte pas le layout std140");
+
+// Gère le UBO et les texture buffers des lumières : seules les lumières modifiées (dirty) sont ré-envoyées avec glBufferSubData.
+// Le nombre de lumières n'est pas limité, les buffers grandissent à la demande.
+class LightBuffer
+{
+public:
+    // Alloue le UBO au point de liaison LIGHTS_UBO_BINDING et les texture buffers des lumières
+    void create();
+    // Définit la lumière directionnelle (envoyée au prochain update)
+    void setDirLight(glm::vec3 direction, glm::vec3 ambient, glm::vec3 diffuse, glm::vec3 specular);
+    // Active le mode clustered et envoie la grille et les listes de lumières des clusters (à appeler avant update)
+    void updateClusters(const ClusterGrid &grid, float framebufferWidth, float framebufferHeight);
+    // Envoie au GPU la plage contiguë des lumières modifiées depuis le dernier appel et lie les texture buffers
+    void update(std::vector<PointLight> &pointLights, std::vector<SpotLight> &spotLights);
+    // Relie le bloc Lights et les samplers des texture buffers du shader
+    void bindToShader(Shader &shader) const;
+    void deleteBuffer();
+
+private:
+    UniformBuffer ubo;
+    TextureBuffer pointLightsBuffer;
+    TextureBuffer spotLightsBuffer;
+    TextureBuffer clusterDataBuffer;
+    TextureBuffer clusterIndicesBuffer;
+    // Copies CPU des données, dans lesquelles on écrit avant d'envoyer les plages modifiées
+    LightsBlockStd140 block = {};
+    std::vector<PointLightStd140> gpuPointLights;
+    std::vector<SpotLightStd140> gpuSpotLights;
+    bool blockDirty = true;
+};
+
+// Gère le UBO des données de la frame (matrices de vue/projection et position de la caméra)
+class FrameDataBuffer
+{
+public:
+    // Alloue le UBO au point de liaison FRAME_UBO_BINDING
+    void create() { ubo.create(sizeof(FrameDataStd140), FRAME_UBO_BINDING); }
+    // N'envoie les données que si elles ont changé depuis la frame précédente
+    void update(const glm::mat4 &view, const glm::mat4 &projection, glm::vec3 viewPos);
+    void bindToShader(const Shader &shader) const { ubo.bindToShader(shader, "FrameData"); }
+    void deleteBuffer() { ubo.deleteBuffer(); }
+
+private:
+    UniformBuffer ubo;
+    FrameDataStd140 data = {};
+    bool uploaded = false;
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef LIGHTMARKERS_HPP
+#define LIGHTMARKERS_HPP
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "pointLight.hpp"
+
+// Données d'instance d'un cube de PointLight (attributs avec diviseur 1)
+struct LightMarkerInstance
+{
+    glm::mat4 model;
+    glm::vec3 color;
+};
+
+// Cubes qui matérialisent les PointLights, tous dessinés en un seul appel instancié
+class LightMarkers
+{
+public:
+    // Crée le VAO du cube (positions lues dans CubeVertices.txt) et le buffer d'instances
+    void create(const std::vector<float> &cubeVertices);
+    // Met à jour les instances des lumières modifiées. À appeler avant LightBuffer::update, qui remet les lumières à l'état "propre".
+    void update(std::vector<PointLight> &pointLights);
+    // Dessine tous les cubes avec glDrawArraysInstanced (le shader doit être actif)
+    void draw() const;
+    // Suppression des buffers et du VAO
+    void deleteResources();
+
+private:
+    unsigned int VAO = 0, cubeVBO = 0, instanceVBO = 0;
+    GLsizei cubeVertexCount = 0;
+    // Copie CPU des instances et capacité allouée du buffer (en nombre d'instances)
+    std::vector<LightMarkerInstance> instances;
+    size_t instanceCapacity = 0;
+};
+
+#endif
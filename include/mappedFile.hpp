@@ -0,0 +1,34 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <string>
+
+// Fichier projeté en mémoire en lecture seule (CreateFileMapping sous Windows, mmap ailleurs)
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // Renvoie false si le fichier n'existe pas ou ne peut pas être projeté
+    bool open(const std::string &path);
+    void close();
+
+    const unsigned char *data() const { return mData; }
+    size_t size() const { return mSize; }
+
+private:
+    const unsigned char *mData = nullptr;
+    size_t mSize = 0;
+#ifdef _WIN32
+    void *mFileHandle = nullptr;
+    void *mMappingHandle = nullptr;
+#else
+    int mFileDescriptor = -1;
+#endif
+};
+
+#endif
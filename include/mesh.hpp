@@ -1,14 +1,21 @@
 #ifndef MESH_HPP
 #define MESH_HPP
 
+#include <algorithm>
 #include <glm/glm.hpp>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "shader.hpp"
+#include "glState.hpp"
+#include "bounds.hpp"
+#include "vertexFormat.hpp"
+#include "geometryPool.hpp"
 
 using namespace std;
 
+// Sommet tel qu'il est importé et précompilé, converti en PackedVertex à l'envoi au GPU
 struct Vertex
 {
     glm::vec3 Position;
@@ -16,35 +23,186 @@ struct Vertex
     glm::vec2 TexCoords;
 };
 
+struct TextureAsset;
+struct MaterialAsset;
+
 struct Texture
 {
-    unsigned int id;
     string type; // diffuse ou specular
-    string path; // On stocke le chemin du fichier pour vérifier si la texture est déjà chargée
+    string path; // Chemin du fichier, relatif au dossier du modèle
+    shared_ptr<TextureAsset> asset; // Texture OpenGL partagée, gardée en vie tant que le mesh l'utilise (voir AssetCache)
+};
+
+// Niveau de détail d'un mesh : plage de la liste d'indices (tous les LODs partagent les sommets du mesh)
+struct MeshLod
+{
+    unsigned int firstIndex;
+    unsigned int indexCount;
+    float error; // erreur géométrique introduite par la simplification, dans l'unité du modèle
+};
+
+// Données d'un mesh côté CPU, avant l'envoi au GPU
+struct MeshData
+{
+    // Tableaux lus par Assimp (vides si les données viennent d'un fichier précompilé projeté en mémoire)
+    vector<Vertex> vertices;
+    vector<unsigned int> indices;
+    // Sommets complets et indices sur 32 bits : pointent dans les tableaux ci-dessus (nullptr pour un fichier précompilé)
+    const Vertex *vertexData = nullptr;
+    size_t vertexCount = 0;
+    const unsigned int *indexData = nullptr;
+    size_t indexCount = 0;
+    // Format compact rempli par Mesh::packMeshData (tableaux vides pour un fichier précompilé)
+    vector<PackedVertex> packedVertices;
+    vector<uint16_t> packedPositions;
+    vector<uint16_t> shortIndices;
+    // Données envoyées telles quelles au GPU : pointent dans les tableaux ci-dessus ou dans le fichier projeté
+    const PackedVertex *packedVertexData = nullptr;
+    const uint16_t *positionData = nullptr; // flux des positions seules (4 valeurs par sommet)
+    const void *packedIndexData = nullptr;
+    size_t indexSize = sizeof(unsigned int); // 2 si le mesh a au plus 65536 sommets
+    PositionDecode positionDecode;
+    vector<Texture> textures;
+    // Volumes englobants dans l'espace du modèle (calculés pendant la conversion des sommets ou lus dans le fichier précompilé)
+    AABB bounds;
+    BoundingSphere boundingSphere;
+    // LODs, du plus détaillé au plus simple, dont les indices sont à la suite dans la liste d'indices (vide : un seul niveau)
+    vector<MeshLod> lods;
 };
 
 class Mesh
 {
 public:
-    // Données du mesh
+    // Données du mesh (vides pour un mesh créé à partir d'un fichier précompilé : les données ne sont que sur le GPU)
     vector<Vertex> vertices;
     vector<unsigned int> indices; // Les indices des vertices pour l'EBO
     vector<Texture> textures;
 
     Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures);
-    void Draw(Shader &shader);
+    // Envoie directement les tableaux au GPU sans les copier (ex : fichier précompilé projeté en mémoire)
+    Mesh(const Vertex *vertexData, size_t vertexCount, const unsigned int *indexData, size_t indexCount, vector<Texture> textures);
+    // Reprend les tableaux (ou les pointeurs) et les volumes englobants déjà calculés.
+    // Les données déjà compactes (fichier précompilé) sont envoyées sans conversion.
+    explicit Mesh(MeshData &data);
+    // Convertit les sommets de data au format compact avec l'encodage courant (sans OpenGL : utilisable depuis un thread de travail).
+    // Les volumes englobants de data doivent être calculés.
+    static void packMeshData(MeshData &data);
+    // Dessine une seule copie du mesh
+    void Draw(Shader &shader, const glm::mat4 &modelMatrix) { DrawInstanced(shader, &modelMatrix, 1); }
+    // Dessine instanceCount copies du mesh en un seul appel (les matrices sont envoyées dans le buffer d'instances du mesh)
+    // avec le niveau de détail lod (limité au LOD le plus simple disponible)
+    void DrawInstanced(Shader &shader, const glm::mat4 *modelMatrices, GLsizei instanceCount, int lod = 0);
+    // Même chose avec le flux des positions seules, pour les passes de profondeur (nécessite enablePositionStream,
+    // le shader de profondeur doit être actif)
+    void DrawDepthInstanced(const glm::mat4 *modelMatrices, GLsizei instanceCount, int lod = 0);
     void CleanUp()
     {
-        glDeleteVertexArrays(1, &VAO);
-        glDeleteBuffers(1, &VBO);
-        glDeleteBuffers(1, &EBO);
+        geometryMemory.packed -= gpuMemory;
+        geometryMemory.unpacked -= unpackedMemory;
+        gpuMemory = unpackedMemory = 0;
+        if (pool)
+        {
+            // Mesh rangé dans le pool : on rend sa place
+            pool->free(allocation);
+            pool = nullptr;
+            return;
+        }
+        GLState::deleteVertexArrays(1, &VAO);
+        GLState::deleteBuffers(1, &VBO);
+        GLState::deleteBuffers(1, &EBO);
+        GLState::deleteBuffers(1, &instanceVBO);
+        if (depthVAO)
+        {
+            GLState::deleteVertexArrays(1, &depthVAO);
+            GLState::deleteBuffers(1, &positionVBO);
+        }
     }
 
+    // Taille de la géométrie de tous les meshes sur le GPU (sommets, flux des positions et indices), en octets,
+    // et taille qu'elle aurait avec des Vertex complets et des indices sur 32 bits
+    struct GeometryMemory
+    {
+        size_t packed = 0;
+        size_t unpacked = 0;
+    };
+    static const GeometryMemory &getGeometryMemory() { return geometryMemory; }
+
+    // Format des meshes créés ensuite (à choisir avant de charger les modèles)
+    static void setPositionEncoding(PositionEncoding encoding) { positionEncoding = encoding; }
+    // Les meshes créés ensuite ont aussi un buffer des positions seules (8 octets par sommet) pour DrawDepthInstanced
+    static void enablePositionStream(bool enable) { positionStreamEnabled = enable; }
+    static bool isPositionStreamEnabled() { return positionStreamEnabled; }
+    static PositionEncoding getPositionEncoding() { return positionEncoding; }
+    // Les meshes créés ensuite qui ont au plus 65536 sommets sont rangés dans ce pool tant qu'il a de la place (nullptr : buffers propres)
+    static void setGeometryPool(GeometryPool *pool) { geometryPool = pool; }
+
+    const AABB &getBounds() const { return bounds; }
+    const BoundingSphere &getBoundingSphere() const { return boundingSphere; }
+    int getLodCount() const { return (int)lods.size(); }
+    bool hasPositionStream() const { return pool ? pool->hasPositionStream() : depthVAO != 0; }
+    bool isPooled() const { return pool != nullptr; }
+    const GeometryAllocation &getAllocation() const { return allocation; }
+    const PositionDecode &getPositionDecode() const { return positionDecode; }
+    // Identifiant du matériau : les meshes qui se dessinent avec les mêmes textures (et les mêmes samplers) ont le même
+    unsigned int getMaterialId() const { return materialId; }
+    // Fonctionnalités du matériau qui choisissent la variante du shader (bits ShaderFeature, voir ShaderVariants)
+    uint32_t getShaderFeatures() const { return shaderFeatures; }
+    // VAO utilisé pour dessiner le mesh (celui du pool pour un mesh rangé dans le pool)
+    unsigned int getVertexArray(bool depthOnly) const;
+    // Lie les textures du mesh à ses samplers
+    void bindTextures(Shader &shader) const;
+    // Envoie dans le buffer d'instances du mesh les matrices de toutes ses instances de la frame (pas pour un mesh du pool)
+    void uploadInstances(const glm::mat4 *modelMatrices, GLsizei instanceCount);
+    // Dessine instanceCount instances à partir de la matrice firstInstance envoyée par uploadInstances, avec le VAO
+    // de getVertexArray(depthOnly) déjà lié et les textures déjà liées (pas pour un mesh du pool)
+    void drawInstancesBound(GLint firstInstance, GLsizei instanceCount, int lod, bool depthOnly);
+    // LOD demandé, limité au plus simple disponible
+    const MeshLod &getLod(int lod) const { return lods[std::min(lod, (int)lods.size() - 1)]; }
+
 private:
     // Buffers
     unsigned int VAO, VBO, EBO;
+    // Buffer des matrices de modèle des instances (attributs 3 à 6) et sa capacité (en nombre de matrices)
+    unsigned int instanceVBO = 0;
+    GLsizei instanceCapacity = 0;
+    // Première instance sur laquelle pointent les attributs d'instance de VAO et de depthVAO
+    GLint mainFirstInstance = 0, depthFirstInstance = 0;
+    // Flux des positions seules, avec son propre VAO qui partage l'EBO et le buffer d'instances (0 si désactivé)
+    unsigned int depthVAO = 0, positionVBO = 0;
+    // Indices sur 16 bits quand le mesh a au plus 65536 sommets
+    GLenum indexType = GL_UNSIGNED_INT;
+    size_t indexSize = sizeof(unsigned int);
+    // Décodage des positions compactes, envoyé au shader à chaque draw
+    PositionDecode positionDecode;
+    // Taille de la géométrie du mesh sur le GPU, et sans le format compact (voir GeometryMemory)
+    size_t gpuMemory = 0;
+    size_t unpackedMemory = 0;
+    // Pool qui contient la géométrie du mesh (nullptr : VAO et buffers propres) et place dans ce pool
+    GeometryPool *pool = nullptr;
+    GeometryAllocation allocation;
+    // Volumes englobants dans l'espace du modèle
+    AABB bounds;
+    BoundingSphere boundingSphere;
+    // Plages d'indices des niveaux de détail (au moins un : le mesh complet)
+    vector<MeshLod> lods;
+    // Nom de l'uniform sampler2D associé à chaque texture ("material.texture_diffuse1", ...), calculé une seule fois
+    vector<string> samplerNames;
+    // Texture noire liée au sampler spéculaire quand le mesh n'a pas de texture spéculaire (nullptr sinon)
+    shared_ptr<TextureAsset> missingSpecular;
+
+    static PositionEncoding positionEncoding;
+    static bool positionStreamEnabled;
+    static GeometryPool *geometryPool;
+    static GeometryMemory geometryMemory;
+    // Matériau partagé (identifiant recyclé quand le dernier mesh qui l'utilise disparaît, voir AssetCache)
+    shared_ptr<MaterialAsset> material;
+    unsigned int materialId = 0;
+    uint32_t shaderFeatures = 0;
 
-    void setupMesh();
+    void setupSamplerNames();
+    void setupMesh(MeshData &data);
+    static void computeBounds(MeshData &data);
+    void pointInstanceAttributes(GLint firstInstance);
 };
 
 #endif
\ No newline at end of file
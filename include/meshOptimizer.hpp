@@ -0,0 +1,39 @@
+#ifndef MESHOPTIMIZER_HPP
+#define MESHOPTIMIZER_HPP
+
+#include <cstddef>
+
+// Optimisations des meshes indexés appliquées à l'import (aucun appel OpenGL).
+// Les sommets sont des structures de stride octets dont le premier champ est la position (vec3).
+
+// Taille du cache de sommets (FIFO) simulé : ordre de grandeur des caches post-transformation des GPU
+constexpr size_t VERTEX_CACHE_SIZE = 16;
+
+// Statistiques du cache de sommets pour un ordre de triangles donné
+struct VertexCacheStats
+{
+    float acmr; // sommets transformés par triangle (entre 0.5 et 3, plus c'est bas, mieux c'est)
+    float atvr; // sommets transformés par sommet du mesh (1 = chaque sommet n'est transformé qu'une fois)
+};
+
+// Simule un cache FIFO de cacheSize sommets sur la liste d'indices
+VertexCacheStats analyzeVertexCache(const unsigned int *indices, size_t indexCount, size_t vertexCount, size_t cacheSize = VERTEX_CACHE_SIZE);
+
+// Fusionne les sommets identiques octet par octet : le tableau est compacté sur place et les indices réécrits.
+// Renvoie le nouveau nombre de sommets.
+size_t weldVertices(void *vertices, size_t vertexCount, size_t stride, unsigned int *indices, size_t indexCount);
+
+// Réordonne les triangles pour réutiliser au mieux le cache de sommets (algorithme Tipsify, Sander et al. 2007)
+void optimizeVertexCache(unsigned int *indices, size_t indexCount, size_t vertexCount, size_t cacheSize = VERTEX_CACHE_SIZE);
+
+// Réordonne les groupes de triangles (découpés là où le cache repart de zéro) pour dessiner d'abord ceux qui sont
+// tournés vers l'extérieur du mesh, qui cachent souvent les autres. L'ordre n'est gardé que si l'ACMR
+// ne dépasse pas threshold fois celui de l'ordre d'entrée (à appeler après optimizeVertexCache).
+void optimizeOverdraw(unsigned int *indices, size_t indexCount, const void *vertices, size_t vertexCount, size_t stride,
+                      float threshold = 1.05f);
+
+// Range les sommets dans l'ordre de leur première utilisation par les indices (les sommets inutilisés sont supprimés),
+// pour que les lectures du vertex buffer restent proches les unes des autres. Renvoie le nouveau nombre de sommets.
+size_t optimizeVertexFetch(void *vertices, size_t vertexCount, size_t stride, unsigned int *indices, size_t indexCount);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef MESHSIMPLIFIER_HPP
+#define MESHSIMPLIFIER_HPP
+
+#include <cstddef>
+#include <vector>
+
+// Simplification d'un mesh indexé par fusion d'arêtes, ordonnée par les quadriques d'erreur (Garland-Heckbert).
+// Les sommets ne sont jamais modifiés : une arête est fusionnée sur l'un de ses sommets existants, si bien que
+// le résultat est une nouvelle liste d'indices qui réutilise le même tableau de sommets (un LOD ne coûte que ses indices).
+// Les sommets dont la position est partagée par des sommets d'attributs différents (coutures UV, arêtes vives des normales)
+// et les sommets du bord d'une surface ouverte ne bougent pas, ce qui préserve les coutures, les normales et la silhouette.
+// La position de chaque sommet est le premier vec3 de la structure, les sommets sont espacés de stride octets.
+// Les sommets identiques octet par octet sont considérés comme un seul sommet.
+// Renvoie l'erreur géométrique maximale introduite (distance, dans l'unité des positions).
+float simplifyMesh(const void *vertices, size_t vertexCount, size_t stride,
+                   const unsigned int *indices, size_t indexCount, size_t targetIndexCount,
+                   std::vector<unsigned int> &result);
+
+#endif
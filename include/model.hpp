@@ -1,6 +1,7 @@
 #ifndef MODEL_HPP
 #define MODEL_HPP
 
+#include <memory>
 #include <vector>
 #include <string>
 #include <assimp/Importer.hpp>
@@ -9,41 +10,98 @@
 
 #include "shader.hpp"
 #include "mesh.hpp"
-#include "stb_image.h"
+#include "occlusionBuffer.hpp"
+
+class MappedFile;
+
+// Données d'un modèle lues sur le CPU (fichier précompilé ou Assimp), prêtes à être envoyées au GPU.
+// Peut être rempli sur un thread de travail : aucun appel OpenGL.
+struct ModelData
+{
+    vector<MeshData> meshes;
+    // Le dossier dans lequel se trouve le modèle
+    string directory;
+    bool flipTextureVertically = false;
+    // Fichier précompilé projeté en mémoire, gardé ouvert tant que les meshes pointent dedans
+    shared_ptr<MappedFile> cookedFile;
+    // Géométrie de tous les meshes, simplifiée pour l'occlusion culling (vide si le modèle a trop de triangles)
+    OccluderMesh occluder;
+};
 
 class Model
 {
 public:
+    // Chargement synchrone (lecture et envoi au GPU)
     Model(string path, bool flipTextureVertically)
     {
-        stbi_set_flip_vertically_on_load(flipTextureVertically);
-        loadModel(path);
-    }
-    void Draw(Shader &shader)
-    {
-        for (unsigned int i = 0; i < meshes.size(); i++)
-            meshes[i].Draw(shader);
+        ModelData data;
+        readModelData(path, flipTextureVertically, data);
+        for (MeshData &meshData : data.meshes)
+            uploadMesh(meshData);
+        setOccluder(std::move(data.occluder));
+        finishUpload();
     }
+    // Modèle vide, rempli plus tard par uploadMesh/finishUpload (chargement asynchrone, voir AssetCache)
+    Model() = default;
+    // Un modèle possède ses buffers OpenGL : il est partagé (via AssetCache) mais jamais copié
+    Model(const Model &) = delete;
+    Model &operator=(const Model &) = delete;
+    ~Model() { CleanUp(); }
+
+    // Lit le fichier précompilé, ou le fichier source avec Assimp (qui est alors précompilé pour les prochains lancements).
+    // Les textures sont demandées à l'AssetCache. N'appelle pas OpenGL : utilisable depuis un thread de travail.
+    static bool readModelData(const string &path, bool flipTextureVertically, ModelData &data);
+    // Crée les buffers OpenGL d'un mesh (thread OpenGL)
+    void uploadMesh(MeshData &meshData);
+    // Tous les meshes sont envoyés : le modèle peut être dessiné (thread OpenGL)
+    void finishUpload();
+    void setOccluder(OccluderMesh occluder) { this->occluder = std::move(occluder); }
+    // Les meshes et toutes leurs textures sont-ils sur le GPU ?
+    bool isReady();
+
+    // Dessine une seule copie du modèle
+    void Draw(Shader &shader, const glm::mat4 &modelMatrix) { DrawInstanced(shader, &modelMatrix, 1); }
+    // Dessine instanceCount copies du modèle en un appel par mesh
+    void DrawInstanced(Shader &shader, const glm::mat4 *modelMatrices, GLsizei instanceCount);
     void CleanUp()
     {
         for (unsigned int i = 0; i < meshes.size(); i++)
             meshes[i].CleanUp();
+        meshes.clear();
     }
 
-private:
-    // On stocke toutes les textures chargées pour vérifier par la suite si elles sont déjà chargées
-    vector<Texture> textures_loaded;
+    // Les meshes du modèle (pour le culling et le regroupement des instances par mesh)
+    vector<Mesh> &getMeshes() { return meshes; }
+    // Boîte qui englobe tous les meshes, dans l'espace du modèle
+    const AABB &getBounds() const { return bounds; }
+    // Géométrie d'occulteur (vide si le modèle ne peut pas en servir)
+    const OccluderMesh &getOccluder() const { return occluder; }
 
+private:
     // Les meshes dont est composé le modèle
     vector<Mesh> meshes;
-    // Le dossier dans lequel se trouve le modèle
-    string directory;
+    // Boîte qui englobe tous les meshes
+    AABB bounds;
+    OccluderMesh occluder;
+    // finishUpload a été appelé / le modèle et ses textures sont prêts
+    bool uploaded = false;
+    bool ready = false;
 
-    void loadModel(string path);
-    void processNode(aiNode *node, const aiScene *scene);
-    Mesh processMesh(aiMesh *mesh, const aiScene *scene);
-    vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type,
-                                         string typeName);
+    // Charge le fichier précompilé (projeté en mémoire) s'il existe et correspond encore au fichier source et à l'encodage courant
+    static bool loadCookedModel(const string &path, ModelData &data);
+    // Écrit le fichier précompilé à partir des meshes (déjà compacts) et de l'occulteur que vient de produire Assimp
+    static void cookModel(const string &path, const ModelData &data);
+    // Soude les positions de tous les meshes en un seul OccluderMesh (sans normales ni coordonnées de texture)
+    static void buildOccluder(ModelData &data);
+    static void processNode(aiNode *node, const aiScene *scene, ModelData &data);
+    static MeshData processMesh(aiMesh *mesh, const aiScene *scene, ModelData &data);
+    // Ajoute à la suite des indices les LODs simplifiés du mesh (voir simplifyMesh)
+    static void generateLods(MeshData &meshData);
+    // Soudure des sommets, ordre des triangles (cache de sommets puis overdraw), génération des LODs
+    // et ordre des sommets (lecture du vertex buffer). Affiche l'ACMR et l'ATVR avant et après.
+    static void optimizeMesh(MeshData &meshData, const string &name);
+    static vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type,
+                                                string typeName, const ModelData &data);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,80 @@
+#ifndef OCCLUSIONBUFFER_HPP
+#define OCCLUSIONBUFFER_HPP
+
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "bounds.hpp"
+#include "workerPool.hpp"
+
+// Géométrie simplifiée d'un modèle utilisée pour masquer les autres objets (positions soudées, sans attributs)
+struct OccluderMesh
+{
+    std::vector<glm::vec3> vertices;
+    std::vector<unsigned int> indices;
+
+    bool empty() const { return indices.empty(); }
+};
+
+// Tampon de profondeur basse résolution rempli sur le CPU par les occulteurs, pour éliminer avant tout envoi à OpenGL
+// les objets entièrement cachés derrière eux.
+// Les pixels sont regroupés en tuiles de TILE_SIZE x TILE_SIZE dont on garde la profondeur la plus lointaine :
+// une boîte plus proche que cette profondeur est visible sans examiner les pixels, une boîte plus lointaine est cachée.
+// La rastérisation utilise AVX2 quand le processeur le permet. Cette classe n'utilise pas OpenGL.
+class OcclusionBuffer
+{
+public:
+    static constexpr int TILE_SIZE = 8;
+
+    // Les dimensions sont arrondies au multiple de TILE_SIZE supérieur
+    OcclusionBuffer(int width, int height);
+
+    // Début d'une frame : vide le tampon et la liste des triangles
+    void begin(const glm::mat4 &viewProjection);
+    // Ajoute les triangles d'un occulteur (transformés en coordonnées écran, ceux qui traversent le plan proche sont ignorés)
+    void addOccluder(const OccluderMesh &mesh, const glm::mat4 &modelMatrix);
+    // Rastérise les triangles ajoutés sur threadCount threads (chaque thread remplit ses propres rangées de tuiles).
+    // Les threads sont gardés d'une frame à l'autre tant que threadCount ne change pas.
+    void rasterize(unsigned int threadCount);
+    // La boîte (espace monde) est-elle au moins en partie visible ? Conservatif : en cas de doute, la réponse est oui.
+    bool isVisible(const AABB &worldBounds) const;
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    size_t getTriangleCount() const { return triangles.size(); }
+    // Durée de la dernière rastérisation, en millisecondes
+    double getRasterizeTime() const { return rasterizeTime; }
+
+    // Le processeur supporte-t-il AVX2 ?
+    static bool supportsAVX2();
+    // Force le chemin scalaire (comparaison des deux chemins dans le benchmark)
+    void setUseAVX2(bool enabled) { useAVX2 = enabled && supportsAVX2(); }
+    bool isUsingAVX2() const { return useAVX2; }
+
+private:
+    // Triangle en coordonnées écran : fonctions de bord orientées (positives à l'intérieur) et plan de profondeur
+    struct ScreenTriangle
+    {
+        float edgeA[3], edgeB[3], edgeC[3];
+        float depthA, depthB, depthC;
+        int minX, maxX, minY, maxY;
+    };
+
+    int width, height;
+    int tilesX, tilesY;
+    // Profondeur [0, 1] par pixel (1 = rien) et profondeur la plus lointaine par tuile
+    std::vector<float> depth;
+    std::vector<float> tileMaxDepth;
+    std::vector<ScreenTriangle> triangles;
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+    bool useAVX2;
+    double rasterizeTime = 0.0;
+    std::unique_ptr<WorkerPool> workerPool;
+
+    void rasterizeTileRow(int tileRow);
+    void rasterizeRowsScalar(const ScreenTriangle &triangle, int firstRow, int lastRow);
+    void updateTileRowScalar(int tileRow);
+};
+
+#endif
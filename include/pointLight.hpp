@@ -2,6 +2,9 @@
 #define POINTLIGHT_HPP
 
 #include <glm/vec3.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 
 class PointLight
@@ -19,16 +22,32 @@ PointLight(glm::vec3 position, glm::vec3 ambient, glm::vec3 diffuse, glm::vec3 s
  : mPosition(position), mAmbient(ambient), mDiffuse(diffuse), mSpecular(specular), mConstant(constant), mLinear(linear), mQuadratic(quadratic), mCubeRGB(diffuse) {}
 
 
-void setPosition(glm::vec3 position) { mPosition = position; }
-void setAmbient(glm::vec3 ambient) { mAmbient = ambient; }
-void setDiffuse(glm::vec3 diffuse) { mDiffuse = diffuse; }
-void setSpecular(glm::vec3 specular) { mSpecular = specular; }
-void setConstant(float constant) { mConstant = constant; }
-void setLinear(float linear) { mLinear = linear; }
-void setQuadratic(float quadratic) { mQuadratic = quadratic; }
-void setCubeRGB(glm::vec3 cubeRGB) { mCubeRGB = cubeRGB; }
+void setPosition(glm::vec3 position) { mPosition = position; mDirty = true; }
+void setAmbient(glm::vec3 ambient) { mAmbient = ambient; mDirty = true; }
+void setDiffuse(glm::vec3 diffuse) { mDiffuse = diffuse; mDirty = true; }
+void setSpecular(glm::vec3 specular) { mSpecular = specular; mDirty = true; }
+void setConstant(float constant) { mConstant = constant; mDirty = true; }
+void setLinear(float linear) { mLinear = linear; mDirty = true; }
+void setQuadratic(float quadratic) { mQuadratic = quadratic; mDirty = true; }
+void setCubeRGB(glm::vec3 cubeRGB) { mCubeRGB = cubeRGB; mDirty = true; }
 
-void setCubeSameColor() { mCubeRGB = mDiffuse; } // Set the color of the cube to the same color as the diffuse light
+void setCubeSameColor() { mCubeRGB = mDiffuse; mDirty = true; } // Set the color of the cube to the same color as the diffuse light
+
+// Distance au-delà de laquelle l'atténuation rend la lumière négligeable (moins de 5/256 de son intensité)
+float getRange() const
+{
+    float maxChannel = std::max({mAmbient.r, mAmbient.g, mAmbient.b, mDiffuse.r, mDiffuse.g, mDiffuse.b, mSpecular.r, mSpecular.g, mSpecular.b});
+    float threshold = maxChannel * 256.0f / 5.0f;
+    if (mQuadratic > 0.0f)
+        return (-mLinear + std::sqrt(mLinear * mLinear - 4.0f * mQuadratic * (mConstant - threshold))) / (2.0f * mQuadratic);
+    if (mLinear > 0.0f)
+        return std::max(0.0f, (threshold - mConstant) / mLinear);
+    return std::numeric_limits<float>::max();
+}
+
+// Indique si la lumière a été modifiée depuis son dernier envoi au GPU
+bool isDirty() const { return mDirty; }
+void clearDirty() { mDirty = false; }
 
 glm::vec3 getPosition() { return mPosition; }
 glm::vec3 getAmbient() { return mAmbient; }
@@ -50,6 +69,9 @@ float mQuadratic;
 
 glm::vec3 mCubeRGB;
 
+// Une lumière nouvellement créée doit être envoyée au GPU
+bool mDirty = true;
+
 };
 
 
@@ -0,0 +1,132 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Les marqueurs PROFILE_* disparaissent des builds de release (NDEBUG), sauf si ENABLE_PROFILER est défini à 1
+#ifndef ENABLE_PROFILER
+#ifdef NDEBUG
+#define ENABLE_PROFILER 0
+#else
+#define ENABLE_PROFILER 1
+#endif
+#endif
+
+// Profiler de frame : des scopes CPU imbriqués (nommés par des chaînes littérales), dont certains sont aussi mesurés
+// sur le GPU avec des timestamps (glQueryCounter). Les requêtes d'une frame sont relues PROFILER_FRAME_LATENCY frames
+// plus tard, quand le GPU a fini, pour ne jamais attendre le driver. Les durées sont agrégées par scope (min, moyenne,
+// 99e centile sur les dernières frames) et la chronologie peut être exportée au format Chrome trace (chrome://tracing).
+class Profiler
+{
+public:
+    // Désactivé, chaque marqueur ne coûte qu'un test
+    static void setEnabled(bool enabled);
+    static bool isEnabled() { return enabled; }
+    // Garde les scopes des maxFrames prochaines frames pour writeTrace
+    static void startTrace(size_t maxFrames);
+
+    // Début et fin de frame : la frame est elle-même un scope ("frame"), mesuré sur le CPU et le GPU
+    static void beginFrame();
+    static void endFrame();
+    // gpu : la durée du scope est aussi mesurée sur le GPU (seulement depuis le thread OpenGL)
+    static void beginScope(const char *name, bool gpu);
+    static void endScope();
+
+    // Relit les requêtes encore en attente (en attendant le GPU) : à appeler avant printReport et writeTrace
+    static void flush();
+    // Affiche min / moyenne / p99 des durées CPU et GPU de chaque scope
+    static void printReport();
+    static bool writeTrace(const std::string &path);
+    static void deleteResources();
+
+private:
+    struct Event
+    {
+        const char *name;
+        int depth;
+        double cpuBegin, cpuEnd; // ms depuis le démarrage du profiler
+        int query;               // première des deux requêtes (début, fin) dans la frame, -1 sans mesure GPU
+        double gpuBegin, gpuEnd; // ms, ramenées sur l'horloge du CPU
+    };
+    struct Frame
+    {
+        std::vector<Event> events;
+        std::vector<GLuint> queries;
+        size_t queryCount = 0;
+        bool pending = false;
+    };
+    // Dernières durées d'un scope (anneaux de PROFILER_HISTORY_FRAMES mesures)
+    struct History
+    {
+        const char *name;
+        int depth;
+        std::vector<float> cpu, gpu;
+        size_t nextCpu = 0, nextGpu = 0;
+    };
+
+    static bool enabled;
+    static std::vector<Frame> frames;
+    static size_t currentFrame;
+    static bool frameOpen;
+    static std::vector<size_t> openScopes;
+    static std::vector<History> histories;
+    static std::unordered_map<std::string, size_t> historyIndices;
+    // Correspondance entre les timestamps du GPU (ns) et l'horloge du CPU (ms)
+    static int64_t gpuReference;
+    static double cpuReference;
+    static size_t droppedFrames;
+    // Chronologie gardée pour l'export
+    static std::vector<Event> trace;
+    static size_t traceFramesLeft;
+
+    static double now();
+    static void resolve(Frame &frame, bool wait);
+    static void addSample(std::vector<float> &samples, size_t &next, float value);
+};
+
+// Marqueur d'un scope : mesure du constructeur au destructeur
+class ProfileScope
+{
+public:
+    ProfileScope(const char *name, bool gpu)
+    {
+        if (Profiler::isEnabled())
+        {
+            active = true;
+            Profiler::beginScope(name, gpu);
+        }
+    }
+    ~ProfileScope()
+    {
+        if (active)
+            Profiler::endScope();
+    }
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    // Le profiler peut être activé pendant le scope : seul un scope commencé est terminé
+    bool active = false;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if ENABLE_PROFILER
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name, false)
+#define PROFILE_GPU_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name, true)
+#define PROFILE_BEGIN_FRAME() Profiler::beginFrame()
+#define PROFILE_END_FRAME() Profiler::endFrame()
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_GPU_SCOPE(name) ((void)0)
+#define PROFILE_BEGIN_FRAME() ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+#endif
+
+#endif
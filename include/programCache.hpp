@@ -0,0 +1,80 @@
+#ifndef PROGRAMCACHE_HPP
+#define PROGRAMCACHE_HPP
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Fichier d'un programme mis en cache : ProgramCacheHeader suivi des binaryLength octets renvoyés par glGetProgramBinary
+constexpr char PROGRAM_CACHE_MAGIC[4] = {'Y', 'P', 'R', 'G'};
+// À incrémenter à chaque changement du format des fichiers ou de la construction des clés
+constexpr uint32_t PROGRAM_CACHE_VERSION = 1;
+constexpr const char *PROGRAM_CACHE_EXTENSION = ".yprog";
+
+struct ProgramCacheHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t binaryFormat;
+    uint32_t binaryLength;
+};
+
+// Cache disque des programmes liés (glGetProgramBinary / glProgramBinary, OpenGL 4.1 ou GL_ARB_get_program_binary).
+// La clé d'un programme est un hash de ses sources (includes développés), de ses defines et du driver (vendeur, renderer
+// et version) : un changement de driver donne d'autres clés, et un binaire refusé par le driver est simplement recompilé.
+// Gère aussi GL_KHR_parallel_shader_compile, qui permet de savoir si une édition de liens est finie sans l'attendre.
+class ProgramCache
+{
+public:
+    struct Stats
+    {
+        size_t loaded = 0;         // programmes chargés depuis le cache
+        size_t compiled = 0;       // programmes compilés (absents du cache, refusés ou cache désactivé)
+        size_t rejected = 0;       // binaires présents mais refusés par le driver
+        double loadTime = 0.0;     // ms passées à lire les binaires
+        double submitTime = 0.0;   // ms passées à envoyer les compilations au driver
+        double waitTime = 0.0;     // ms passées à attendre la fin des compilations
+    };
+
+    // Charge les fonctions absentes de GLAD et crée le dossier du cache (directory vide : cache désactivé)
+    static void init(const std::string &directory, GLADloadproc loader);
+    static bool isEnabled() { return enabled; }
+    static bool isParallelCompileSupported() { return maxShaderCompilerThreads != nullptr; }
+
+    static uint64_t makeKey(const std::string &vertexCode, const std::string &fragmentCode, const std::string &defines);
+    // Charge le binaire de la clé dans program. Renvoie false (et le programme doit être compilé) s'il est absent ou refusé.
+    static bool load(GLuint program, uint64_t key);
+    // À appeler avant glLinkProgram pour que le driver garde le binaire du programme
+    static void prepareLink(GLuint program);
+    // Écrit le binaire d'un programme lié avec succès
+    static void store(GLuint program, uint64_t key);
+    // Vrai si l'édition de liens est terminée (toujours vrai sans GL_KHR_parallel_shader_compile)
+    static bool isLinkCompleted(GLuint program);
+
+    static void addCompileTimes(double submitTime, double waitTime);
+    static const Stats &getStats() { return stats; }
+    static void printStats();
+
+private:
+    typedef void(APIENTRYP GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+    typedef void(APIENTRYP ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+    typedef void(APIENTRYP ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+    typedef void(APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+
+    static GetProgramBinaryProc getProgramBinary;
+    static ProgramBinaryProc programBinary;
+    static ProgramParameteriProc programParameteri;
+    static MaxShaderCompilerThreadsProc maxShaderCompilerThreads;
+
+    static bool enabled;
+    static std::string directory;
+    // Vendeur, renderer et version du driver, ajoutés à chaque clé
+    static std::string driver;
+    static Stats stats;
+
+    static std::string pathOf(uint64_t key);
+};
+
+#endif
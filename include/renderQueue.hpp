@@ -0,0 +1,50 @@
+#ifndef RENDERQUEUE_HPP
+#define RENDERQUEUE_HPP
+
+#include <cstdint>
+#include <vector>
+
+// Passes de rendu, dans l'ordre de dessin
+enum class RenderPass : uint8_t
+{
+    Opaque = 0,     // de l'avant vers l'arrière, pour que le test de profondeur élimine le plus de fragments
+    Transparent = 1 // de l'arrière vers l'avant, pour que le mélange soit correct
+};
+
+// Élément de la file : clé de tri et indice du draw chez l'appelant
+struct RenderItem
+{
+    uint64_t key;
+    uint32_t index;
+};
+
+// File de rendu : chaque draw visible reçoit une clé de 64 bits qui regroupe les draws par état OpenGL
+// (passe, programme, matériau, VAO) puis les ordonne par profondeur, et la file est triée par radix sort
+class RenderQueue
+{
+public:
+    // Bits de chaque champ de la clé, du plus significatif au moins significatif
+    static const int PASS_BITS = 2;
+    static const int PROGRAM_BITS = 8;
+    static const int MATERIAL_BITS = 16;
+    static const int VERTEX_ARRAY_BITS = 14;
+    static const int DEPTH_BITS = 24;
+
+    // depth : distance normalisée entre 0 (caméra) et 1 (plan lointain). Les identifiants sont tronqués à leur nombre de bits :
+    // deux états différents peuvent partager une valeur, ce qui ne change que l'ordre, jamais le rendu.
+    static uint64_t makeKey(RenderPass pass, unsigned int program, unsigned int material, unsigned int vertexArray, float depth);
+    static RenderPass getPass(uint64_t key) { return (RenderPass)(key >> (64 - PASS_BITS)); }
+
+    void clear() { items.clear(); }
+    void push(uint64_t key, uint32_t index) { items.push_back({key, index}); }
+    // Tri stable par clé croissante (radix sort, octet par octet)
+    void sort();
+    const std::vector<RenderItem> &getItems() const { return items; }
+
+private:
+    std::vector<RenderItem> items;
+    // Tableau de travail du tri, conservé d'une frame à l'autre
+    std::vector<RenderItem> scratch;
+};
+
+#endif
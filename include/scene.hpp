@@ -0,0 +1,64 @@
+#ifndef SCENE_HPP
+#define SCENE_HPP
+
+#include <glm/glm.hpp>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gameObject.hpp"
+#include "aabbTree.hpp"
+#include "frustum.hpp"
+
+// Possède les GameObjects et les range dans une BVH (AABBTree) selon leur boîte dans l'espace du monde.
+// Les GameObjects signalent leurs changements de transformation ; update() ne remet à jour que ceux-là
+// et reconstruit l'arbre quand sa qualité s'est trop dégradée.
+class Scene
+{
+public:
+    Scene();
+
+    // Ajoute un GameObject à la scène et renvoie une référence vers lui
+    GameObject &add(std::unique_ptr<GameObject> gameObject);
+    // Recherche d'un GameObject par son nom (nullptr s'il n'existe pas)
+    GameObject *find(const std::string &name) const;
+    const std::vector<std::unique_ptr<GameObject>> &getGameObjects() const { return gameObjects; }
+    size_t size() const { return gameObjects.size(); }
+    // Supprime tous les GameObjects (avant la destruction du contexte OpenGL)
+    void clear();
+
+    // Appelé par un GameObject dont la matrice de modèle a changé
+    void onTransformChanged(GameObject &gameObject);
+    // Met à jour la BVH (objets déplacés, modèles qui ont fini de charger), à appeler une fois par frame avant les requêtes
+    void update();
+
+    // GameObjects dont la boîte (élargie) touche le frustum
+    void queryFrustum(const Frustum &frustum, std::vector<GameObject *> &results) const;
+    // GameObjects dont la boîte touche la sphère
+    void querySphere(const glm::vec3 &center, float radius, std::vector<GameObject *> &results) const;
+    // Au moins un GameObject touche-t-il la sphère ?
+    bool touchesSphere(const glm::vec3 &center, float radius) const { return tree.overlapsSphere(center, radius); }
+    // GameObject le plus proche touché par le rayon (direction normalisée), nullptr sinon
+    GameObject *raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, float *hitDistance = nullptr) const;
+    // Les k GameObjects les plus proches du point
+    void queryNearest(const glm::vec3 &point, size_t k, std::vector<GameObject *> &results) const;
+
+private:
+    std::vector<std::unique_ptr<GameObject>> gameObjects;
+    std::unordered_map<std::string, GameObject *> gameObjectsByName;
+    AABBTree tree;
+    // GameObjects à remettre à jour dans l'arbre à la prochaine update()
+    std::vector<GameObject *> movedObjects;
+    // GameObjects dont le modèle est encore en chargement (leur boîte changera quand il sera prêt)
+    std::vector<GameObject *> loadingObjects;
+    // Rapport des surfaces juste après la dernière reconstruction
+    float rebuiltAreaRatio = 0.0f;
+    bool treeChanged = false;
+    // Résultats bruts des requêtes, conservés pour ne pas ré-allouer
+    mutable std::vector<void *> queryResults;
+
+    void copyResults(std::vector<GameObject *> &results) const;
+};
+
+#endif
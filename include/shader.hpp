@@ -3,6 +3,11 @@
 // #pragma once
 
 #include <glad/glad.h> // inclure glad pour disposer de tout en-tête OpenGL
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 class Shader
 {
@@ -13,12 +18,54 @@ public:
     // Constructeur vide par défaut
     Shader() = default;
 
-    // Le constructeur lit et construit le shader
-    Shader(const GLchar *vertexPath, const GLchar *fragmentPath);
+    // Le constructeur lit le shader et le charge depuis le ProgramCache, ou envoie sa compilation au driver sans l'attendre :
+    // le résultat n'est lu qu'à la première utilisation du programme (use, bindUniformBlock, getUniformLocation).
+    // defines : lignes "#define ..." ajoutées après #version dans les deux shaders ("NOM" ou "NOM valeur")
+    Shader(const GLchar *vertexPath, const GLchar *fragmentPath, const std::vector<std::string> &defines = {});
+    // Vrai si le programme peut être utilisé sans attendre la fin de sa compilation
+    bool isReady() const;
+    // Temps passé sur le programme (lecture du cache, ou envoi de la compilation et attente du résultat), en ms
+    double getCompileTime() const { return compileTime; }
     // Suppression du programme
     void deleteProgram();
     // Activation du shader
     void use();
+
+    // Relie un bloc d'uniforms (UBO) du programme à un point de liaison
+    void bindUniformBlock(const std::string &blockName, GLuint bindingPoint) const;
+
+    // Renvoie la location d'un uniform depuis la table remplie après l'édition de liens (-1 si l'uniform n'est pas actif)
+    GLint getUniformLocation(const std::string &name) const;
+
+    // Setters typés à partir d'une location précalculée avec getUniformLocation
+    void setInt(GLint location, int value) const { glUniform1i(location, value); }
+    void setFloat(GLint location, float value) const { glUniform1f(location, value); }
+    void setVec2(GLint location, const glm::vec2 &value) const { glUniform2fv(location, 1, &value[0]); }
+    void setVec3(GLint location, const glm::vec3 &value) const { glUniform3fv(location, 1, &value[0]); }
+    void setMat4(GLint location, const glm::mat4 &value) const { glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]); }
+
+    // Setters typés à partir du nom de l'uniform (une recherche dans la table, aucun appel au driver)
+    void setInt(const std::string &name, int value) const { setInt(getUniformLocation(name), value); }
+    void setFloat(const std::string &name, float value) const { setFloat(getUniformLocation(name), value); }
+    void setVec2(const std::string &name, const glm::vec2 &value) const { setVec2(getUniformLocation(name), value); }
+    void setVec3(const std::string &name, const glm::vec3 &value) const { setVec3(getUniformLocation(name), value); }
+    void setMat4(const std::string &name, const glm::mat4 &value) const { setMat4(getUniformLocation(name), value); }
+
+private:
+    // Table nom -> location de tous les uniforms actifs du programme
+    mutable std::unordered_map<std::string, GLint> uniformLocations;
+
+    // Compilation envoyée au driver mais pas encore vérifiée (shaders à détacher et supprimer une fois le programme lié)
+    mutable bool linkPending = false;
+    mutable unsigned int pendingVertex = 0, pendingFragment = 0;
+    double submitTime = 0.0;
+    mutable double compileTime = 0.0;
+    uint64_t cacheKey = 0;
+
+    // Attend la fin de la compilation, affiche les erreurs et met le programme en cache
+    void finishLink() const;
+    // Interroge le programme lié pour remplir la table des uniforms actifs
+    void cacheUniformLocations() const;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,91 @@
+#ifndef SHADERVARIANTS_HPP
+#define SHADERVARIANTS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "shader.hpp"
+
+// Fonctionnalités d'un matériau qui changent le code du fragment shader (bits de Mesh::getShaderFeatures)
+enum ShaderFeature : uint32_t
+{
+    SHADER_FEATURE_SPECULAR_MAP = 1 << 0, // define HAS_SPECULAR_MAP : le mesh a une texture spéculaire
+};
+constexpr uint32_t SHADER_FEATURE_ALL = SHADER_FEATURE_SPECULAR_MAP;
+
+// Nombre maximal de lumières d'un type pour lequel on compile une variante avec un nombre fixe de lumières
+// (boucles que le compilateur peut dérouler) ; au-delà, le nombre est lu dans le bloc Lights
+constexpr int SHADER_VARIANT_MAX_FIXED_LIGHTS = 16;
+
+// Programmes compilés à partir des mêmes fichiers avec des defines différents : un par combinaison de fonctionnalités
+// des matériaux et de configuration de l'éclairage de la frame. Chaque draw utilise la variante la moins chère
+// qui reste correcte pour son matériau. Les variantes sont compilées à la première demande (ou par prepare)
+// et passent par le ProgramCache comme les autres programmes.
+// Le programme complet doit donner la même image que chaque variante (il les remplace pendant leur compilation
+// et avec --no-shader-variants) : un define de fonctionnalité ne fait qu'éviter un calcul dont le résultat est connu,
+// et le mesh lie ce qu'il faut pour que le programme complet obtienne le même résultat (voir Mesh::bindTextures).
+class ShaderVariants
+{
+public:
+    // setup est appelé sur chaque nouvelle variante (blocs d'uniforms, samplers, uniforms constants)
+    void create(const std::string &vertexPath, const std::string &fragmentPath, std::function<void(Shader &)> setup);
+    void deleteResources();
+    // Désactivées, toutes les demandes renvoient le programme complet (getDefault)
+    void setEnabled(bool enabled) { this->enabled = enabled; }
+    bool isEnabled() const { return enabled; }
+
+    // Éclairage des frames suivantes : nombre de lumières et mode clustered (defines NUM_POINT_LIGHTS, NUM_SPOT_LIGHTS,
+    // LIGHTING_CLUSTERED). Inutile pour les shaders qui n'éclairent pas (passe géométrie du rendu deferred).
+    void setLighting(int pointLightCount, int spotLightCount, bool clustered);
+    // Envoie au driver les compilations de toutes les combinaisons de fonctionnalités pour l'éclairage actuel
+    // (le driver peut les compiler en parallèle) et n'attend que le programme complet. Une variante dont l'édition
+    // de liens n'est pas finie est remplacée par le programme complet dans les draws, jusqu'à ce qu'elle soit prête.
+    void prepare();
+    // Attend la fin de toutes les compilations envoyées (benchmark : les frames mesurées utilisent les vraies variantes)
+    void finish();
+
+    // Variante pour les fonctionnalités d'un matériau (bits ShaderFeature), ou programme complet si elle n'est pas encore prête
+    Shader &get(uint32_t features);
+    // Programme complet : toutes les fonctionnalités, nombre de lumières et mode lus dans le bloc Lights
+    Shader &getDefault();
+    // Active la variante (via GLState) : les draws comptés ensuite avec addDraws lui sont attribués
+    Shader &use(uint32_t features);
+    void addDraws(size_t drawCalls);
+
+    size_t getVariantCount() const { return variants.size(); }
+    // Affiche les variantes compilées avec leurs defines, leur temps de compilation et leur nombre de draws
+    void printStats() const;
+
+private:
+    struct Variant
+    {
+        std::unique_ptr<Shader> shader;
+        std::string description;
+        size_t drawCalls = 0;
+        // Compilation envoyée, setup pas encore appelé
+        bool setupPending = false;
+    };
+
+    std::string vertexPath, fragmentPath;
+    std::function<void(Shader &)> setup;
+    bool enabled = true;
+    // Partie de la clé et defines qui viennent de l'éclairage (aucun : lu dans le bloc Lights)
+    uint32_t lightingKey = 0;
+    std::vector<std::string> lightingDefines;
+    std::unordered_map<uint64_t, Variant> variants;
+    Variant *current = nullptr;
+
+    // Crée la variante si besoin, sans attendre la fin de sa compilation (finishVariant appelle ensuite setup)
+    Variant &find(uint32_t features, uint32_t lighting, const std::vector<std::string> &defines);
+    Variant &find(uint32_t features);
+    Variant &getDefaultVariant();
+    // Appelle setup une fois la compilation finie. Sans wait, renvoie faux au lieu d'attendre une édition de liens en cours.
+    bool finishVariant(Variant &variant, bool wait);
+};
+
+#endif
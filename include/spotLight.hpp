@@ -2,6 +2,9 @@
 #define SPOTLIGHT_HPP
 
 #include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 class SpotLight
 {
@@ -16,16 +19,32 @@ SpotLight(glm::vec3 position, glm::vec3 direction, glm::vec3 ambient, glm::vec3
 float getCosCutOff() const { return glm::cos(glm::radians(mCutOff)); }
 float getCosOuterCutOff() const { return glm::cos(glm::radians(mOuterCutOff)); }
 
-void setPosition(glm::vec3 position) { mPosition = position; }
-void setDirection(glm::vec3 direction) { mDirection = direction; }
-void setAmbient(glm::vec3 ambient) { mAmbient = ambient; }
-void setDiffuse(glm::vec3 diffuse) { mDiffuse = diffuse; }
-void setSpecular(glm::vec3 specular) { mSpecular = specular; }
-void setConstant(float constant) { mConstant = constant; }
-void setLinear(float linear) { mLinear = linear; }
-void setQuadratic(float quadratic) { mQuadratic = quadratic; }
-void setCutOff(float cutOff) { mCutOff = cutOff; }
-void setOuterCutOff(float outerCutOff) { mOuterCutOff = outerCutOff; }
+void setPosition(glm::vec3 position) { mPosition = position; mDirty = true; }
+void setDirection(glm::vec3 direction) { mDirection = direction; mDirty = true; }
+void setAmbient(glm::vec3 ambient) { mAmbient = ambient; mDirty = true; }
+void setDiffuse(glm::vec3 diffuse) { mDiffuse = diffuse; mDirty = true; }
+void setSpecular(glm::vec3 specular) { mSpecular = specular; mDirty = true; }
+void setConstant(float constant) { mConstant = constant; mDirty = true; }
+void setLinear(float linear) { mLinear = linear; mDirty = true; }
+void setQuadratic(float quadratic) { mQuadratic = quadratic; mDirty = true; }
+void setCutOff(float cutOff) { mCutOff = cutOff; mDirty = true; }
+void setOuterCutOff(float outerCutOff) { mOuterCutOff = outerCutOff; mDirty = true; }
+
+// Distance au-delà de laquelle l'atténuation rend la lumière négligeable (moins de 5/256 de son intensité)
+float getRange() const
+{
+    float maxChannel = std::max({mAmbient.r, mAmbient.g, mAmbient.b, mDiffuse.r, mDiffuse.g, mDiffuse.b, mSpecular.r, mSpecular.g, mSpecular.b});
+    float threshold = maxChannel * 256.0f / 5.0f;
+    if (mQuadratic > 0.0f)
+        return (-mLinear + std::sqrt(mLinear * mLinear - 4.0f * mQuadratic * (mConstant - threshold))) / (2.0f * mQuadratic);
+    if (mLinear > 0.0f)
+        return std::max(0.0f, (threshold - mConstant) / mLinear);
+    return std::numeric_limits<float>::max();
+}
+
+// Indique si la lumière a été modifiée depuis son dernier envoi au GPU
+bool isDirty() const { return mDirty; }
+void clearDirty() { mDirty = false; }
 
 glm::vec3 getPosition() { return mPosition; }
 glm::vec3 getDirection() { return mDirection; }
@@ -50,6 +69,9 @@ float mQuadratic;
 float mCutOff;
 float mOuterCutOff;
 
+// Une lumière nouvellement créée doit être envoyée au GPU
+bool mDirty = true;
+
 };
 
 
@@ -0,0 +1,33 @@
+#ifndef TEXTUREBUFFER_HPP
+#define TEXTUREBUFFER_HPP
+
+#include <glad/glad.h>
+
+// Buffer lu dans les shaders via un samplerBuffer (texelFetch), disponible dès OpenGL 3.1
+// Contrairement à un UBO, sa taille n'est limitée que par GL_MAX_TEXTURE_BUFFER_SIZE
+class TextureBuffer
+{
+public:
+    TextureBuffer() = default;
+
+    // Crée le buffer et la texture qui l'expose avec le format de texel internalFormat (ex : GL_RGBA32F)
+    void create(GLenum internalFormat);
+    // Ré-alloue le buffer à la taille size (le contenu précédent est perdu)
+    void resize(GLsizeiptr size);
+    // Ré-envoie uniquement la plage [offset, offset + size) du buffer
+    void update(GLintptr offset, GLsizeiptr size, const void *data);
+    // Lie la texture à l'unité de texture unit
+    void bind(GLuint unit) const;
+    // Suppression du buffer et de la texture
+    void deleteBuffer();
+
+    GLsizeiptr getSize() const { return size; }
+
+private:
+    unsigned int bufferID = 0;
+    unsigned int textureID = 0;
+    GLenum internalFormat = GL_RGBA32F;
+    GLsizeiptr size = 0;
+};
+
+#endif
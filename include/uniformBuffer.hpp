@@ -0,0 +1,31 @@
+#ifndef UNIFORMBUFFER_HPP
+#define UNIFORMBUFFER_HPP
+
+#include <glad/glad.h>
+
+#include "shader.hpp"
+
+// Uniform Buffer Object (UBO) attaché à un point de liaison, partagé par tous les programmes qui déclarent le bloc
+class UniformBuffer
+{
+public:
+    UniformBuffer() = default;
+
+    // Alloue le buffer (contenu initialisé à zéro) et l'attache au point de liaison
+    void create(GLsizeiptr size, GLuint bindingPoint);
+    // Ré-envoie uniquement la plage [offset, offset + size) du buffer
+    void update(GLintptr offset, GLsizeiptr size, const void *data);
+    // Relie le bloc blockName du shader au point de liaison de ce buffer
+    void bindToShader(const Shader &shader, const std::string &blockName) const;
+    // Suppression du buffer
+    void deleteBuffer();
+
+    GLuint getBindingPoint() const { return bindingPoint; }
+
+private:
+    unsigned int ID = 0;
+    GLuint bindingPoint = 0;
+    GLsizeiptr size = 0;
+};
+
+#endif
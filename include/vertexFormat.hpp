@@ -0,0 +1,43 @@
+#ifndef VERTEXFORMAT_HPP
+#define VERTEXFORMAT_HPP
+
+#include <glm/glm.hpp>
+#include <cstdint>
+
+#include "bounds.hpp"
+
+// Encodage des positions dans les sommets envoyés au GPU
+enum class PositionEncoding
+{
+    // Entiers 16 bits normalisés dans la boîte englobante du mesh (précision : taille de la boîte / 65535)
+    Quantized,
+    // Demi-flottants (précision relative, meilleure près de l'origine du modèle)
+    HalfFloat
+};
+
+// Sommet compact envoyé au GPU (16 octets au lieu des 32 de Vertex), décodé par vertexFormat.glsl
+struct PackedVertex
+{
+    uint16_t position[4]; // unorm16 ou half float selon PositionEncoding (le 4e sert d'alignement)
+    int16_t normal[2];    // normale en encodage octaédrique, snorm16
+    uint16_t texCoords[2]; // half float
+};
+static_assert(sizeof(PackedVertex) == 16, "PackedVertex doit faire 16 octets");
+
+// Transformation affine qui retrouve la position du modèle : position = offset + valeur décodée * scale
+struct PositionDecode
+{
+    glm::vec3 offset;
+    glm::vec3 scale;
+};
+
+// Décodage à appliquer aux positions d'un mesh de boîte englobante bounds
+PositionDecode computePositionDecode(PositionEncoding encoding, const AABB &bounds);
+// Encode une position avec le décodage calculé par computePositionDecode
+void packPosition(const glm::vec3 &position, PositionEncoding encoding, const PositionDecode &decode, uint16_t out[4]);
+// Projette la normale (unitaire) sur un octaèdre puis la déplie dans le carré [-1, 1]², en snorm16
+void packNormal(const glm::vec3 &normal, int16_t out[2]);
+// Conversion en demi-flottant IEEE 754 (arrondi au plus proche)
+uint16_t packHalf(float value);
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef WORKERPOOL_HPP
+#define WORKERPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Threads gardés en vie d'une frame à l'autre pour les traitements découpés en tâches indépendantes
+// (binning des lumières, rastérisation de l'occlusion) : évite de créer et de joindre des threads à chaque frame.
+// Contrairement au JobSystem, run() attend la fin de toutes les tâches et le thread appelant y participe.
+class WorkerPool
+{
+public:
+    // threadCount inclut le thread appelant : threadCount - 1 threads sont créés
+    explicit WorkerPool(unsigned int threadCount);
+    ~WorkerPool();
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    // Exécute task(0) ... task(taskCount - 1) sur les threads du pool et le thread appelant, et attend la fin
+    void run(unsigned int taskCount, const std::function<void(unsigned int)> &task);
+    unsigned int getThreadCount() const { return (unsigned int)workers.size() + 1; }
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workDone;
+    bool stopping = false;
+    // Incrémenté à chaque run() pour réveiller les threads
+    unsigned int generation = 0;
+    unsigned int activeWorkers = 0;
+
+    const std::function<void(unsigned int)> *task = nullptr;
+    unsigned int taskCount = 0;
+    std::atomic<unsigned int> nextTask{0};
+
+    void workerLoop();
+    void executeTasks();
+};
+
+#endif
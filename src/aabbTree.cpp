@@ -0,0 +1,571 @@
+#include "aabbTree.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <utility>
+
+// Demi-surface d'une boîte (suffisante pour comparer des coûts SAH)
+static float surfaceArea(const AABB &box)
+{
+    glm::vec3 size = box.max - box.min;
+    return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+static bool contains(const AABB &outer, const AABB &inner)
+{
+    return glm::all(glm::lessThanEqual(outer.min, inner.min)) && glm::all(glm::greaterThanEqual(outer.max, inner.max));
+}
+
+// Carré de la distance d'un point à une boîte (0 si le point est dedans)
+static float distanceSquared(const AABB &box, const glm::vec3 &point)
+{
+    glm::vec3 delta = glm::clamp(point, box.min, box.max) - point;
+    return glm::dot(delta, delta);
+}
+
+int AABBTree::allocateNode()
+{
+    if (freeList == NULL_NODE)
+    {
+        nodes.push_back(Node());
+        return (int)nodes.size() - 1;
+    }
+    int node = freeList;
+    freeList = nodes[node].parent;
+    nodes[node] = Node();
+    return node;
+}
+
+void AABBTree::freeNode(int node)
+{
+    nodes[node].parent = freeList;
+    nodes[node].height = -1;
+    nodes[node].userData = nullptr;
+    freeList = node;
+}
+
+int AABBTree::createProxy(const AABB &box, void *userData)
+{
+    int proxy = allocateNode();
+    nodes[proxy].tightBox = box;
+    nodes[proxy].box.min = box.min - glm::vec3(margin);
+    nodes[proxy].box.max = box.max + glm::vec3(margin);
+    nodes[proxy].userData = userData;
+    nodes[proxy].height = 0;
+    insertLeaf(proxy);
+    proxyCount++;
+    return proxy;
+}
+
+void AABBTree::destroyProxy(int proxy)
+{
+    removeLeaf(proxy);
+    freeNode(proxy);
+    proxyCount--;
+}
+
+bool AABBTree::moveProxy(int proxy, const AABB &box)
+{
+    nodes[proxy].tightBox = box;
+    if (contains(nodes[proxy].box, box))
+        return false;
+
+    removeLeaf(proxy);
+    nodes[proxy].box.min = box.min - glm::vec3(margin);
+    nodes[proxy].box.max = box.max + glm::vec3(margin);
+    insertLeaf(proxy);
+    return true;
+}
+
+void AABBTree::insertLeaf(int leaf)
+{
+    if (root == NULL_NODE)
+    {
+        root = leaf;
+        nodes[root].parent = NULL_NODE;
+        return;
+    }
+
+    // Descente vers le meilleur frère : à chaque noeud, on compare le coût de créer un parent ici
+    // avec le coût (minimal) de descendre dans chacun des enfants
+    const AABB &leafBox = nodes[leaf].box;
+    int index = root;
+    while (!nodes[index].isLeaf())
+    {
+        int left = nodes[index].left;
+        int right = nodes[index].right;
+
+        float area = surfaceArea(nodes[index].box);
+        float combinedArea = surfaceArea(mergeAABB(nodes[index].box, leafBox));
+        float cost = 2.0f * combinedArea;
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto descendCost = [&](int child)
+        {
+            AABB merged = mergeAABB(leafBox, nodes[child].box);
+            if (nodes[child].isLeaf())
+                return surfaceArea(merged) + inheritanceCost;
+            return surfaceArea(merged) - surfaceArea(nodes[child].box) + inheritanceCost;
+        };
+        float leftCost = descendCost(left);
+        float rightCost = descendCost(right);
+
+        if (cost < leftCost && cost < rightCost)
+            break;
+        index = leftCost < rightCost ? left : right;
+    }
+    int sibling = index;
+
+    // Nouveau parent commun à la feuille et à son frère
+    int oldParent = nodes[sibling].parent;
+    int newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].box = mergeAABB(leafBox, nodes[sibling].box);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].left = sibling;
+    nodes[newParent].right = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent == NULL_NODE)
+        root = newParent;
+    else if (nodes[oldParent].left == sibling)
+        nodes[oldParent].left = newParent;
+    else
+        nodes[oldParent].right = newParent;
+
+    refit(nodes[leaf].parent);
+}
+
+void AABBTree::removeLeaf(int leaf)
+{
+    if (leaf == root)
+    {
+        root = NULL_NODE;
+        return;
+    }
+
+    // Le frère prend la place du parent, qui est supprimé
+    int parent = nodes[leaf].parent;
+    int grandParent = nodes[parent].parent;
+    int sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+    if (grandParent == NULL_NODE)
+    {
+        root = sibling;
+        nodes[sibling].parent = NULL_NODE;
+        freeNode(parent);
+        return;
+    }
+
+    if (nodes[grandParent].left == parent)
+        nodes[grandParent].left = sibling;
+    else
+        nodes[grandParent].right = sibling;
+    nodes[sibling].parent = grandParent;
+    freeNode(parent);
+
+    refit(grandParent);
+}
+
+// Remonte jusqu'à la racine en rééquilibrant et en recalculant les boîtes et hauteurs
+void AABBTree::refit(int node)
+{
+    while (node != NULL_NODE)
+    {
+        node = balance(node);
+        int left = nodes[node].left;
+        int right = nodes[node].right;
+        nodes[node].height = 1 + std::max(nodes[left].height, nodes[right].height);
+        nodes[node].box = mergeAABB(nodes[left].box, nodes[right].box);
+        node = nodes[node].parent;
+    }
+}
+
+// Rotation si un sous-arbre est plus haut que l'autre de plus d'un niveau. Renvoie la nouvelle racine du sous-arbre.
+int AABBTree::balance(int a)
+{
+    Node &nodeA = nodes[a];
+    if (nodeA.isLeaf() || nodeA.height < 2)
+        return a;
+
+    int b = nodeA.left;
+    int c = nodeA.right;
+    int heightDifference = nodes[c].height - nodes[b].height;
+    if (heightDifference >= -1 && heightDifference <= 1)
+        return a;
+
+    // Le sous-arbre le plus haut (up) remonte à la place de a
+    int up = heightDifference > 1 ? c : b;
+    int f = nodes[up].left;
+    int g = nodes[up].right;
+
+    nodes[up].left = a;
+    nodes[up].parent = nodes[a].parent;
+    nodes[a].parent = up;
+
+    if (nodes[up].parent == NULL_NODE)
+        root = up;
+    else if (nodes[nodes[up].parent].left == a)
+        nodes[nodes[up].parent].left = up;
+    else
+        nodes[nodes[up].parent].right = up;
+
+    // Le plus haut des petits-enfants reste sous up, l'autre descend sous a
+    int keep = nodes[f].height > nodes[g].height ? f : g;
+    int give = keep == f ? g : f;
+    nodes[up].right = keep;
+    if (heightDifference > 1)
+        nodes[a].right = give;
+    else
+        nodes[a].left = give;
+    nodes[give].parent = a;
+
+    nodes[a].box = mergeAABB(nodes[nodes[a].left].box, nodes[nodes[a].right].box);
+    nodes[a].height = 1 + std::max(nodes[nodes[a].left].height, nodes[nodes[a].right].height);
+    nodes[up].box = mergeAABB(nodes[a].box, nodes[keep].box);
+    nodes[up].height = 1 + std::max(nodes[a].height, nodes[keep].height);
+    return up;
+}
+
+float AABBTree::getAreaRatio() const
+{
+    if (root == NULL_NODE)
+        return 0.0f;
+    float rootArea = surfaceArea(nodes[root].box);
+    if (rootArea <= 0.0f)
+        return 0.0f;
+
+    float totalArea = 0.0f;
+    for (const Node &node : nodes)
+    {
+        if (node.height > 0)
+            totalArea += surfaceArea(node.box);
+    }
+    return totalArea / rootArea;
+}
+
+void AABBTree::rebuild()
+{
+    // On garde les feuilles (leurs identifiants sont connus des utilisateurs) et on libère les noeuds internes
+    std::vector<int> leaves;
+    leaves.reserve(proxyCount);
+    for (int i = 0; i < (int)nodes.size(); i++)
+    {
+        if (nodes[i].height < 0)
+            continue;
+        if (nodes[i].isLeaf())
+        {
+            nodes[i].parent = NULL_NODE;
+            leaves.push_back(i);
+        }
+        else
+        {
+            freeNode(i);
+        }
+    }
+    root = leaves.empty() ? NULL_NODE : buildSAH(leaves, 0, leaves.size());
+}
+
+// Construction descendante : à chaque niveau, on coupe l'ensemble selon le meilleur des plans testés (SAH par intervalles)
+int AABBTree::buildSAH(std::vector<int> &leaves, size_t begin, size_t end)
+{
+    if (end - begin == 1)
+        return leaves[begin];
+
+    AABB bounds = nodes[leaves[begin]].box;
+    AABB centroidBounds;
+    centroidBounds.min = centroidBounds.max = bounds.getCenter();
+    for (size_t i = begin; i < end; i++)
+    {
+        bounds = mergeAABB(bounds, nodes[leaves[i]].box);
+        glm::vec3 centroid = nodes[leaves[i]].box.getCenter();
+        centroidBounds.min = glm::min(centroidBounds.min, centroid);
+        centroidBounds.max = glm::max(centroidBounds.max, centroid);
+    }
+
+    constexpr int BIN_COUNT = 12;
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    int bestSplit = 0;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        float axisMin = centroidBounds.min[axis];
+        float axisExtent = centroidBounds.max[axis] - axisMin;
+        if (axisExtent <= 0.0f)
+            continue;
+
+        int counts[BIN_COUNT] = {};
+        AABB binBounds[BIN_COUNT];
+        for (size_t i = begin; i < end; i++)
+        {
+            const AABB &box = nodes[leaves[i]].box;
+            int bin = std::min(BIN_COUNT - 1, (int)((box.getCenter()[axis] - axisMin) / axisExtent * BIN_COUNT));
+            binBounds[bin] = counts[bin] == 0 ? box : mergeAABB(binBounds[bin], box);
+            counts[bin]++;
+        }
+
+        // Coût de chaque coupe : surface * nombre de feuilles de chaque côté (balayages gauche puis droite)
+        float leftArea[BIN_COUNT - 1];
+        int leftCount[BIN_COUNT - 1];
+        AABB accumulated;
+        int count = 0;
+        for (int split = 0; split < BIN_COUNT - 1; split++)
+        {
+            if (counts[split] > 0)
+                accumulated = count == 0 ? binBounds[split] : mergeAABB(accumulated, binBounds[split]);
+            count += counts[split];
+            leftArea[split] = count > 0 ? surfaceArea(accumulated) : 0.0f;
+            leftCount[split] = count;
+        }
+        count = 0;
+        for (int split = BIN_COUNT - 2; split >= 0; split--)
+        {
+            if (counts[split + 1] > 0)
+                accumulated = count == 0 ? binBounds[split + 1] : mergeAABB(accumulated, binBounds[split + 1]);
+            count += counts[split + 1];
+            if (leftCount[split] == 0 || count == 0)
+                continue;
+            float cost = leftArea[split] * leftCount[split] + surfaceArea(accumulated) * count;
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = split;
+            }
+        }
+    }
+
+    size_t middle;
+    if (bestAxis < 0)
+    {
+        // Tous les centres sont confondus : coupe au milieu
+        middle = begin + (end - begin) / 2;
+    }
+    else
+    {
+        float axisMin = centroidBounds.min[bestAxis];
+        float axisExtent = centroidBounds.max[bestAxis] - axisMin;
+        auto isLeft = [&](int leaf)
+        {
+            int bin = std::min(BIN_COUNT - 1, (int)((nodes[leaf].box.getCenter()[bestAxis] - axisMin) / axisExtent * BIN_COUNT));
+            return bin <= bestSplit;
+        };
+        middle = std::partition(leaves.begin() + begin, leaves.begin() + end, isLeft) - leaves.begin();
+    }
+
+    int left = buildSAH(leaves, begin, middle);
+    int right = buildSAH(leaves, middle, end);
+    int node = allocateNode();
+    nodes[node].left = left;
+    nodes[node].right = right;
+    nodes[node].box = mergeAABB(nodes[left].box, nodes[right].box);
+    nodes[node].height = 1 + std::max(nodes[left].height, nodes[right].height);
+    nodes[left].parent = node;
+    nodes[right].parent = node;
+    return node;
+}
+
+void AABBTree::clear()
+{
+    nodes.clear();
+    root = NULL_NODE;
+    freeList = NULL_NODE;
+    proxyCount = 0;
+}
+
+void AABBTree::addSubtree(int node, std::vector<void *> &results) const
+{
+    std::vector<int> stack(1, node);
+    while (!stack.empty())
+    {
+        int index = stack.back();
+        stack.pop_back();
+        if (nodes[index].isLeaf())
+        {
+            results.push_back(nodes[index].userData);
+            continue;
+        }
+        stack.push_back(nodes[index].left);
+        stack.push_back(nodes[index].right);
+    }
+}
+
+void AABBTree::queryFrustum(const Frustum &frustum, std::vector<void *> &results) const
+{
+    if (root == NULL_NODE)
+        return;
+
+    std::vector<int> stack(1, root);
+    while (!stack.empty())
+    {
+        int index = stack.back();
+        stack.pop_back();
+        const Node &node = nodes[index];
+
+        // Classement de la boîte : dehors, entièrement dedans, ou à cheval sur au moins un plan
+        glm::vec3 center = node.box.getCenter();
+        glm::vec3 extents = node.box.getExtents();
+        bool outside = false;
+        bool inside = true;
+        for (int p = 0; p < Frustum::PLANE_COUNT && !outside; p++)
+        {
+            const glm::vec4 &plane = frustum.getPlane(p);
+            float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+            float radius = glm::dot(glm::abs(glm::vec3(plane)), extents);
+            if (distance + radius < 0.0f)
+                outside = true;
+            else if (distance - radius < 0.0f)
+                inside = false;
+        }
+        if (outside)
+            continue;
+
+        // Un sous-arbre entièrement dans le frustum est ajouté sans autre test
+        if (inside || node.isLeaf())
+        {
+            addSubtree(index, results);
+            continue;
+        }
+        stack.push_back(node.left);
+        stack.push_back(node.right);
+    }
+}
+
+void AABBTree::querySphere(const glm::vec3 &center, float radius, std::vector<void *> &results) const
+{
+    if (root == NULL_NODE)
+        return;
+
+    float radiusSquared = radius * radius;
+    std::vector<int> stack(1, root);
+    while (!stack.empty())
+    {
+        int index = stack.back();
+        stack.pop_back();
+        const Node &node = nodes[index];
+        if (distanceSquared(node.box, center) > radiusSquared)
+            continue;
+        if (node.isLeaf())
+        {
+            if (distanceSquared(node.tightBox, center) <= radiusSquared)
+                results.push_back(node.userData);
+            continue;
+        }
+        stack.push_back(node.left);
+        stack.push_back(node.right);
+    }
+}
+
+bool AABBTree::overlapsSphere(const glm::vec3 &center, float radius) const
+{
+    if (root == NULL_NODE)
+        return false;
+
+    float radiusSquared = radius * radius;
+    std::vector<int> stack(1, root);
+    while (!stack.empty())
+    {
+        int index = stack.back();
+        stack.pop_back();
+        const Node &node = nodes[index];
+        if (distanceSquared(node.box, center) > radiusSquared)
+            continue;
+        if (node.isLeaf())
+        {
+            if (distanceSquared(node.tightBox, center) <= radiusSquared)
+                return true;
+            continue;
+        }
+        stack.push_back(node.left);
+        stack.push_back(node.right);
+    }
+    return false;
+}
+
+// Distance d'entrée du rayon dans la boîte (méthode des "slabs"), ou -1 si le rayon la manque
+static float rayBoxDistance(const AABB &box, const glm::vec3 &origin, const glm::vec3 &inverseDirection, float maxDistance)
+{
+    glm::vec3 t1 = (box.min - origin) * inverseDirection;
+    glm::vec3 t2 = (box.max - origin) * inverseDirection;
+    glm::vec3 tNear = glm::min(t1, t2);
+    glm::vec3 tFar = glm::max(t1, t2);
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+    return enter <= exit ? enter : -1.0f;
+}
+
+void *AABBTree::raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, float *hitDistance) const
+{
+    if (root == NULL_NODE)
+        return nullptr;
+
+    // Les divisions par 0 donnent +/-inf, ce que le test des slabs gère correctement
+    glm::vec3 inverseDirection = 1.0f / direction;
+    float bestDistance = maxDistance;
+    void *bestHit = nullptr;
+
+    std::vector<int> stack(1, root);
+    while (!stack.empty())
+    {
+        int index = stack.back();
+        stack.pop_back();
+        const Node &node = nodes[index];
+        float distance = rayBoxDistance(node.box, origin, inverseDirection, bestDistance);
+        if (distance < 0.0f)
+            continue;
+        if (node.isLeaf())
+        {
+            // La boîte élargie ne sert qu'à écarter des branches : le point d'impact est sur la boîte exacte
+            distance = rayBoxDistance(node.tightBox, origin, inverseDirection, bestDistance);
+            if (distance >= 0.0f)
+            {
+                bestDistance = distance;
+                bestHit = node.userData;
+            }
+            continue;
+        }
+        stack.push_back(node.left);
+        stack.push_back(node.right);
+    }
+
+    if (bestHit && hitDistance)
+        *hitDistance = bestDistance;
+    return bestHit;
+}
+
+void AABBTree::queryNearest(const glm::vec3 &point, size_t k, std::vector<void *> &results) const
+{
+    if (root == NULL_NODE || k == 0)
+        return;
+
+    // Parcours "meilleur d'abord" : les noeuds sont sortis dans l'ordre de leur distance au point,
+    // donc les feuilles aussi, et on peut s'arrêter dès qu'on en a k
+    using Entry = std::pair<float, int>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    // Les feuilles sont classées selon leur boîte exacte, les noeuds internes selon leur boîte élargie : celle-ci contient
+    // les boîtes exactes de tout le sous-arbre, l'ordre de sortie des feuilles reste donc celui de leur distance exacte
+    auto nodeDistance = [this, &point](int index)
+    {
+        const Node &node = nodes[index];
+        return distanceSquared(node.isLeaf() ? node.tightBox : node.box, point);
+    };
+    queue.push(Entry(nodeDistance(root), root));
+    size_t found = 0;
+    while (!queue.empty() && found < k)
+    {
+        int index = queue.top().second;
+        queue.pop();
+        const Node &node = nodes[index];
+        if (node.isLeaf())
+        {
+            results.push_back(node.userData);
+            found++;
+            continue;
+        }
+        queue.push(Entry(nodeDistance(node.left), node.left));
+        queue.push(Entry(nodeDistance(node.right), node.right));
+    }
+}
@@ -0,0 +1,277 @@
+#include "assetCache.hpp"
+#include "glState.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#include "stb_image.h"
+
+std::unordered_map<std::string, std::weak_ptr<Model>> AssetCache::models;
+std::unordered_map<std::string, std::weak_ptr<TextureAsset>> AssetCache::textures;
+std::unordered_map<std::string, std::weak_ptr<Shader>> AssetCache::shaders;
+std::mutex AssetCache::modelsMutex, AssetCache::texturesMutex, AssetCache::shadersMutex;
+std::weak_ptr<TextureAsset> AssetCache::blackTexture;
+std::map<MaterialKey, std::weak_ptr<MaterialAsset>> AssetCache::materials;
+std::vector<unsigned int> AssetCache::freeMaterialIds;
+unsigned int AssetCache::nextMaterialId = 0;
+std::mutex AssetCache::materialsMutex;
+JobSystem *AssetCache::jobs = nullptr;
+MainThreadQueue *AssetCache::uploads = nullptr;
+
+void AssetCache::enableAsyncLoading(JobSystem &jobSystem, MainThreadQueue &uploadQueue)
+{
+    jobs = &jobSystem;
+    uploads = &uploadQueue;
+}
+
+void AssetCache::disableAsyncLoading()
+{
+    jobs = nullptr;
+    uploads = nullptr;
+}
+
+std::string AssetCache::canonicalPath(const std::string &path)
+{
+    std::error_code error;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+    if (error)
+        canonical = std::filesystem::absolute(path, error).lexically_normal();
+    return canonical.generic_string();
+}
+
+std::shared_ptr<Model> AssetCache::loadModel(const std::string &path, bool flipTextureVertically)
+{
+    // L'inversion des textures fait partie de la clé : un même fichier peut être chargé dans les deux sens
+    std::lock_guard<std::mutex> lock(modelsMutex);
+    std::weak_ptr<Model> &cached = models[canonicalPath(path) + (flipTextureVertically ? "|1" : "|0")];
+    std::shared_ptr<Model> model = cached.lock();
+    if (model)
+        return model;
+
+    if (!jobs)
+    {
+        model = std::make_shared<Model>(path, flipTextureVertically);
+        cached = model;
+        return model;
+    }
+
+    // Chargement asynchrone : lecture (Assimp ou fichier précompilé) sur un thread de travail, puis un mesh par tâche sur le thread OpenGL.
+    // Les jobs ne gardent que des weak_ptr : le modèle est toujours détruit sur le thread OpenGL.
+    model = std::make_shared<Model>();
+    cached = model;
+    std::weak_ptr<Model> weakModel = model;
+    MainThreadQueue *uploadQueue = uploads;
+    jobs->submit([path, flipTextureVertically, weakModel, uploadQueue]
+                 {
+                     if (weakModel.expired())
+                         return;
+                     std::shared_ptr<ModelData> data = std::make_shared<ModelData>();
+                     Model::readModelData(path, flipTextureVertically, *data);
+                     // Les données (et leurs textures) sont déplacées dans la tâche pour être libérées sur le thread OpenGL
+                     uploadQueue->push([weakModel, uploadQueue, data = std::move(data)]
+                                       {
+                                           if (weakModel.expired())
+                                               return;
+                                           for (size_t i = 0; i < data->meshes.size(); i++)
+                                           {
+                                               uploadQueue->push([weakModel, data, i]
+                                                                 {
+                                                                     if (std::shared_ptr<Model> model = weakModel.lock())
+                                                                         model->uploadMesh(data->meshes[i]);
+                                                                 });
+                                           }
+                                           uploadQueue->push([weakModel, data]
+                                                             {
+                                                                 if (std::shared_ptr<Model> model = weakModel.lock())
+                                                                 {
+                                                                     model->setOccluder(std::move(data->occluder));
+                                                                     model->finishUpload();
+                                                                 }
+                                                             });
+                                       });
+                 });
+    return model;
+}
+
+// Image décodée par stb_image, en attente d'envoi au GPU
+struct DecodedImage
+{
+    unsigned char *pixels = nullptr;
+    int width = 0, height = 0, nrComponents = 0;
+
+    DecodedImage() = default;
+    DecodedImage(const DecodedImage &) = delete;
+    DecodedImage &operator=(const DecodedImage &) = delete;
+    ~DecodedImage() { stbi_image_free(pixels); }
+};
+
+// Décode l'image (sans OpenGL : appelé sur les threads de travail en mode asynchrone)
+static void decodeImage(const std::string &path, bool flipVertically, DecodedImage &image)
+{
+    // L'inversion est un réglage par thread : plusieurs images peuvent être décodées en même temps
+    stbi_set_flip_vertically_on_load_thread(flipVertically);
+    image.pixels = stbi_load(path.c_str(), &image.width, &image.height, &image.nrComponents, 0);
+    if (!image.pixels)
+        std::cout << "Texture failed to load at path: " << path << std::endl;
+}
+
+// Envoie l'image au GPU à travers un pixel buffer object, puis génère les mipmaps
+static void uploadImage(TextureAsset &texture, const DecodedImage &image)
+{
+    glGenTextures(1, &texture.id);
+    if (image.pixels)
+    {
+        GLenum format;
+        if (image.nrComponents == 1)
+            format = GL_RED;
+        else if (image.nrComponents == 2)
+            format = GL_RG;
+        else if (image.nrComponents == 3)
+            format = GL_RGB;
+        else
+            format = GL_RGBA;
+        size_t size = (size_t)image.width * image.height * image.nrComponents;
+
+        // Les pixels sont copiés dans un PBO fraîchement alloué : le driver les transfère ensuite vers la texture sans bloquer
+        unsigned int pbo;
+        glGenBuffers(1, &pbo);
+        GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+        void *mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        const void *pixels = (void *)0; // offset dans le PBO
+        if (mapped)
+        {
+            std::memcpy(mapped, image.pixels, size);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+        else
+        {
+            // Le PBO n'a pas pu être projeté : envoi direct depuis la mémoire du CPU
+            GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            pixels = image.pixels;
+        }
+
+        // Les lignes d'une image RGB ne sont pas forcément alignées sur 4 octets
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        GLState::bindTexture(0, GL_TEXTURE_2D, texture.id);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, pixels);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        GLState::deleteBuffers(1, &pbo);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+    texture.ready = true;
+}
+
+std::shared_ptr<TextureAsset> AssetCache::loadTexture(const std::string &path, bool flipVertically)
+{
+    std::lock_guard<std::mutex> lock(texturesMutex);
+    std::weak_ptr<TextureAsset> &cached = textures[canonicalPath(path) + (flipVertically ? "|1" : "|0")];
+    std::shared_ptr<TextureAsset> texture = cached.lock();
+    if (texture)
+        return texture;
+
+    texture = std::make_shared<TextureAsset>();
+    cached = texture;
+    if (!jobs)
+    {
+        DecodedImage image;
+        decodeImage(path, flipVertically, image);
+        uploadImage(*texture, image);
+        return texture;
+    }
+
+    // Chargement asynchrone : décodage sur un thread de travail, envoi au GPU sur le thread OpenGL
+    std::weak_ptr<TextureAsset> weakTexture = texture;
+    MainThreadQueue *uploadQueue = uploads;
+    jobs->submit([path, flipVertically, weakTexture, uploadQueue]
+                 {
+                     if (weakTexture.expired())
+                         return;
+                     std::shared_ptr<DecodedImage> image = std::make_shared<DecodedImage>();
+                     decodeImage(path, flipVertically, *image);
+                     uploadQueue->push([weakTexture, image = std::move(image)]
+                                       {
+                                           if (std::shared_ptr<TextureAsset> texture = weakTexture.lock())
+                                               uploadImage(*texture, *image);
+                                       });
+                 });
+    return texture;
+}
+
+std::shared_ptr<TextureAsset> AssetCache::getBlackTexture()
+{
+    std::shared_ptr<TextureAsset> texture = blackTexture.lock();
+    if (texture)
+        return texture;
+
+    texture = std::make_shared<TextureAsset>();
+    const unsigned char pixel[4] = {0, 0, 0, 255};
+    glGenTextures(1, &texture->id);
+    GLState::bindTexture(0, GL_TEXTURE_2D, texture->id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    GLState::bindTexture(0, GL_TEXTURE_2D, 0);
+    texture->ready = true;
+    blackTexture = texture;
+    return texture;
+}
+
+std::shared_ptr<MaterialAsset> AssetCache::getMaterial(const MaterialKey &key)
+{
+    std::lock_guard<std::mutex> lock(materialsMutex);
+    std::weak_ptr<MaterialAsset> &cached = materials[key];
+    std::shared_ptr<MaterialAsset> material = cached.lock();
+    if (material)
+        return material;
+
+    material = std::shared_ptr<MaterialAsset>(new MaterialAsset(), releaseMaterial);
+    material->key = key;
+    if (freeMaterialIds.empty())
+        material->id = nextMaterialId++;
+    else
+    {
+        material->id = freeMaterialIds.back();
+        freeMaterialIds.pop_back();
+    }
+    cached = material;
+    return material;
+}
+
+void AssetCache::releaseMaterial(MaterialAsset *material)
+{
+    {
+        std::lock_guard<std::mutex> lock(materialsMutex);
+        // L'entrée a pu être remplacée entre-temps par un nouveau matériau pour les mêmes textures
+        auto found = materials.find(material->key);
+        if (found != materials.end() && found->second.expired())
+            materials.erase(found);
+        freeMaterialIds.push_back(material->id);
+    }
+    delete material;
+}
+
+std::shared_ptr<Shader> AssetCache::loadShader(const std::string &vertexPath, const std::string &fragmentPath)
+{
+    std::lock_guard<std::mutex> lock(shadersMutex);
+    std::weak_ptr<Shader> &cached = shaders[canonicalPath(vertexPath) + '|' + canonicalPath(fragmentPath)];
+    std::shared_ptr<Shader> shader = cached.lock();
+    if (!shader)
+    {
+        // Le programme est supprimé avec le dernier handle
+        shader = std::shared_ptr<Shader>(new Shader(vertexPath.c_str(), fragmentPath.c_str()), [](Shader *program)
+                                         {
+                                             program->deleteProgram();
+                                             delete program;
+                                         });
+        cached = shader;
+    }
+    return shader;
+}
@@ -0,0 +1,116 @@
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+// Version du format du fichier de résultats (à changer si les champs changent de sens)
+static const int BENCHMARK_FORMAT_VERSION = 1;
+
+void BenchmarkReport::setConfiguration(const std::string &name, const std::string &value)
+{
+    for (auto &entry : configuration)
+    {
+        if (entry.first == name)
+        {
+            entry.second = value;
+            return;
+        }
+    }
+    configuration.push_back({name, value});
+}
+
+void BenchmarkReport::addLoadTime(const std::string &name, double milliseconds)
+{
+    loadTimes.push_back({name, milliseconds});
+}
+
+void BenchmarkReport::addFrame(double milliseconds, const RenderStats &stats, size_t glCalls)
+{
+    frameTimes.push_back(milliseconds);
+    drawCalls += stats.drawCalls;
+    triangles += stats.triangles;
+    visibleObjects += stats.visibleObjects;
+    programSwitches += stats.programSwitches;
+    this->glCalls += glCalls;
+}
+
+double BenchmarkReport::percentile(const std::vector<double> &sorted, double percent) const
+{
+    if (sorted.empty())
+        return 0.0;
+    // Rang le plus proche : le résultat est toujours une durée mesurée
+    size_t rank = (size_t)(percent / 100.0 * sorted.size());
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+void BenchmarkReport::print() const
+{
+    std::vector<double> sorted = frameTimes;
+    std::sort(sorted.begin(), sorted.end());
+    std::cout << "Benchmark : " << sorted.size() << " frames, p50 " << percentile(sorted, 50.0) << " ms, p95 "
+              << percentile(sorted, 95.0) << " ms, p99 " << percentile(sorted, 99.0) << " ms, max "
+              << (sorted.empty() ? 0.0 : sorted.back()) << " ms" << std::endl;
+    for (const auto &loadTime : loadTimes)
+        std::cout << "  chargement " << loadTime.first << " : " << loadTime.second << " ms" << std::endl;
+}
+
+// Échappe une chaîne pour le JSON (chemins Windows, noms de driver)
+static std::string jsonString(const std::string &text)
+{
+    std::string result = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        result += c;
+    }
+    return result + "\"";
+}
+
+bool BenchmarkReport::writeJson(const std::string &path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cout << "ERROR::BENCHMARK::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+
+    std::vector<double> sorted = frameTimes;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (double frameTime : sorted)
+        total += frameTime;
+    double frameCount = sorted.empty() ? 1.0 : (double)sorted.size();
+
+    file << std::fixed << std::setprecision(4);
+    file << "{\n  \"version\": " << BENCHMARK_FORMAT_VERSION << ",\n";
+    file << "  \"configuration\": {";
+    for (size_t i = 0; i < configuration.size(); i++)
+        file << (i == 0 ? "\n" : ",\n") << "    " << jsonString(configuration[i].first) << ": " << jsonString(configuration[i].second);
+    file << "\n  },\n";
+    file << "  \"loadTimesMs\": {";
+    for (size_t i = 0; i < loadTimes.size(); i++)
+        file << (i == 0 ? "\n" : ",\n") << "    " << jsonString(loadTimes[i].first) << ": " << loadTimes[i].second;
+    file << "\n  },\n";
+    file << "  \"frames\": " << sorted.size() << ",\n";
+    file << "  \"frameTimeMs\": {\n";
+    file << "    \"min\": " << (sorted.empty() ? 0.0 : sorted.front()) << ",\n";
+    file << "    \"mean\": " << total / frameCount << ",\n";
+    file << "    \"p50\": " << percentile(sorted, 50.0) << ",\n";
+    file << "    \"p90\": " << percentile(sorted, 90.0) << ",\n";
+    file << "    \"p95\": " << percentile(sorted, 95.0) << ",\n";
+    file << "    \"p99\": " << percentile(sorted, 99.0) << ",\n";
+    file << "    \"max\": " << (sorted.empty() ? 0.0 : sorted.back()) << "\n";
+    file << "  },\n";
+    file << "  \"averagePerFrame\": {\n";
+    file << "    \"drawCalls\": " << drawCalls / frameCount << ",\n";
+    file << "    \"triangles\": " << triangles / frameCount << ",\n";
+    file << "    \"visibleObjects\": " << visibleObjects / frameCount << ",\n";
+    file << "    \"programSwitches\": " << programSwitches / frameCount << ",\n";
+    file << "    \"glCalls\": " << glCalls / frameCount << "\n";
+    file << "  }\n}\n";
+    return (bool)file;
+}
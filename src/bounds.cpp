@@ -0,0 +1,66 @@
+#include "bounds.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Lit la i-ème position (les positions ne sont pas forcément alignées dans le tableau)
+static glm::vec3 readPosition(const void *positions, size_t index, size_t stride)
+{
+    glm::vec3 position;
+    std::memcpy(&position, static_cast<const unsigned char *>(positions) + index * stride, sizeof(glm::vec3));
+    return position;
+}
+
+AABB computeAABB(const void *positions, size_t count, size_t stride)
+{
+    AABB box;
+    if (count == 0)
+        return box;
+
+    box.min = box.max = readPosition(positions, 0, stride);
+    for (size_t i = 1; i < count; i++)
+    {
+        glm::vec3 position = readPosition(positions, i, stride);
+        box.min = glm::min(box.min, position);
+        box.max = glm::max(box.max, position);
+    }
+    return box;
+}
+
+BoundingSphere computeBoundingSphere(const void *positions, size_t count, size_t stride, const AABB &box)
+{
+    BoundingSphere sphere;
+    sphere.center = box.getCenter();
+    float radiusSquared = 0.0f;
+    for (size_t i = 0; i < count; i++)
+    {
+        glm::vec3 offset = readPosition(positions, i, stride) - sphere.center;
+        radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+    }
+    sphere.radius = std::sqrt(radiusSquared);
+    return sphere;
+}
+
+AABB mergeAABB(const AABB &a, const AABB &b)
+{
+    AABB box;
+    box.min = glm::min(a.min, b.min);
+    box.max = glm::max(a.max, b.max);
+    return box;
+}
+
+AABB transformAABB(const glm::mat4 &matrix, const AABB &box)
+{
+    // Le centre est transformé normalement, les demi-côtés par la valeur absolue de la partie 3x3 de la matrice
+    glm::vec3 center = glm::vec3(matrix * glm::vec4(box.getCenter(), 1.0f));
+    glm::vec3 extents = box.getExtents();
+    glm::vec3 worldExtents = glm::abs(glm::vec3(matrix[0])) * extents.x +
+                             glm::abs(glm::vec3(matrix[1])) * extents.y +
+                             glm::abs(glm::vec3(matrix[2])) * extents.z;
+
+    AABB result;
+    result.min = center - worldExtents;
+    result.max = center + worldExtents;
+    return result;
+}
@@ -26,6 +26,26 @@ glm::mat4 Camera::getViewMatrix()
     return glm::lookAt(_position, _position + _front, _up);
 }
 
+// Renvoie les plans du frustum de la caméra (extraits de projection * vue)
+Frustum Camera::getFrustum(const glm::mat4 &projection)
+{
+    return Frustum(projection * getViewMatrix());
+}
+
+// Place la caméra en position, regard tourné vers target : les angles d'Euler sont déduits de la direction
+void Camera::setPose(const glm::vec3 &position, const glm::vec3 &target)
+{
+    _position = position;
+    glm::vec3 direction = target - position;
+    if (glm::length(direction) < 1e-6f)
+        return;
+    direction = glm::normalize(direction);
+    _pitch = glm::degrees(asin(glm::clamp(direction.y, -1.0f, 1.0f)));
+    _pitch = glm::clamp(_pitch, -89.0f, 89.0f);
+    _yaw = glm::degrees(atan2(direction.z, direction.x));
+    updateCameraVectors();
+}
+
 // Traite l'entrée reçue de tout système d'entrée de type clavier. Accepte le paramètre d'entrée sous la forme d'une énumération définie par la caméra (pour l'abstraire des systèmes de fenêtrage)
 void Camera::processKeyboard(CameraMovement direction, float deltaTime)
 {
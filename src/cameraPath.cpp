@@ -0,0 +1,69 @@
+#include "cameraPath.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+bool CameraPath::load(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+
+    keys.clear();
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream iss(line);
+        Key key;
+        if (iss >> key.position.x >> key.position.y >> key.position.z >> key.target.x >> key.target.y >> key.target.z)
+            keys.push_back(key);
+    }
+    if (keys.empty())
+        std::cout << "ERROR::CAMERA_PATH::NO_KEY " << path << std::endl;
+    return !keys.empty();
+}
+
+void CameraPath::addKey(const glm::vec3 &position, const glm::vec3 &target)
+{
+    keys.push_back({position, target});
+}
+
+void CameraPath::makeOrbit(const glm::vec3 &center, float radius, float height, int keyCount)
+{
+    keys.clear();
+    for (int i = 0; i < keyCount; i++)
+    {
+        float angle = 2.0f * glm::pi<float>() * i / keyCount;
+        addKey(center + glm::vec3(radius * std::cos(angle), height, radius * std::sin(angle)), center);
+    }
+}
+
+// Catmull-Rom uniforme entre p1 et p2 (la courbe passe par les points de passage)
+static glm::vec3 catmullRom(const glm::vec3 &p0, const glm::vec3 &p1, const glm::vec3 &p2, const glm::vec3 &p3, float t)
+{
+    float t2 = t * t;
+    float t3 = t2 * t;
+    return 0.5f * (2.0f * p1 + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 + (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+}
+
+void CameraPath::sample(float t, glm::vec3 &position, glm::vec3 &target) const
+{
+    if (keys.empty())
+        return;
+    size_t count = keys.size();
+    float scaled = (t - std::floor(t)) * count;
+    size_t segment = std::min((size_t)scaled, count - 1);
+    float local = scaled - segment;
+
+    const Key &k0 = keys[(segment + count - 1) % count];
+    const Key &k1 = keys[segment];
+    const Key &k2 = keys[(segment + 1) % count];
+    const Key &k3 = keys[(segment + 2) % count];
+    position = catmullRom(k0.position, k1.position, k2.position, k3.position, local);
+    target = catmullRom(k0.target, k1.target, k2.target, k3.target, local);
+}
@@ -0,0 +1,186 @@
+#include "clusterGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+ClusterGrid::ClusterGrid(int tilesX, int tilesY, int slicesZ) : tilesX(tilesX), tilesY(tilesY), slicesZ(slicesZ)
+{
+    int clusterCount = tilesX * tilesY * slicesZ;
+    bounds.resize(clusterCount);
+    clusterPointLights.resize(clusterCount);
+    clusterSpotLights.resize(clusterCount);
+    clusters.resize(clusterCount);
+    sliceDepths.resize(slicesZ + 1);
+}
+
+// Calcule les boîtes englobantes (espace vue) des clusters. Ne fait rien si la projection n'a pas changé.
+void ClusterGrid::setProjection(float fovY, float aspect, float nearPlane, float farPlane)
+{
+    if (fovY == this->fovY && aspect == this->aspect && nearPlane == this->nearPlane && farPlane == this->farPlane)
+        return;
+
+    this->fovY = fovY;
+    this->aspect = aspect;
+    this->nearPlane = nearPlane;
+    this->farPlane = farPlane;
+    tanHalfFovY = std::tan(fovY * 0.5f);
+    tanHalfFovX = tanHalfFovY * aspect;
+
+    // Tranches exponentielles : chaque tranche a à peu près la même "épaisseur" à l'écran
+    float logRatio = std::log(farPlane / nearPlane);
+    sliceScale = slicesZ / logRatio;
+    sliceBias = -slicesZ * std::log(nearPlane) / logRatio;
+    for (int z = 0; z <= slicesZ; z++)
+        sliceDepths[z] = nearPlane * std::pow(farPlane / nearPlane, (float)z / slicesZ);
+
+    for (int z = 0; z < slicesZ; z++)
+    {
+        float depthNear = sliceDepths[z];
+        float depthFar = sliceDepths[z + 1];
+        for (int y = 0; y < tilesY; y++)
+        {
+            float ndcY0 = -1.0f + 2.0f * y / tilesY;
+            float ndcY1 = -1.0f + 2.0f * (y + 1) / tilesY;
+            for (int x = 0; x < tilesX; x++)
+            {
+                float ndcX0 = -1.0f + 2.0f * x / tilesX;
+                float ndcX1 = -1.0f + 2.0f * (x + 1) / tilesX;
+
+                // Les coins de la tuile aux profondeurs de début et de fin de la tranche
+                float xs[4] = {ndcX0 * depthNear * tanHalfFovX, ndcX1 * depthNear * tanHalfFovX,
+                               ndcX0 * depthFar * tanHalfFovX, ndcX1 * depthFar * tanHalfFovX};
+                float ys[4] = {ndcY0 * depthNear * tanHalfFovY, ndcY1 * depthNear * tanHalfFovY,
+                               ndcY0 * depthFar * tanHalfFovY, ndcY1 * depthFar * tanHalfFovY};
+
+                ClusterBounds &cluster = bounds[getClusterIndex(x, y, z)];
+                cluster.min = glm::vec3(*std::min_element(xs, xs + 4), *std::min_element(ys, ys + 4), -depthFar);
+                cluster.max = glm::vec3(*std::max_element(xs, xs + 4), *std::max_element(ys, ys + 4), -depthNear);
+            }
+        }
+    }
+}
+
+// Renvoie la tranche contenant la profondeur viewDepth (positive, en espace vue)
+int ClusterGrid::getSlice(float viewDepth) const
+{
+    if (viewDepth <= nearPlane)
+        return 0;
+    int slice = (int)std::floor(std::log(viewDepth) * sliceScale + sliceBias);
+    return std::min(std::max(slice, 0), slicesZ - 1);
+}
+
+// Passe les lumières en espace vue et calcule la plage de tranches que chacune touche
+void ClusterGrid::transformLights(const glm::mat4 &view, const std::vector<LightVolume> &lights, std::vector<ViewLight> &viewLights) const
+{
+    viewLights.resize(lights.size());
+    for (size_t i = 0; i < lights.size(); i++)
+    {
+        ViewLight &viewLight = viewLights[i];
+        viewLight.position = glm::vec3(view * glm::vec4(lights[i].position, 1.0f));
+        viewLight.radius = lights[i].radius;
+
+        float depth = -viewLight.position.z;
+        float depthMin = depth - viewLight.radius;
+        float depthMax = depth + viewLight.radius;
+        if (viewLight.radius <= 0.0f || depthMax < nearPlane || depthMin > farPlane)
+        {
+            // Lumière désactivée ou hors du frustum en profondeur : plage vide
+            viewLight.firstSlice = 1;
+            viewLight.lastSlice = 0;
+            continue;
+        }
+        viewLight.firstSlice = getSlice(std::max(depthMin, nearPlane));
+        viewLight.lastSlice = getSlice(std::min(depthMax, farPlane));
+    }
+}
+
+// Ajoute la lumière à tous les clusters de la tranche dont la boîte touche sa sphère
+void ClusterGrid::binLightInSlice(const ViewLight &light, uint32_t lightIndex, int slice, std::vector<std::vector<uint32_t>> &clusterLights)
+{
+    // Intervalle de profondeur commun à la sphère et à la tranche
+    float depth = -light.position.z;
+    float depthNear = std::max(sliceDepths[slice], depth - light.radius);
+    float depthFar = std::min(sliceDepths[slice + 1], depth + light.radius);
+    if (depthNear > depthFar)
+        return;
+
+    // Projection conservative de la boîte de la sphère sur l'intervalle : x / d est monotone en d, il suffit des deux extrémités
+    float xMin = light.position.x - light.radius, xMax = light.position.x + light.radius;
+    float yMin = light.position.y - light.radius, yMax = light.position.y + light.radius;
+    float ndcXMin = std::min(xMin / (depthNear * tanHalfFovX), xMin / (depthFar * tanHalfFovX));
+    float ndcXMax = std::max(xMax / (depthNear * tanHalfFovX), xMax / (depthFar * tanHalfFovX));
+    float ndcYMin = std::min(yMin / (depthNear * tanHalfFovY), yMin / (depthFar * tanHalfFovY));
+    float ndcYMax = std::max(yMax / (depthNear * tanHalfFovY), yMax / (depthFar * tanHalfFovY));
+    if (ndcXMax < -1.0f || ndcXMin > 1.0f || ndcYMax < -1.0f || ndcYMin > 1.0f)
+        return;
+
+    int firstX = std::max(0, (int)std::floor((ndcXMin + 1.0f) * 0.5f * tilesX));
+    int lastX = std::min(tilesX - 1, (int)std::floor((ndcXMax + 1.0f) * 0.5f * tilesX));
+    int firstY = std::max(0, (int)std::floor((ndcYMin + 1.0f) * 0.5f * tilesY));
+    int lastY = std::min(tilesY - 1, (int)std::floor((ndcYMax + 1.0f) * 0.5f * tilesY));
+
+    float radiusSquared = light.radius * light.radius;
+    for (int y = firstY; y <= lastY; y++)
+    {
+        for (int x = firstX; x <= lastX; x++)
+        {
+            // Test sphère / boîte exact sur les candidats
+            int clusterIndex = getClusterIndex(x, y, slice);
+            const ClusterBounds &cluster = bounds[clusterIndex];
+            glm::vec3 closest = glm::clamp(light.position, cluster.min, cluster.max);
+            glm::vec3 delta = closest - light.position;
+            if (glm::dot(delta, delta) <= radiusSquared)
+                clusterLights[clusterIndex].push_back(lightIndex);
+        }
+    }
+}
+
+// Remplit les listes de lumières des clusters d'une tranche. Chaque tranche n'est traitée que par un seul thread.
+void ClusterGrid::binSlice(int slice)
+{
+    int firstCluster = getClusterIndex(0, 0, slice);
+    int lastCluster = getClusterIndex(0, 0, slice + 1);
+    for (int i = firstCluster; i < lastCluster; i++)
+    {
+        clusterPointLights[i].clear();
+        clusterSpotLights[i].clear();
+    }
+
+    for (uint32_t i = 0; i < viewPointLights.size(); i++)
+    {
+        if (slice >= viewPointLights[i].firstSlice && slice <= viewPointLights[i].lastSlice)
+            binLightInSlice(viewPointLights[i], i, slice, clusterPointLights);
+    }
+    for (uint32_t i = 0; i < viewSpotLights.size(); i++)
+    {
+        if (slice >= viewSpotLights[i].firstSlice && slice <= viewSpotLights[i].lastSlice)
+            binLightInSlice(viewSpotLights[i], i, slice, clusterSpotLights);
+    }
+}
+
+// Répartit les lumières (sphères en espace monde) dans les clusters, sur threadCount threads
+void ClusterGrid::build(const glm::mat4 &view, const std::vector<LightVolume> &pointLights, const std::vector<LightVolume> &spotLights, unsigned int threadCount)
+{
+    transformLights(view, pointLights, viewPointLights);
+    transformLights(view, spotLights, viewSpotLights);
+
+    // Chaque tranche est une tâche du pool : chaque cluster n'est écrit que par un thread
+    threadCount = std::max(1u, std::min(threadCount, (unsigned int)slicesZ));
+    if (!workerPool || workerPool->getThreadCount() != threadCount)
+        workerPool = std::make_unique<WorkerPool>(threadCount);
+    workerPool->run((unsigned int)slicesZ, [this](unsigned int slice)
+                    { binSlice((int)slice); });
+
+    // Compaction des listes dans un seul tableau d'indices
+    lightIndices.clear();
+    for (size_t i = 0; i < clusters.size(); i++)
+    {
+        ClusterRange &range = clusters[i];
+        range.offset = (uint32_t)lightIndices.size();
+        range.pointCount = (uint32_t)clusterPointLights[i].size();
+        range.spotCount = (uint32_t)clusterSpotLights[i].size();
+        range.padding = 0;
+        lightIndices.insert(lightIndices.end(), clusterPointLights[i].begin(), clusterPointLights[i].end());
+        lightIndices.insert(lightIndices.end(), clusterSpotLights[i].begin(), clusterSpotLights[i].end());
+    }
+}
@@ -0,0 +1,194 @@
+#include "cookedMesh.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+#include "mappedFile.hpp"
+
+bool readCookedSourceInfo(const std::string &sourcePath, CookedSourceInfo &info, bool computeHash)
+{
+    std::error_code error;
+    info.size = (uint64_t)std::filesystem::file_size(sourcePath, error);
+    if (error)
+        return false;
+    info.modifiedTime = (int64_t)std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count();
+    if (error)
+        return false;
+
+    info.hash = 0;
+    if (computeHash)
+    {
+        MappedFile source;
+        if (!source.open(sourcePath))
+            return false;
+        info.hash = fnv1aHash(source.data(), source.size());
+    }
+    return true;
+}
+
+bool isCookedMeshUpToDate(const CookedMeshHeader &header, const std::string &sourcePath)
+{
+    CookedSourceInfo source;
+    if (!readCookedSourceInfo(sourcePath, source, false))
+        return false;
+    if (source.size != header.sourceSize)
+        return false;
+    if (source.modifiedTime == header.sourceModifiedTime)
+        return true;
+
+    // Le fichier a été touché : on ne re-cuisine que si son contenu a vraiment changé
+    return readCookedSourceInfo(sourcePath, source, true) && source.hash == header.sourceHash;
+}
+
+// Arrondit un offset au multiple de alignment (puissance de 2) supérieur
+static uint64_t alignOffset(uint64_t offset, uint64_t alignment = 16)
+{
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+bool writeCookedMesh(const std::string &cookedPath, const CookedSourceInfo &source, const std::vector<MeshData> &meshes,
+                     const OccluderMesh &occluder)
+{
+    CookedMeshHeader header = {};
+    std::memcpy(header.magic, COOKED_MESH_MAGIC, sizeof(header.magic));
+    header.version = COOKED_MESH_VERSION;
+    header.vertexSize = sizeof(PackedVertex);
+    header.meshCount = (uint32_t)meshes.size();
+    header.sourceSize = source.size;
+    header.sourceModifiedTime = source.modifiedTime;
+    header.sourceHash = source.hash;
+    header.positionEncoding = (uint32_t)Mesh::getPositionEncoding();
+    header.occluderVertexCount = (uint32_t)occluder.vertices.size();
+    header.occluderIndexCount = (uint32_t)occluder.indices.size();
+
+    // Table des textures et des chaînes
+    std::vector<CookedTextureEntry> textureEntries;
+    std::string stringTable;
+    for (const MeshData &mesh : meshes)
+    {
+        for (const Texture &texture : mesh.textures)
+        {
+            CookedTextureEntry entry;
+            entry.typeOffset = (uint32_t)stringTable.size();
+            entry.typeLength = (uint32_t)texture.type.size();
+            stringTable += texture.type;
+            entry.pathOffset = (uint32_t)stringTable.size();
+            entry.pathLength = (uint32_t)texture.path.size();
+            stringTable += texture.path;
+            textureEntries.push_back(entry);
+        }
+    }
+    header.textureCount = (uint32_t)textureEntries.size();
+    header.stringTableSize = (uint32_t)stringTable.size();
+
+    // Table des LODs (un mesh sans LODs en a un seul : le mesh complet)
+    std::vector<CookedLodEntry> lodEntries;
+    for (const MeshData &mesh : meshes)
+    {
+        if (mesh.lods.empty())
+            lodEntries.push_back({0, (uint32_t)mesh.indexCount, 0.0f, 0});
+        for (const MeshLod &lod : mesh.lods)
+            lodEntries.push_back({lod.firstIndex, lod.indexCount, lod.error, 0});
+    }
+
+    // Position des sommets, des flux de positions puis des indices de chaque mesh
+    std::vector<CookedMeshEntry> meshEntries(meshes.size());
+    uint64_t offset = sizeof(CookedMeshHeader) + meshEntries.size() * sizeof(CookedMeshEntry) +
+                      textureEntries.size() * sizeof(CookedTextureEntry) + lodEntries.size() * sizeof(CookedLodEntry) + stringTable.size();
+    uint64_t vertexDataOffset = alignOffset(offset);
+    offset = vertexDataOffset;
+    uint32_t firstTexture = 0;
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        CookedMeshEntry &entry = meshEntries[i];
+        entry = {};
+        entry.vertexOffset = offset;
+        entry.vertexCount = (uint32_t)meshes[i].vertexCount;
+        entry.firstTexture = firstTexture;
+        entry.textureCount = (uint32_t)meshes[i].textures.size();
+        for (int axis = 0; axis < 3; axis++)
+        {
+            entry.boundsMin[axis] = meshes[i].bounds.min[axis];
+            entry.boundsMax[axis] = meshes[i].bounds.max[axis];
+            entry.decodeOffset[axis] = meshes[i].positionDecode.offset[axis];
+            entry.decodeScale[axis] = meshes[i].positionDecode.scale[axis];
+        }
+        entry.boundingRadius = meshes[i].boundingSphere.radius;
+        entry.lodCount = meshes[i].lods.empty() ? 1 : (uint32_t)meshes[i].lods.size();
+        firstTexture += entry.textureCount;
+        offset += meshes[i].vertexCount * sizeof(PackedVertex);
+    }
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        meshEntries[i].positionOffset = offset;
+        offset += meshes[i].vertexCount * 4 * sizeof(uint16_t);
+    }
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        // Les indices de chaque mesh commencent sur 4 octets, quelle que soit la taille des indices du mesh précédent
+        offset = alignOffset(offset, sizeof(unsigned int));
+        meshEntries[i].indexOffset = offset;
+        meshEntries[i].indexCount = (uint32_t)meshes[i].indexCount;
+        meshEntries[i].indexSize = (uint32_t)meshes[i].indexSize;
+        offset += meshes[i].indexCount * meshes[i].indexSize;
+    }
+    offset = alignOffset(offset, sizeof(unsigned int));
+    header.occluderVertexOffset = offset;
+    offset += occluder.vertices.size() * sizeof(glm::vec3);
+    header.occluderIndexOffset = offset;
+
+    // On écrit dans un fichier temporaire (propre au thread) renommé à la fin, pour ne jamais laisser un fichier à moitié écrit
+    std::string temporaryPath = cookedPath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            std::cout << "ERROR::COOKED_MESH::CANNOT_WRITE " << temporaryPath << std::endl;
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(meshEntries.data()), meshEntries.size() * sizeof(CookedMeshEntry));
+        file.write(reinterpret_cast<const char *>(textureEntries.data()), textureEntries.size() * sizeof(CookedTextureEntry));
+        file.write(reinterpret_cast<const char *>(lodEntries.data()), lodEntries.size() * sizeof(CookedLodEntry));
+        file.write(stringTable.data(), stringTable.size());
+
+        // Bourrage jusqu'à l'offset aligné suivant (moins de 16 octets)
+        const char padding[16] = {};
+        auto padTo = [&](uint64_t target) { file.write(padding, target - (uint64_t)file.tellp()); };
+
+        padTo(vertexDataOffset);
+        for (const MeshData &mesh : meshes)
+            file.write(reinterpret_cast<const char *>(mesh.packedVertexData), mesh.vertexCount * sizeof(PackedVertex));
+        for (const MeshData &mesh : meshes)
+            file.write(reinterpret_cast<const char *>(mesh.positionData), mesh.vertexCount * 4 * sizeof(uint16_t));
+        for (size_t i = 0; i < meshes.size(); i++)
+        {
+            padTo(meshEntries[i].indexOffset);
+            file.write(reinterpret_cast<const char *>(meshes[i].packedIndexData), meshes[i].indexCount * meshes[i].indexSize);
+        }
+        padTo(header.occluderVertexOffset);
+        file.write(reinterpret_cast<const char *>(occluder.vertices.data()), occluder.vertices.size() * sizeof(glm::vec3));
+        file.write(reinterpret_cast<const char *>(occluder.indices.data()), occluder.indices.size() * sizeof(unsigned int));
+
+        if (!file)
+        {
+            std::cout << "ERROR::COOKED_MESH::CANNOT_WRITE " << temporaryPath << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, cookedPath, error);
+    if (error)
+    {
+        std::cout << "ERROR::COOKED_MESH::CANNOT_RENAME " << cookedPath << std::endl;
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
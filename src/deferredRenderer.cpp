@@ -0,0 +1,211 @@
+#include "deferredRenderer.hpp"
+#include "glState.hpp"
+#include "profiler.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// Crée une texture de rendu du G-buffer et l'attache au framebuffer
+static unsigned int createGBufferTexture(GLint internalFormat, GLenum format, GLenum type, int width, int height, GLenum attachment)
+{
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    GLState::bindTexture(0, GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture, 0);
+    return texture;
+}
+
+// Crée le G-buffer et les shaders, et relie les blocs d'uniforms communs
+void DeferredRenderer::create(int width, int height, const FrameDataBuffer &frameDataBuffer, LightBuffer &lightBuffer, bool shaderVariants)
+{
+    this->width = width;
+    this->height = height;
+    createGBuffer();
+    createSphere();
+    glGenVertexArrays(1, &fullscreenVAO);
+
+    // La passe géométrie n'éclaire pas : ses variantes ne dépendent que des matériaux
+    geometryShaders.create(GBUFFER_VERTEX_SHADER_PATH, GBUFFER_FRAGMENT_SHADER_PATH, [&frameDataBuffer](Shader &shader)
+                           {
+                               frameDataBuffer.bindToShader(shader);
+                               shader.use();
+                               shader.setFloat("material.shininess", MATERIAL_SHININESS); });
+    geometryShaders.setEnabled(shaderVariants);
+    lightingShader = Shader(DEFERRED_LIGHTING_VERTEX_SHADER_PATH, DEFERRED_LIGHTING_FRAGMENT_SHADER_PATH);
+    lightVolumeShader = Shader(LIGHT_VOLUME_VERTEX_SHADER_PATH, LIGHT_VOLUME_FRAGMENT_SHADER_PATH);
+    geometryShaders.prepare();
+
+    frameDataBuffer.bindToShader(lightingShader);
+    frameDataBuffer.bindToShader(lightVolumeShader);
+    lightBuffer.bindToShader(lightingShader);
+    lightBuffer.bindToShader(lightVolumeShader);
+
+    // Les textures du G-buffer occupent les unités 0 à 2 pendant la passe d'éclairage
+    for (Shader *shader : {&lightingShader, &lightVolumeShader})
+    {
+        shader->use();
+        shader->setInt("gPosition", 0);
+        shader->setInt("gNormal", 1);
+        shader->setInt("gAlbedoSpec", 2);
+    }
+    lightVolumeShader.setFloat("volumeScale", LIGHT_VOLUME_SCALE);
+}
+
+// Crée le framebuffer du G-buffer à la taille courante
+void DeferredRenderer::createGBuffer()
+{
+    glGenFramebuffers(1, &gBufferFBO);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, gBufferFBO);
+
+    // Position en espace monde (alpha = présence d'un objet), normale + brillance, albedo + intensité spéculaire
+    gPosition = createGBufferTexture(GL_RGBA16F, GL_RGBA, GL_FLOAT, width, height, GL_COLOR_ATTACHMENT0);
+    gNormal = createGBufferTexture(GL_RGBA16F, GL_RGBA, GL_FLOAT, width, height, GL_COLOR_ATTACHMENT1);
+    gAlbedoSpec = createGBufferTexture(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, width, height, GL_COLOR_ATTACHMENT2);
+    unsigned int attachments[3] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2};
+    glDrawBuffers(3, attachments);
+
+    // Même format de profondeur que le framebuffer par défaut, pour pouvoir la recopier avec glBlitFramebuffer
+    glGenRenderbuffers(1, &depthRBO);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRBO);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::FRAMEBUFFER::GBUFFER_NOT_COMPLETE" << std::endl;
+
+    GLState::bindTexture(0, GL_TEXTURE_2D, 0);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Supprime le framebuffer du G-buffer et ses attachements
+void DeferredRenderer::deleteGBuffer()
+{
+    unsigned int textures[3] = {gPosition, gNormal, gAlbedoSpec};
+    GLState::deleteTextures(3, textures);
+    glDeleteRenderbuffers(1, &depthRBO);
+    GLState::deleteFramebuffers(1, &gBufferFBO);
+}
+
+// Crée une sphère unitaire (faces orientées vers l'extérieur) pour les volumes des PointLights
+void DeferredRenderer::createSphere()
+{
+    std::vector<float> vertices;
+    for (int stack = 0; stack <= LIGHT_VOLUME_STACKS; stack++)
+    {
+        float phi = glm::pi<float>() * stack / LIGHT_VOLUME_STACKS;
+        for (int slice = 0; slice <= LIGHT_VOLUME_SLICES; slice++)
+        {
+            float theta = 2.0f * glm::pi<float>() * slice / LIGHT_VOLUME_SLICES;
+            vertices.push_back(std::sin(phi) * std::cos(theta));
+            vertices.push_back(std::cos(phi));
+            vertices.push_back(std::sin(phi) * std::sin(theta));
+        }
+    }
+
+    std::vector<unsigned int> indices;
+    for (int stack = 0; stack < LIGHT_VOLUME_STACKS; stack++)
+    {
+        for (int slice = 0; slice < LIGHT_VOLUME_SLICES; slice++)
+        {
+            unsigned int current = stack * (LIGHT_VOLUME_SLICES + 1) + slice;
+            unsigned int below = current + LIGHT_VOLUME_SLICES + 1;
+            indices.insert(indices.end(), {current, current + 1, below});
+            indices.insert(indices.end(), {current + 1, below + 1, below});
+        }
+    }
+    sphereIndexCount = (unsigned int)indices.size();
+
+    glGenVertexArrays(1, &sphereVAO);
+    glGenBuffers(1, &sphereVBO);
+    glGenBuffers(1, &sphereEBO);
+    GLState::bindVertexArray(sphereVAO);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, sphereVBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
+    GLState::bindVertexArray(0);
+}
+
+// Passe géométrie : le G-buffer (redimensionné si besoin) devient la cible de rendu, renvoie le shader à utiliser
+ShaderVariants &DeferredRenderer::beginGeometryPass(int width, int height)
+{
+    if (width != this->width || height != this->height)
+    {
+        deleteGBuffer();
+        this->width = width;
+        this->height = height;
+        createGBuffer();
+    }
+
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, gBufferFBO);
+    // Un alpha nul dans gPosition indique qu'aucun objet n'a été dessiné sur le pixel
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    return geometryShaders;
+}
+
+// Passe d'éclairage dans le framebuffer par défaut, puis recopie de la profondeur pour les passes forward suivantes
+void DeferredRenderer::lightingPass(int pointLightCount)
+{
+    PROFILE_GPU_SCOPE("lighting pass");
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    GLState::bindTexture(0, GL_TEXTURE_2D, gPosition);
+    GLState::bindTexture(1, GL_TEXTURE_2D, gNormal);
+    GLState::bindTexture(2, GL_TEXTURE_2D, gAlbedoSpec);
+
+    // Lumière directionnelle et SpotLights : un triangle plein écran, une évaluation par pixel
+    GLState::disable(GL_DEPTH_TEST);
+    lightingShader.use();
+    GLState::bindVertexArray(fullscreenVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    // PointLights : les volumes s'additionnent. On ne garde que les faces arrière pour qu'un pixel ne soit éclairé
+    // qu'une fois par lumière, même quand la caméra est dans le volume, et on désactive le clipping en profondeur
+    // pour que les volumes qui dépassent le far plane restent dessinés.
+    if (pointLightCount > 0)
+    {
+        GLState::enable(GL_BLEND);
+        GLState::blendFunc(GL_ONE, GL_ONE);
+        GLState::enable(GL_CULL_FACE);
+        GLState::cullFace(GL_FRONT);
+        GLState::enable(GL_DEPTH_CLAMP);
+
+        lightVolumeShader.use();
+        lightVolumeShader.setVec2("screenSize", glm::vec2(width, height));
+        GLState::bindVertexArray(sphereVAO);
+        glDrawElementsInstanced(GL_TRIANGLES, sphereIndexCount, GL_UNSIGNED_INT, 0, pointLightCount);
+
+        GLState::disable(GL_DEPTH_CLAMP);
+        GLState::cullFace(GL_BACK);
+        GLState::disable(GL_CULL_FACE);
+        GLState::disable(GL_BLEND);
+    }
+    GLState::enable(GL_DEPTH_TEST);
+
+    // On recopie la profondeur du G-buffer pour que les passes forward (cubes des lumières) soient correctement masquées
+    GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, gBufferFBO);
+    GLState::bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Suppression des ressources OpenGL
+void DeferredRenderer::deleteResources()
+{
+    deleteGBuffer();
+    GLState::deleteVertexArrays(1, &fullscreenVAO);
+    GLState::deleteVertexArrays(1, &sphereVAO);
+    GLState::deleteBuffers(1, &sphereVBO);
+    GLState::deleteBuffers(1, &sphereEBO);
+    geometryShaders.deleteResources();
+    lightingShader.deleteProgram();
+    lightVolumeShader.deleteProgram();
+}
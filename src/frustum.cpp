@@ -0,0 +1,92 @@
+#include "frustum.hpp"
+
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define FRUSTUM_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+Frustum::Frustum(const glm::mat4 &viewProjection)
+{
+    // Méthode de Gribb et Hartmann : chaque plan est une somme ou une différence de la 4e ligne et d'une autre ligne
+    glm::mat4 m = glm::transpose(viewProjection);
+    planes[LEFT_PLANE] = m[3] + m[0];
+    planes[RIGHT_PLANE] = m[3] - m[0];
+    planes[BOTTOM_PLANE] = m[3] + m[1];
+    planes[TOP_PLANE] = m[3] - m[1];
+    planes[NEAR_PLANE] = m[3] + m[2];
+    planes[FAR_PLANE] = m[3] - m[2];
+
+    for (glm::vec4 &plane : planes)
+        plane /= glm::length(glm::vec3(plane));
+}
+
+bool Frustum::intersects(const AABB &box) const
+{
+    glm::vec3 center = box.getCenter();
+    glm::vec3 extents = box.getExtents();
+    for (const glm::vec4 &plane : planes)
+    {
+        // Distance du centre au plan et rayon de la boîte projeté sur la normale
+        float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+        float radius = glm::dot(glm::abs(glm::vec3(plane)), extents);
+        if (distance + radius < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+bool Frustum::intersects(const BoundingSphere &sphere) const
+{
+    for (const glm::vec4 &plane : planes)
+    {
+        if (glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius)
+            return false;
+    }
+    return true;
+}
+
+void Frustum::intersects(const AABB *boxes, size_t count, uint8_t *visible) const
+{
+    size_t i = 0;
+#ifdef FRUSTUM_USE_SSE
+    // 4 boîtes à la fois : centres et demi-côtés rangés par composante (x de 4 boîtes dans un registre, etc.)
+    for (; i + 4 <= count; i += 4)
+    {
+        alignas(16) float cx[4], cy[4], cz[4], ex[4], ey[4], ez[4];
+        for (int b = 0; b < 4; b++)
+        {
+            glm::vec3 center = boxes[i + b].getCenter();
+            glm::vec3 extents = boxes[i + b].getExtents();
+            cx[b] = center.x;
+            cy[b] = center.y;
+            cz[b] = center.z;
+            ex[b] = extents.x;
+            ey[b] = extents.y;
+            ez[b] = extents.z;
+        }
+        __m128 centerX = _mm_load_ps(cx), centerY = _mm_load_ps(cy), centerZ = _mm_load_ps(cz);
+        __m128 extentX = _mm_load_ps(ex), extentY = _mm_load_ps(ey), extentZ = _mm_load_ps(ez);
+
+        __m128 inside = _mm_cmpeq_ps(_mm_setzero_ps(), _mm_setzero_ps()); // tous les bits à 1
+        for (const glm::vec4 &plane : planes)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(plane.x)),
+                                                    _mm_mul_ps(centerY, _mm_set1_ps(plane.y))),
+                                         _mm_add_ps(_mm_mul_ps(centerZ, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+            __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(extentX, _mm_set1_ps(std::fabs(plane.x))),
+                                                  _mm_mul_ps(extentY, _mm_set1_ps(std::fabs(plane.y)))),
+                                       _mm_mul_ps(extentZ, _mm_set1_ps(std::fabs(plane.z))));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        }
+
+        int mask = _mm_movemask_ps(inside);
+        for (int b = 0; b < 4; b++)
+            visible[i + b] = (mask >> b) & 1;
+    }
+#endif
+    // Boîtes restantes (ou toutes, sans SSE)
+    for (; i < count; i++)
+        visible[i] = intersects(boxes[i]) ? 1 : 0;
+}
@@ -1,6 +1,7 @@
 #include "gameObject.hpp"
+#include "scene.hpp"
 
-GameObject::GameObject(string name, string path, bool flipTextureVertically, Shader &shader, glm::mat4 modelMatrix, std::vector<std::unique_ptr<GameObject>>& gameObjects) : shader(shader), graphicModel(path, flipTextureVertically), gameObjects(gameObjects), modelMatrix(modelMatrix)
+GameObject::GameObject(string name, string path, bool flipTextureVertically, Shader &shader, glm::mat4 modelMatrix, Scene &scene) : shader(shader), graphicModel(AssetCache::loadModel(path, flipTextureVertically)), scene(scene), modelMatrix(modelMatrix)
 {
     if (name.empty())
     {
@@ -21,17 +22,8 @@ GameObject::GameObject(string name, string path, bool flipTextureVertically, Sha
 
     while (!nameIsUnique)
     {
-        nameIsUnique = true; // On part du principe que le nom est unique
-
-        // On parcourt tous les GameObjects pour vérifier l'unicité du nom
-        for (const auto &gameObject : gameObjects)
-        {
-            if (gameObject->name == this->name)
-            {
-                nameIsUnique = false; // Le nom n'est pas unique, on doit le modifier
-                break;                // Pas besoin de continuer la vérification
-            }
-        }
+        // La scène indexe ses GameObjects par nom
+        nameIsUnique = scene.find(this->name) == nullptr;
 
         if (!nameIsUnique)
         {
@@ -44,6 +36,42 @@ GameObject::GameObject(string name, string path, bool flipTextureVertically, Sha
 void GameObject::Draw()
 {
     shader.use();
-    glUniformMatrix4fv(glGetUniformLocation(shader.ID, "model"), 1, GL_FALSE, glm::value_ptr(modelMatrix));
-    graphicModel.Draw(shader);
+    Draw(shader);
+}
+
+void GameObject::Draw(Shader &shader)
+{
+    graphicModel->Draw(shader, modelMatrix);
+}
+
+void GameObject::modelMatrixTranslate(glm::vec3 translation)
+{
+    modelMatrix = glm::translate(modelMatrix, translation);
+    scene.onTransformChanged(*this);
+}
+
+void GameObject::modelMatrixRotate(float angle, glm::vec3 axis)
+{
+    modelMatrix = glm::rotate(modelMatrix, angle, axis);
+    scene.onTransformChanged(*this);
+}
+
+void GameObject::modelMatrixScale(glm::vec3 scale)
+{
+    modelMatrix = glm::scale(modelMatrix, scale);
+    scene.onTransformChanged(*this);
+}
+
+void GameObject::updateWorldBounds()
+{
+    if (getLoadState() == LoadState::Loading)
+    {
+        // Boîte du cube de remplacement dessiné pendant le chargement (voir InstancedRenderer::createPlaceholder)
+        AABB placeholderBounds;
+        placeholderBounds.min = glm::vec3(-0.5f);
+        placeholderBounds.max = glm::vec3(0.5f);
+        worldBounds = transformAABB(modelMatrix, placeholderBounds);
+        return;
+    }
+    worldBounds = transformAABB(modelMatrix, graphicModel->getBounds());
 }
\ No newline at end of file
@@ -0,0 +1,356 @@
+#include "geometryPool.hpp"
+#include "mesh.hpp"
+#include "glState.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+void RangeAllocator::reset(size_t capacity)
+{
+    this->capacity = capacity;
+    used = 0;
+    freeBlocks.clear();
+    if (capacity > 0)
+        freeBlocks[0] = capacity;
+}
+
+bool RangeAllocator::allocate(size_t size, size_t &offset)
+{
+    if (size == 0)
+    {
+        offset = 0;
+        return true;
+    }
+    // Premier bloc libre assez grand, dont on garde la fin
+    for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it)
+    {
+        if (it->second < size)
+            continue;
+        offset = it->first;
+        size_t remaining = it->second - size;
+        freeBlocks.erase(it);
+        if (remaining > 0)
+            freeBlocks[offset + size] = remaining;
+        used += size;
+        return true;
+    }
+    return false;
+}
+
+void RangeAllocator::free(size_t offset, size_t size)
+{
+    if (size == 0)
+        return;
+    used -= size;
+    auto it = freeBlocks.emplace(offset, size).first;
+    // Fusion avec le bloc libre suivant puis avec le précédent
+    auto next = std::next(it);
+    if (next != freeBlocks.end() && it->first + it->second == next->first)
+    {
+        it->second += next->second;
+        freeBlocks.erase(next);
+    }
+    if (it != freeBlocks.begin())
+    {
+        auto previous = std::prev(it);
+        if (previous->first + previous->second == it->first)
+        {
+            previous->second += it->second;
+            freeBlocks.erase(it);
+        }
+    }
+}
+
+// Vrai si le contexte fournit le multi-draw indirect avec le champ baseInstance des commandes
+static bool hasMultiDrawIndirect()
+{
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    if (major > 4 || (major == 4 && minor >= 3))
+        return true;
+
+    bool multiDrawIndirect = false, baseInstance = false;
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount; i++)
+    {
+        const char *name = (const char *)glGetStringi(GL_EXTENSIONS, i);
+        if (std::strcmp(name, "GL_ARB_multi_draw_indirect") == 0)
+            multiDrawIndirect = true;
+        else if (std::strcmp(name, "GL_ARB_base_instance") == 0)
+            baseInstance = true;
+    }
+    return multiDrawIndirect && baseInstance;
+}
+
+void GeometryPool::create(size_t vertexCapacity, size_t indexCapacity, bool positionStream, GLADloadproc loader)
+{
+    vertexAllocator.reset(vertexCapacity);
+    indexAllocator.reset(indexCapacity);
+
+    if (hasMultiDrawIndirect())
+        multiDrawElementsIndirect = (MultiDrawElementsIndirectProc)loader("glMultiDrawElementsIndirect");
+    multiDrawIndirectSupported = multiDrawElementsIndirect != nullptr;
+    useMultiDrawIndirect = multiDrawIndirectSupported;
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+    glGenBuffers(1, &instanceVBO);
+    glGenBuffers(1, &indirectBuffer);
+    glGenBuffers(1, &immediateInstanceVBO);
+
+    // Même format de sommets que les meshes qui ont leurs propres buffers (voir Mesh::setupMesh)
+    GLenum positionType = Mesh::getPositionEncoding() == PositionEncoding::Quantized ? GL_UNSIGNED_SHORT : GL_HALF_FLOAT;
+    GLboolean positionNormalized = Mesh::getPositionEncoding() == PositionEncoding::Quantized ? GL_TRUE : GL_FALSE;
+
+    GLState::bindVertexArray(VAO);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertexCapacity * sizeof(PackedVertex), NULL, GL_STATIC_DRAW);
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity * sizeof(uint16_t), NULL, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, positionType, positionNormalized, sizeof(PackedVertex), (void *)offsetof(PackedVertex, position));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, normal));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, texCoords));
+    bindInstances(instanceVBO, 0);
+
+    if (positionStream)
+    {
+        glGenVertexArrays(1, &depthVAO);
+        glGenBuffers(1, &positionVBO);
+        GLState::bindVertexArray(depthVAO);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, positionVBO);
+        glBufferData(GL_ARRAY_BUFFER, vertexCapacity * 4 * sizeof(uint16_t), NULL, GL_STATIC_DRAW);
+        GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, positionType, positionNormalized, 4 * sizeof(uint16_t), (void *)0);
+        bindInstances(instanceVBO, 0);
+    }
+
+    GLState::bindVertexArray(0);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GeometryPool::deleteResources()
+{
+    GLState::deleteVertexArrays(1, &VAO);
+    GLState::deleteBuffers(1, &VBO);
+    GLState::deleteBuffers(1, &EBO);
+    GLState::deleteBuffers(1, &instanceVBO);
+    GLState::deleteBuffers(1, &indirectBuffer);
+    GLState::deleteBuffers(1, &immediateInstanceVBO);
+    if (depthVAO)
+    {
+        GLState::deleteVertexArrays(1, &depthVAO);
+        GLState::deleteBuffers(1, &positionVBO);
+    }
+    VAO = depthVAO = 0;
+}
+
+void GeometryPool::bindInstances(unsigned int buffer, size_t firstInstance)
+{
+    GLState::bindBuffer(GL_ARRAY_BUFFER, buffer);
+    size_t base = firstInstance * sizeof(PoolInstance);
+    // Matrice de modèle (locations 3 à 6) puis décodage des positions (locations 7 et 8), une valeur par instance
+    for (unsigned int column = 0; column < 4; column++)
+    {
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(PoolInstance), (void *)(base + column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(3 + column, 1);
+    }
+    glEnableVertexAttribArray(7);
+    glVertexAttribPointer(7, 3, GL_FLOAT, GL_FALSE, sizeof(PoolInstance), (void *)(base + offsetof(PoolInstance, positionOffset)));
+    glVertexAttribDivisor(7, 1);
+    glEnableVertexAttribArray(8);
+    glVertexAttribPointer(8, 3, GL_FLOAT, GL_FALSE, sizeof(PoolInstance), (void *)(base + offsetof(PoolInstance, positionScale)));
+    glVertexAttribDivisor(8, 1);
+}
+
+bool GeometryPool::allocate(const PackedVertex *vertices, const uint16_t *positions, size_t vertexCount, const uint16_t *indices, size_t indexCount,
+                            GeometryAllocation &allocation)
+{
+    if (!isCreated() || !vertexAllocator.allocate(vertexCount, allocation.firstVertex))
+        return false;
+    if (!indexAllocator.allocate(indexCount, allocation.firstIndex))
+    {
+        vertexAllocator.free(allocation.firstVertex, vertexCount);
+        return false;
+    }
+    allocation.vertexCount = vertexCount;
+    allocation.indexCount = indexCount;
+
+    GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferSubData(GL_ARRAY_BUFFER, allocation.firstVertex * sizeof(PackedVertex), vertexCount * sizeof(PackedVertex), vertices);
+    if (positionVBO)
+    {
+        GLState::bindBuffer(GL_ARRAY_BUFFER, positionVBO);
+        glBufferSubData(GL_ARRAY_BUFFER, allocation.firstVertex * 4 * sizeof(uint16_t), vertexCount * 4 * sizeof(uint16_t), positions);
+    }
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+    // L'EBO est lié au VAO : on ne le lie pas seul pour ne pas modifier le VAO actif
+    GLState::bindVertexArray(0);
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, allocation.firstIndex * sizeof(uint16_t), indexCount * sizeof(uint16_t), indices);
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    return true;
+}
+
+void GeometryPool::free(const GeometryAllocation &allocation)
+{
+    vertexAllocator.free(allocation.firstVertex, allocation.vertexCount);
+    indexAllocator.free(allocation.firstIndex, allocation.indexCount);
+}
+
+void GeometryPool::fillInstances(const Mesh &mesh, const glm::mat4 *modelMatrices, GLsizei instanceCount, std::vector<PoolInstance> &out)
+{
+    const PositionDecode &decode = mesh.getPositionDecode();
+    for (GLsizei i = 0; i < instanceCount; i++)
+        out.push_back({modelMatrices[i], decode.offset, decode.scale});
+}
+
+void GeometryPool::beginFrame()
+{
+    draws.clear();
+    instances.clear();
+}
+
+void GeometryPool::addDraw(const Mesh &mesh, int lod, const glm::mat4 *modelMatrices, GLsizei instanceCount)
+{
+    if (instanceCount <= 0)
+        return;
+    const GeometryAllocation &allocation = mesh.getAllocation();
+    const MeshLod &range = mesh.getLod(lod);
+    DrawElementsIndirectCommand command = {range.indexCount, (GLuint)instanceCount, (GLuint)(allocation.firstIndex + range.firstIndex),
+                                           (GLint)allocation.firstVertex, (GLuint)instances.size()};
+    draws.push_back({&mesh, command});
+    fillInstances(mesh, modelMatrices, instanceCount, instances);
+}
+
+void GeometryPool::upload()
+{
+    // Les draws de même matériau se suivent : une commande multi-draw par matériau,
+    // et les matériaux de même variante de shader se suivent pour changer de programme le moins possible
+    std::stable_sort(draws.begin(), draws.end(), [](const PoolDraw &a, const PoolDraw &b)
+                     {
+                         if (a.mesh->getShaderFeatures() != b.mesh->getShaderFeatures())
+                             return a.mesh->getShaderFeatures() < b.mesh->getShaderFeatures();
+                         return a.mesh->getMaterialId() < b.mesh->getMaterialId(); });
+    commands.clear();
+    groups.clear();
+    for (const PoolDraw &draw : draws)
+    {
+        if (groups.empty() || groups.back().mesh->getMaterialId() != draw.mesh->getMaterialId())
+            groups.push_back({draw.mesh, commands.size(), 0});
+        groups.back().commandCount++;
+        commands.push_back(draw.command);
+    }
+
+    // Nouveau stockage à chaque frame : le GPU peut encore lire celui de la frame précédente
+    GLState::bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(PoolInstance), instances.data(), GL_STREAM_DRAW);
+    if (useMultiDrawIndirect)
+    {
+        GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), GL_STREAM_DRAW);
+        GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+}
+
+size_t GeometryPool::submitGroups(unsigned int vao, ShaderVariants *variants)
+{
+    programSwitches = 0;
+    if (commands.empty())
+        return 0;
+
+    size_t drawCalls = 0;
+    const Shader *currentShader = nullptr;
+    // Active la variante du matériau du groupe et lie ses textures
+    auto bindMaterial = [&](const MaterialGroup &group)
+    {
+        Shader &shader = variants->use(group.mesh->getShaderFeatures());
+        if (&shader != currentShader)
+        {
+            currentShader = &shader;
+            programSwitches++;
+        }
+        group.mesh->bindTextures(shader);
+    };
+    GLState::bindVertexArray(vao);
+    if (useMultiDrawIndirect)
+    {
+        // baseInstance de chaque commande désigne ses instances dans le buffer de la frame
+        bindInstances(instanceVBO, 0);
+        GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        for (const MaterialGroup &group : groups)
+        {
+            if (variants)
+            {
+                bindMaterial(group);
+                variants->addDraws(1);
+            }
+            multiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, (void *)(group.firstCommand * sizeof(DrawElementsIndirectCommand)),
+                                      (GLsizei)group.commandCount, 0);
+            drawCalls++;
+        }
+        GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+    else
+    {
+        // Sans baseInstance, on décale les attributs d'instance avant chaque appel (le VAO reste lié)
+        for (const MaterialGroup &group : groups)
+        {
+            if (variants)
+            {
+                bindMaterial(group);
+                variants->addDraws(group.commandCount);
+            }
+            for (size_t i = group.firstCommand; i < group.firstCommand + group.commandCount; i++)
+            {
+                const DrawElementsIndirectCommand &command = commands[i];
+                bindInstances(instanceVBO, command.baseInstance);
+                glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.count, GL_UNSIGNED_SHORT, (void *)(command.firstIndex * sizeof(uint16_t)),
+                                                  command.instanceCount, command.baseVertex);
+                drawCalls++;
+            }
+        }
+    }
+    return drawCalls;
+}
+
+size_t GeometryPool::submit(ShaderVariants &variants)
+{
+    return submitGroups(VAO, &variants);
+}
+
+size_t GeometryPool::submitDepth()
+{
+    return depthVAO ? submitGroups(depthVAO, nullptr) : 0;
+}
+
+void GeometryPool::drawInstanced(const Mesh &mesh, int lod, const glm::mat4 *modelMatrices, GLsizei instanceCount, bool depthOnly)
+{
+    unsigned int vao = depthOnly ? depthVAO : VAO;
+    if (instanceCount <= 0 || !vao)
+        return;
+
+    immediateInstances.clear();
+    fillInstances(mesh, modelMatrices, instanceCount, immediateInstances);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, immediateInstanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, immediateInstances.size() * sizeof(PoolInstance), immediateInstances.data(), GL_STREAM_DRAW);
+
+    const GeometryAllocation &allocation = mesh.getAllocation();
+    const MeshLod &range = mesh.getLod(lod);
+    GLState::bindVertexArray(vao);
+    bindInstances(immediateInstanceVBO, 0);
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, range.indexCount, GL_UNSIGNED_SHORT,
+                                      (void *)((allocation.firstIndex + range.firstIndex) * sizeof(uint16_t)), instanceCount, (GLint)allocation.firstVertex);
+}
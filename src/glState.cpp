@@ -0,0 +1,442 @@
+#include "glState.hpp"
+
+#include <iostream>
+
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+bool GLState::validation = false;
+GLState::Counters GLState::counters;
+
+// Valeur d'un état inconnu : l'appel suivant est toujours transmis
+static const GLuint UNKNOWN = 0xFFFFFFFFu;
+// Unités de texture suivies (les suivantes sont toujours transmises)
+static const GLuint TRACKED_TEXTURE_UNITS = 16;
+
+namespace
+{
+    // Cibles de buffers suivies et requête glGet de chacune (0 : pas vérifiable en OpenGL 3.3)
+    const GLenum bufferTargets[] = {GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_TEXTURE_BUFFER,
+                                    GL_PIXEL_UNPACK_BUFFER, GL_DRAW_INDIRECT_BUFFER};
+    const GLenum bufferBindings[] = {GL_ARRAY_BUFFER_BINDING, GL_ELEMENT_ARRAY_BUFFER_BINDING, GL_UNIFORM_BUFFER_BINDING, GL_TEXTURE_BUFFER,
+                                     GL_PIXEL_UNPACK_BUFFER_BINDING, 0};
+    const int BUFFER_TARGET_COUNT = sizeof(bufferTargets) / sizeof(bufferTargets[0]);
+    const int ELEMENT_ARRAY_SLOT = 1;
+
+    const GLenum capabilities[] = {GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE, GL_DEPTH_CLAMP};
+    const int CAPABILITY_COUNT = sizeof(capabilities) / sizeof(capabilities[0]);
+
+    // Cibles de textures suivies par unité et requête glGet de chacune
+    const GLenum textureTargets[] = {GL_TEXTURE_2D, GL_TEXTURE_BUFFER};
+    const GLenum textureBindings[] = {GL_TEXTURE_BINDING_2D, GL_TEXTURE_BINDING_BUFFER};
+    const int TEXTURE_TARGET_COUNT = 2;
+
+    // 0 : faux, 1 : vrai, UNKNOWN : inconnu
+    struct Shadow
+    {
+        GLuint program = UNKNOWN;
+        GLuint vertexArray = UNKNOWN;
+        GLuint buffers[BUFFER_TARGET_COUNT];
+        GLuint drawFramebuffer = UNKNOWN;
+        GLuint readFramebuffer = UNKNOWN;
+        GLuint activeUnit = UNKNOWN;
+        GLuint textures[TRACKED_TEXTURE_UNITS][TEXTURE_TARGET_COUNT];
+        GLuint capabilities[CAPABILITY_COUNT];
+        GLuint depthFunc = UNKNOWN;
+        GLuint depthMask = UNKNOWN;
+        GLuint colorMask = UNKNOWN;
+        GLuint blendSource = UNKNOWN;
+        GLuint blendDestination = UNKNOWN;
+        GLuint cullFace = UNKNOWN;
+        GLint viewport[4] = {-1, -1, -1, -1};
+        bool viewportKnown = false;
+
+        Shadow()
+        {
+            for (GLuint &buffer : buffers)
+                buffer = UNKNOWN;
+            for (auto &unit : textures)
+                for (GLuint &texture : unit)
+                    texture = UNKNOWN;
+            for (GLuint &capability : capabilities)
+                capability = UNKNOWN;
+        }
+    };
+    Shadow shadow;
+
+    int findIndex(const GLenum *values, int count, GLenum value)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            if (values[i] == value)
+                return i;
+        }
+        return -1;
+    }
+
+    GLuint getInteger(GLenum name)
+    {
+        GLint value = 0;
+        glGetIntegerv(name, &value);
+        return (GLuint)value;
+    }
+
+    // Compare une valeur de la copie à l'état réel, affiche la différence et corrige la copie
+    bool check(const char *name, GLuint &shadowValue, GLuint realValue)
+    {
+        if (shadowValue == UNKNOWN || shadowValue == realValue)
+        {
+            shadowValue = realValue;
+            return true;
+        }
+        std::cout << "ERROR::GLSTATE::MISMATCH " << name << " : copie " << shadowValue << ", OpenGL " << realValue << std::endl;
+        shadowValue = realValue;
+        return false;
+    }
+
+    bool checkViewport()
+    {
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        bool valid = !shadow.viewportKnown || (viewport[0] == shadow.viewport[0] && viewport[1] == shadow.viewport[1] &&
+                                               viewport[2] == shadow.viewport[2] && viewport[3] == shadow.viewport[3]);
+        if (!valid)
+            std::cout << "ERROR::GLSTATE::MISMATCH viewport" << std::endl;
+        for (int i = 0; i < 4; i++)
+            shadow.viewport[i] = viewport[i];
+        shadow.viewportKnown = true;
+        return valid;
+    }
+}
+
+// Appel écarté : en mode debug, on vérifie que l'état réel est bien celui de la copie
+#define GLSTATE_FILTERED(name, shadowValue, query) \
+    do                                             \
+    {                                              \
+        counters.filtered++;                       \
+        if (validation)                            \
+            check(name, shadowValue, query);       \
+    } while (0)
+
+void GLState::reset()
+{
+    shadow = Shadow();
+    validate();
+}
+
+void GLState::useProgram(GLuint program)
+{
+    if (shadow.program == program)
+    {
+        GLSTATE_FILTERED("program", shadow.program, getInteger(GL_CURRENT_PROGRAM));
+        return;
+    }
+    glUseProgram(program);
+    shadow.program = program;
+    counters.forwarded++;
+}
+
+void GLState::bindVertexArray(GLuint vertexArray)
+{
+    if (shadow.vertexArray == vertexArray)
+    {
+        GLSTATE_FILTERED("vertex array", shadow.vertexArray, getInteger(GL_VERTEX_ARRAY_BINDING));
+        return;
+    }
+    glBindVertexArray(vertexArray);
+    shadow.vertexArray = vertexArray;
+    // L'EBO lié dépend du VAO
+    shadow.buffers[ELEMENT_ARRAY_SLOT] = UNKNOWN;
+    counters.forwarded++;
+}
+
+void GLState::bindBuffer(GLenum target, GLuint buffer)
+{
+    int slot = findIndex(bufferTargets, BUFFER_TARGET_COUNT, target);
+    if (slot >= 0 && shadow.buffers[slot] == buffer)
+    {
+        if (bufferBindings[slot])
+            GLSTATE_FILTERED("buffer", shadow.buffers[slot], getInteger(bufferBindings[slot]));
+        else
+            counters.filtered++;
+        return;
+    }
+    glBindBuffer(target, buffer);
+    if (slot >= 0)
+        shadow.buffers[slot] = buffer;
+    counters.forwarded++;
+}
+
+void GLState::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    // Lie aussi la cible générique
+    glBindBufferBase(target, index, buffer);
+    int slot = findIndex(bufferTargets, BUFFER_TARGET_COUNT, target);
+    if (slot >= 0)
+        shadow.buffers[slot] = buffer;
+    counters.forwarded++;
+}
+
+void GLState::bindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    if ((!draw || shadow.drawFramebuffer == framebuffer) && (!read || shadow.readFramebuffer == framebuffer))
+    {
+        if (draw)
+            GLSTATE_FILTERED("draw framebuffer", shadow.drawFramebuffer, getInteger(GL_DRAW_FRAMEBUFFER_BINDING));
+        else
+            GLSTATE_FILTERED("read framebuffer", shadow.readFramebuffer, getInteger(GL_READ_FRAMEBUFFER_BINDING));
+        return;
+    }
+    glBindFramebuffer(target, framebuffer);
+    if (draw)
+        shadow.drawFramebuffer = framebuffer;
+    if (read)
+        shadow.readFramebuffer = framebuffer;
+    counters.forwarded++;
+}
+
+void GLState::activeTexture(GLuint unit)
+{
+    if (shadow.activeUnit == unit)
+    {
+        GLSTATE_FILTERED("active texture", shadow.activeUnit, getInteger(GL_ACTIVE_TEXTURE) - GL_TEXTURE0);
+        return;
+    }
+    glActiveTexture(GL_TEXTURE0 + unit);
+    shadow.activeUnit = unit;
+    counters.forwarded++;
+}
+
+void GLState::bindTexture(GLuint unit, GLenum target, GLuint texture)
+{
+    int slot = findIndex(textureTargets, TEXTURE_TARGET_COUNT, target);
+    bool tracked = slot >= 0 && unit < TRACKED_TEXTURE_UNITS;
+    if (tracked && shadow.textures[unit][slot] == texture)
+    {
+        counters.filtered++;
+        if (validation)
+        {
+            activeTexture(unit);
+            check("texture", shadow.textures[unit][slot], getInteger(textureBindings[slot]));
+        }
+        return;
+    }
+    activeTexture(unit);
+    glBindTexture(target, texture);
+    if (tracked)
+        shadow.textures[unit][slot] = texture;
+    counters.forwarded++;
+}
+
+void GLState::setEnabled(GLenum capability, bool enabled)
+{
+    int slot = findIndex(capabilities, CAPABILITY_COUNT, capability);
+    if (slot >= 0 && shadow.capabilities[slot] == (GLuint)enabled)
+    {
+        GLSTATE_FILTERED("capability", shadow.capabilities[slot], (GLuint)glIsEnabled(capability));
+        return;
+    }
+    if (enabled)
+        glEnable(capability);
+    else
+        glDisable(capability);
+    if (slot >= 0)
+        shadow.capabilities[slot] = enabled;
+    counters.forwarded++;
+}
+
+void GLState::depthFunc(GLenum function)
+{
+    if (shadow.depthFunc == function)
+    {
+        GLSTATE_FILTERED("depth func", shadow.depthFunc, getInteger(GL_DEPTH_FUNC));
+        return;
+    }
+    glDepthFunc(function);
+    shadow.depthFunc = function;
+    counters.forwarded++;
+}
+
+void GLState::depthMask(bool write)
+{
+    if (shadow.depthMask == (GLuint)write)
+    {
+        GLboolean real = GL_FALSE;
+        glGetBooleanv(GL_DEPTH_WRITEMASK, &real);
+        GLSTATE_FILTERED("depth mask", shadow.depthMask, (GLuint)real);
+        return;
+    }
+    glDepthMask(write ? GL_TRUE : GL_FALSE);
+    shadow.depthMask = write;
+    counters.forwarded++;
+}
+
+void GLState::colorMask(bool write)
+{
+    if (shadow.colorMask == (GLuint)write)
+    {
+        GLboolean real[4] = {GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE};
+        glGetBooleanv(GL_COLOR_WRITEMASK, real);
+        GLSTATE_FILTERED("color mask", shadow.colorMask, (GLuint)(real[0] && real[1] && real[2] && real[3]));
+        return;
+    }
+    GLboolean value = write ? GL_TRUE : GL_FALSE;
+    glColorMask(value, value, value, value);
+    shadow.colorMask = write;
+    counters.forwarded++;
+}
+
+void GLState::blendFunc(GLenum source, GLenum destination)
+{
+    if (shadow.blendSource == source && shadow.blendDestination == destination)
+    {
+        counters.filtered++;
+        if (validation)
+        {
+            check("blend source", shadow.blendSource, getInteger(GL_BLEND_SRC_RGB));
+            check("blend destination", shadow.blendDestination, getInteger(GL_BLEND_DST_RGB));
+        }
+        return;
+    }
+    glBlendFunc(source, destination);
+    shadow.blendSource = source;
+    shadow.blendDestination = destination;
+    counters.forwarded++;
+}
+
+void GLState::cullFace(GLenum face)
+{
+    if (shadow.cullFace == face)
+    {
+        GLSTATE_FILTERED("cull face", shadow.cullFace, getInteger(GL_CULL_FACE_MODE));
+        return;
+    }
+    glCullFace(face);
+    shadow.cullFace = face;
+    counters.forwarded++;
+}
+
+void GLState::viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if (shadow.viewportKnown && shadow.viewport[0] == x && shadow.viewport[1] == y && shadow.viewport[2] == width && shadow.viewport[3] == height)
+    {
+        counters.filtered++;
+        if (validation)
+            checkViewport();
+        return;
+    }
+    glViewport(x, y, width, height);
+    shadow.viewport[0] = x;
+    shadow.viewport[1] = y;
+    shadow.viewport[2] = width;
+    shadow.viewport[3] = height;
+    shadow.viewportKnown = true;
+    counters.forwarded++;
+}
+
+void GLState::deleteProgram(GLuint program)
+{
+    glDeleteProgram(program);
+    // Un programme actif reste utilisé jusqu'au prochain glUseProgram : on oublie seulement sa valeur
+    if (shadow.program == program)
+        shadow.program = UNKNOWN;
+}
+
+void GLState::deleteVertexArrays(GLsizei count, const GLuint *vertexArrays)
+{
+    glDeleteVertexArrays(count, vertexArrays);
+    for (GLsizei i = 0; i < count; i++)
+    {
+        if (vertexArrays[i] != 0 && shadow.vertexArray == vertexArrays[i])
+        {
+            shadow.vertexArray = 0;
+            shadow.buffers[ELEMENT_ARRAY_SLOT] = UNKNOWN;
+        }
+    }
+}
+
+void GLState::deleteBuffers(GLsizei count, const GLuint *buffers)
+{
+    glDeleteBuffers(count, buffers);
+    for (GLsizei i = 0; i < count; i++)
+    {
+        for (GLuint &bound : shadow.buffers)
+        {
+            if (buffers[i] != 0 && bound == buffers[i])
+                bound = 0;
+        }
+    }
+}
+
+void GLState::deleteTextures(GLsizei count, const GLuint *textures)
+{
+    glDeleteTextures(count, textures);
+    for (GLsizei i = 0; i < count; i++)
+    {
+        for (auto &unit : shadow.textures)
+        {
+            for (GLuint &bound : unit)
+            {
+                if (textures[i] != 0 && bound == textures[i])
+                    bound = 0;
+            }
+        }
+    }
+}
+
+void GLState::deleteFramebuffers(GLsizei count, const GLuint *framebuffers)
+{
+    glDeleteFramebuffers(count, framebuffers);
+    for (GLsizei i = 0; i < count; i++)
+    {
+        if (framebuffers[i] == 0)
+            continue;
+        if (shadow.drawFramebuffer == framebuffers[i])
+            shadow.drawFramebuffer = 0;
+        if (shadow.readFramebuffer == framebuffers[i])
+            shadow.readFramebuffer = 0;
+    }
+}
+
+bool GLState::validate()
+{
+    bool valid = true;
+    valid &= check("program", shadow.program, getInteger(GL_CURRENT_PROGRAM));
+    valid &= check("vertex array", shadow.vertexArray, getInteger(GL_VERTEX_ARRAY_BINDING));
+    for (int slot = 0; slot < BUFFER_TARGET_COUNT; slot++)
+    {
+        if (bufferBindings[slot])
+            valid &= check("buffer", shadow.buffers[slot], getInteger(bufferBindings[slot]));
+    }
+    valid &= check("draw framebuffer", shadow.drawFramebuffer, getInteger(GL_DRAW_FRAMEBUFFER_BINDING));
+    valid &= check("read framebuffer", shadow.readFramebuffer, getInteger(GL_READ_FRAMEBUFFER_BINDING));
+
+    // Les textures de chaque unité se lisent en activant l'unité, puis on revient à l'unité active
+    GLuint activeUnit = getInteger(GL_ACTIVE_TEXTURE) - GL_TEXTURE0;
+    valid &= check("active texture", shadow.activeUnit, activeUnit);
+    for (GLuint unit = 0; unit < TRACKED_TEXTURE_UNITS; unit++)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        for (int slot = 0; slot < TEXTURE_TARGET_COUNT; slot++)
+            valid &= check("texture", shadow.textures[unit][slot], getInteger(textureBindings[slot]));
+    }
+    glActiveTexture(GL_TEXTURE0 + activeUnit);
+
+    for (int slot = 0; slot < CAPABILITY_COUNT; slot++)
+        valid &= check("capability", shadow.capabilities[slot], (GLuint)glIsEnabled(capabilities[slot]));
+    valid &= check("depth func", shadow.depthFunc, getInteger(GL_DEPTH_FUNC));
+    GLboolean depthWrite = GL_FALSE;
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depthWrite);
+    valid &= check("depth mask", shadow.depthMask, (GLuint)depthWrite);
+    GLboolean colorWrite[4] = {GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE};
+    glGetBooleanv(GL_COLOR_WRITEMASK, colorWrite);
+    valid &= check("color mask", shadow.colorMask, (GLuint)(colorWrite[0] && colorWrite[1] && colorWrite[2] && colorWrite[3]));
+    valid &= check("blend source", shadow.blendSource, getInteger(GL_BLEND_SRC_RGB));
+    valid &= check("blend destination", shadow.blendDestination, getInteger(GL_BLEND_DST_RGB));
+    valid &= check("cull face", shadow.cullFace, getInteger(GL_CULL_FACE_MODE));
+    valid &= checkViewport();
+    return valid;
+}
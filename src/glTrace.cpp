@@ -0,0 +1,596 @@
+#include "glTrace.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <unordered_map>
+
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT 0x0002
+#endif
+
+bool GLTrace::recording = false;
+int GLTrace::frame = 0;
+int GLTrace::firstFrame = 0;
+int GLTrace::lastFrame = 0;
+
+static std::ofstream traceFile;
+static uint32_t capturedFrames = 0;
+static GLADloadproc traceLoader = nullptr;
+// État nécessaire pour savoir combien d'octets lire derrière les pointeurs
+static GLuint unpackBuffer = 0;
+static GLint unpackAlignment = 4;
+struct MappedRange
+{
+    void *pointer;
+    GLintptr offset;
+    GLsizeiptr length;
+    GLbitfield access;
+};
+static std::unordered_map<GLenum, MappedRange> mappedRanges;
+
+static void record(GLTraceCall call, std::initializer_list<uint32_t> arguments, const void *data = nullptr, size_t size = 0)
+{
+    uint16_t id = call;
+    uint8_t argumentCount = (uint8_t)arguments.size();
+    uint32_t dataSize = (uint32_t)size;
+    traceFile.write(reinterpret_cast<const char *>(&id), sizeof(id));
+    traceFile.write(reinterpret_cast<const char *>(&argumentCount), sizeof(argumentCount));
+    for (uint32_t argument : arguments)
+        traceFile.write(reinterpret_cast<const char *>(&argument), sizeof(argument));
+    traceFile.write(reinterpret_cast<const char *>(&dataSize), sizeof(dataSize));
+    if (size > 0)
+        traceFile.write(reinterpret_cast<const char *>(data), size);
+}
+
+static uint32_t floatBits(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static uint32_t pointerOffset(const void *pointer)
+{
+    return (uint32_t)reinterpret_cast<uintptr_t>(pointer);
+}
+
+// Taille des pixels envoyés par glTexImage2D (lignes alignées sur GL_UNPACK_ALIGNMENT)
+static size_t imageSize(GLsizei width, GLsizei height, GLenum format, GLenum type)
+{
+    size_t components = 4;
+    switch (format)
+    {
+    case GL_RED:
+    case GL_DEPTH_COMPONENT:
+        components = 1;
+        break;
+    case GL_RG:
+        components = 2;
+        break;
+    case GL_RGB:
+    case GL_BGR:
+        components = 3;
+        break;
+    }
+    size_t componentSize = 1;
+    switch (type)
+    {
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:
+    case GL_HALF_FLOAT:
+        componentSize = 2;
+        break;
+    case GL_INT:
+    case GL_UNSIGNED_INT:
+    case GL_FLOAT:
+        componentSize = 4;
+        break;
+    }
+    size_t pixelSize = components * componentSize;
+    if (type == GL_UNSIGNED_INT_24_8)
+        pixelSize = 4;
+    size_t rowSize = width * pixelSize;
+    size_t alignedRowSize = (rowSize + unpackAlignment - 1) / unpackAlignment * unpackAlignment;
+    return height > 0 ? alignedRowSize * (height - 1) + rowSize : 0;
+}
+
+// Pointeurs d'origine de GLAD et fonctions qui les remplacent pendant la capture
+#define GL_TRACE_FUNCTIONS(X)                                                                                                      \
+    X(GenBuffers) X(DeleteBuffers) X(BindBuffer) X(BufferData) X(BufferSubData) X(BindBufferBase) X(MapBufferRange) X(UnmapBuffer) \
+    X(GenVertexArrays) X(DeleteVertexArrays) X(BindVertexArray) X(VertexAttribPointer) X(EnableVertexAttribArray)                \
+    X(VertexAttribDivisor) X(VertexAttrib3fv) X(GenTextures) X(DeleteTextures) X(ActiveTexture) X(BindTexture) X(TexImage2D)   \
+    X(TexParameteri) X(GenerateMipmap) X(PixelStorei) X(TexBuffer) X(GenFramebuffers) X(DeleteFramebuffers) X(BindFramebuffer) \
+    X(FramebufferTexture2D) X(GenRenderbuffers) X(DeleteRenderbuffers) X(BindRenderbuffer) X(RenderbufferStorage)               \
+    X(FramebufferRenderbuffer) X(DrawBuffers) X(BlitFramebuffer) X(CreateShader) X(DeleteShader) X(ShaderSource)                \
+    X(CompileShader) X(CreateProgram) X(DeleteProgram) X(AttachShader) X(DetachShader) X(LinkProgram) X(UseProgram)             \
+    X(GetUniformLocation) X(GetUniformBlockIndex) X(UniformBlockBinding) X(Uniform1i) X(Uniform1f) X(Uniform2fv)                \
+    X(Uniform3fv) X(UniformMatrix4fv) X(Enable) X(Disable) X(DepthMask) X(DepthFunc) X(CullFace) X(ColorMask) X(BlendFunc)      \
+    X(Viewport) X(ClearColor) X(Clear) X(DrawArrays) X(DrawArraysInstanced) X(DrawElementsInstanced)                             \
+    X(DrawElementsInstancedBaseVertex)
+
+#define GL_TRACE_DECLARE(name) static decltype(glad_gl##name) real_gl##name = nullptr;
+GL_TRACE_FUNCTIONS(GL_TRACE_DECLARE)
+#undef GL_TRACE_DECLARE
+
+typedef void(APIENTRYP MultiDrawElementsIndirectProc)(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride);
+static MultiDrawElementsIndirectProc real_glMultiDrawElementsIndirect = nullptr;
+
+// Création et suppression d'objets : les noms sont enregistrés pour que le rejeu les associe aux siens
+static void APIENTRY trace_glGenBuffers(GLsizei n, GLuint *buffers)
+{
+    real_glGenBuffers(n, buffers);
+    record(GL_TRACE_GEN_BUFFERS, {(uint32_t)n}, buffers, n * sizeof(GLuint));
+}
+static void APIENTRY trace_glDeleteBuffers(GLsizei n, const GLuint *buffers)
+{
+    real_glDeleteBuffers(n, buffers);
+    record(GL_TRACE_DELETE_BUFFERS, {(uint32_t)n}, buffers, n * sizeof(GLuint));
+}
+static void APIENTRY trace_glGenVertexArrays(GLsizei n, GLuint *arrays)
+{
+    real_glGenVertexArrays(n, arrays);
+    record(GL_TRACE_GEN_VERTEX_ARRAYS, {(uint32_t)n}, arrays, n * sizeof(GLuint));
+}
+static void APIENTRY trace_glDeleteVertexArrays(GLsizei n, const GLuint *arrays)
+{
+    real_glDeleteVertexArrays(n, arrays);
+    record(GL_TRACE_DELETE_VERTEX_ARRAYS, {(uint32_t)n}, arrays, n * sizeof(GLuint));
+}
+static void APIENTRY trace_glGenTextures(GLsizei n, GLuint *textures)
+{
+    real_glGenTextures(n, textures);
+    record(GL_TRACE_GEN_TEXTURES, {(uint32_t)n}, textures, n * sizeof(GLuint));
+}
+static void APIENTRY trace_glDeleteTextures(GLsizei n, const GLuint *textures)
+{
+    real_glDeleteTextures(n, textures);
+    record(GL_TRACE_DELETE_TEXTURES, {(uint32_t)n}, textures, n * sizeof(GLuint));
+}
+static void APIENTRY trace_glGenFramebuffers(GLsizei n, GLuint *framebuffers)
+{
+    real_glGenFramebuffers(n, framebuffers);
+    record(GL_TRACE_GEN_FRAMEBUFFERS, {(uint32_t)n}, framebuffers, n * sizeof(GLuint));
+}
+static void APIENTRY trace_glDeleteFramebuffers(GLsizei n, const GLuint *framebuffers)
+{
+    real_glDeleteFramebuffers(n, framebuffers);
+    record(GL_TRACE_DELETE_FRAMEBUFFERS, {(uint32_t)n}, framebuffers, n * sizeof(GLuint));
+}
+static void APIENTRY trace_glGenRenderbuffers(GLsizei n, GLuint *renderbuffers)
+{
+    real_glGenRenderbuffers(n, renderbuffers);
+    record(GL_TRACE_GEN_RENDERBUFFERS, {(uint32_t)n}, renderbuffers, n * sizeof(GLuint));
+}
+static void APIENTRY trace_glDeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers)
+{
+    real_glDeleteRenderbuffers(n, renderbuffers);
+    record(GL_TRACE_DELETE_RENDERBUFFERS, {(uint32_t)n}, renderbuffers, n * sizeof(GLuint));
+}
+static GLuint APIENTRY trace_glCreateShader(GLenum type)
+{
+    GLuint shader = real_glCreateShader(type);
+    record(GL_TRACE_CREATE_SHADER, {type, shader});
+    return shader;
+}
+static void APIENTRY trace_glDeleteShader(GLuint shader)
+{
+    real_glDeleteShader(shader);
+    record(GL_TRACE_DELETE_SHADER, {shader});
+}
+static GLuint APIENTRY trace_glCreateProgram()
+{
+    GLuint program = real_glCreateProgram();
+    record(GL_TRACE_CREATE_PROGRAM, {program});
+    return program;
+}
+static void APIENTRY trace_glDeleteProgram(GLuint program)
+{
+    real_glDeleteProgram(program);
+    record(GL_TRACE_DELETE_PROGRAM, {program});
+}
+
+// Buffers : les données envoyées sont copiées dans la trace
+static void APIENTRY trace_glBindBuffer(GLenum target, GLuint buffer)
+{
+    real_glBindBuffer(target, buffer);
+    if (target == GL_PIXEL_UNPACK_BUFFER)
+        unpackBuffer = buffer;
+    record(GL_TRACE_BIND_BUFFER, {target, buffer});
+}
+static void APIENTRY trace_glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+{
+    real_glBufferData(target, size, data, usage);
+    record(GL_TRACE_BUFFER_DATA, {target, (uint32_t)size, usage, data != nullptr}, data, data ? size : 0);
+}
+static void APIENTRY trace_glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
+{
+    real_glBufferSubData(target, offset, size, data);
+    record(GL_TRACE_BUFFER_SUB_DATA, {target, (uint32_t)offset, (uint32_t)size}, data, size);
+}
+static void APIENTRY trace_glBindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    real_glBindBufferBase(target, index, buffer);
+    record(GL_TRACE_BIND_BUFFER_BASE, {target, index, buffer});
+}
+// Le contenu d'un buffer mappé n'est connu qu'au moment où il est rendu au driver
+static void *APIENTRY trace_glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    void *pointer = real_glMapBufferRange(target, offset, length, access);
+    if (pointer)
+        mappedRanges[target] = {pointer, offset, length, access};
+    return pointer;
+}
+static GLboolean APIENTRY trace_glUnmapBuffer(GLenum target)
+{
+    auto found = mappedRanges.find(target);
+    if (found != mappedRanges.end())
+    {
+        const MappedRange &range = found->second;
+        if (range.access & GL_MAP_WRITE_BIT)
+            record(GL_TRACE_MAPPED_WRITE, {target, (uint32_t)range.offset, (uint32_t)range.length}, range.pointer, range.length);
+        mappedRanges.erase(found);
+    }
+    return real_glUnmapBuffer(target);
+}
+
+// Tableaux de sommets (les pointeurs sont des décalages dans le buffer lié)
+static void APIENTRY trace_glBindVertexArray(GLuint array)
+{
+    real_glBindVertexArray(array);
+    record(GL_TRACE_BIND_VERTEX_ARRAY, {array});
+}
+static void APIENTRY trace_glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer)
+{
+    real_glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+    record(GL_TRACE_VERTEX_ATTRIB_POINTER, {index, (uint32_t)size, type, normalized, (uint32_t)stride, pointerOffset(pointer)});
+}
+static void APIENTRY trace_glEnableVertexAttribArray(GLuint index)
+{
+    real_glEnableVertexAttribArray(index);
+    record(GL_TRACE_ENABLE_VERTEX_ATTRIB_ARRAY, {index});
+}
+static void APIENTRY trace_glVertexAttribDivisor(GLuint index, GLuint divisor)
+{
+    real_glVertexAttribDivisor(index, divisor);
+    record(GL_TRACE_VERTEX_ATTRIB_DIVISOR, {index, divisor});
+}
+static void APIENTRY trace_glVertexAttrib3fv(GLuint index, const GLfloat *v)
+{
+    real_glVertexAttrib3fv(index, v);
+    record(GL_TRACE_VERTEX_ATTRIB_3FV, {index}, v, 3 * sizeof(GLfloat));
+}
+
+// Textures et framebuffers
+static void APIENTRY trace_glActiveTexture(GLenum texture)
+{
+    real_glActiveTexture(texture);
+    record(GL_TRACE_ACTIVE_TEXTURE, {texture});
+}
+static void APIENTRY trace_glBindTexture(GLenum target, GLuint texture)
+{
+    real_glBindTexture(target, texture);
+    record(GL_TRACE_BIND_TEXTURE, {target, texture});
+}
+static void APIENTRY trace_glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void *pixels)
+{
+    real_glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+    // Avec un pixel unpack buffer lié, pixels est un décalage dans ce buffer (déjà rempli dans la trace)
+    bool fromBuffer = unpackBuffer != 0;
+    size_t size = (!fromBuffer && pixels) ? imageSize(width, height, format, type) : 0;
+    record(GL_TRACE_TEX_IMAGE_2D, {target, (uint32_t)level, (uint32_t)internalformat, (uint32_t)width, (uint32_t)height, (uint32_t)border, format, type, fromBuffer, fromBuffer ? pointerOffset(pixels) : 0},
+           pixels, size);
+}
+static void APIENTRY trace_glTexParameteri(GLenum target, GLenum pname, GLint param)
+{
+    real_glTexParameteri(target, pname, param);
+    record(GL_TRACE_TEX_PARAMETERI, {target, pname, (uint32_t)param});
+}
+static void APIENTRY trace_glGenerateMipmap(GLenum target)
+{
+    real_glGenerateMipmap(target);
+    record(GL_TRACE_GENERATE_MIPMAP, {target});
+}
+static void APIENTRY trace_glPixelStorei(GLenum pname, GLint param)
+{
+    real_glPixelStorei(pname, param);
+    if (pname == GL_UNPACK_ALIGNMENT)
+        unpackAlignment = param;
+    record(GL_TRACE_PIXEL_STOREI, {pname, (uint32_t)param});
+}
+static void APIENTRY trace_glTexBuffer(GLenum target, GLenum internalformat, GLuint buffer)
+{
+    real_glTexBuffer(target, internalformat, buffer);
+    record(GL_TRACE_TEX_BUFFER, {target, internalformat, buffer});
+}
+static void APIENTRY trace_glBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    real_glBindFramebuffer(target, framebuffer);
+    record(GL_TRACE_BIND_FRAMEBUFFER, {target, framebuffer});
+}
+static void APIENTRY trace_glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+    real_glFramebufferTexture2D(target, attachment, textarget, texture, level);
+    record(GL_TRACE_FRAMEBUFFER_TEXTURE_2D, {target, attachment, textarget, texture, (uint32_t)level});
+}
+static void APIENTRY trace_glBindRenderbuffer(GLenum target, GLuint renderbuffer)
+{
+    real_glBindRenderbuffer(target, renderbuffer);
+    record(GL_TRACE_BIND_RENDERBUFFER, {target, renderbuffer});
+}
+static void APIENTRY trace_glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height)
+{
+    real_glRenderbufferStorage(target, internalformat, width, height);
+    record(GL_TRACE_RENDERBUFFER_STORAGE, {target, internalformat, (uint32_t)width, (uint32_t)height});
+}
+static void APIENTRY trace_glFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer)
+{
+    real_glFramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
+    record(GL_TRACE_FRAMEBUFFER_RENDERBUFFER, {target, attachment, renderbuffertarget, renderbuffer});
+}
+static void APIENTRY trace_glDrawBuffers(GLsizei n, const GLenum *bufs)
+{
+    real_glDrawBuffers(n, bufs);
+    record(GL_TRACE_DRAW_BUFFERS, {(uint32_t)n}, bufs, n * sizeof(GLenum));
+}
+static void APIENTRY trace_glBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+{
+    real_glBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+    if (GLTrace::isCapturingFrames())
+        record(GL_TRACE_BLIT_FRAMEBUFFER, {(uint32_t)srcX0, (uint32_t)srcY0, (uint32_t)srcX1, (uint32_t)srcY1, (uint32_t)dstX0, (uint32_t)dstY0, (uint32_t)dstX1, (uint32_t)dstY1, mask, filter});
+}
+
+// Programmes : sources complètes, et noms des uniforms dont l'application a demandé la position
+static void APIENTRY trace_glShaderSource(GLuint shader, GLsizei count, const GLchar *const *string, const GLint *length)
+{
+    real_glShaderSource(shader, count, string, length);
+    std::string data;
+    for (GLsizei i = 0; i < count; i++)
+    {
+        uint32_t partLength = (uint32_t)((length && length[i] >= 0) ? length[i] : std::strlen(string[i]));
+        data.append(reinterpret_cast<const char *>(&partLength), sizeof(partLength));
+        data.append(string[i], partLength);
+    }
+    record(GL_TRACE_SHADER_SOURCE, {shader, (uint32_t)count}, data.data(), data.size());
+}
+static void APIENTRY trace_glCompileShader(GLuint shader)
+{
+    real_glCompileShader(shader);
+    record(GL_TRACE_COMPILE_SHADER, {shader});
+}
+static void APIENTRY trace_glAttachShader(GLuint program, GLuint shader)
+{
+    real_glAttachShader(program, shader);
+    record(GL_TRACE_ATTACH_SHADER, {program, shader});
+}
+static void APIENTRY trace_glDetachShader(GLuint program, GLuint shader)
+{
+    real_glDetachShader(program, shader);
+    record(GL_TRACE_DETACH_SHADER, {program, shader});
+}
+static void APIENTRY trace_glLinkProgram(GLuint program)
+{
+    real_glLinkProgram(program);
+    record(GL_TRACE_LINK_PROGRAM, {program});
+}
+static void APIENTRY trace_glUseProgram(GLuint program)
+{
+    real_glUseProgram(program);
+    record(GL_TRACE_USE_PROGRAM, {program});
+}
+static GLint APIENTRY trace_glGetUniformLocation(GLuint program, const GLchar *name)
+{
+    GLint location = real_glGetUniformLocation(program, name);
+    record(GL_TRACE_GET_UNIFORM_LOCATION, {program, (uint32_t)location}, name, std::strlen(name));
+    return location;
+}
+static GLuint APIENTRY trace_glGetUniformBlockIndex(GLuint program, const GLchar *uniformBlockName)
+{
+    GLuint index = real_glGetUniformBlockIndex(program, uniformBlockName);
+    record(GL_TRACE_GET_UNIFORM_BLOCK_INDEX, {program, index}, uniformBlockName, std::strlen(uniformBlockName));
+    return index;
+}
+static void APIENTRY trace_glUniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding)
+{
+    real_glUniformBlockBinding(program, uniformBlockIndex, uniformBlockBinding);
+    record(GL_TRACE_UNIFORM_BLOCK_BINDING, {program, uniformBlockIndex, uniformBlockBinding});
+}
+static void APIENTRY trace_glUniform1i(GLint location, GLint v0)
+{
+    real_glUniform1i(location, v0);
+    record(GL_TRACE_UNIFORM_1I, {(uint32_t)location, (uint32_t)v0});
+}
+static void APIENTRY trace_glUniform1f(GLint location, GLfloat v0)
+{
+    real_glUniform1f(location, v0);
+    record(GL_TRACE_UNIFORM_1F, {(uint32_t)location, floatBits(v0)});
+}
+static void APIENTRY trace_glUniform2fv(GLint location, GLsizei count, const GLfloat *value)
+{
+    real_glUniform2fv(location, count, value);
+    record(GL_TRACE_UNIFORM_2FV, {(uint32_t)location, (uint32_t)count}, value, count * 2 * sizeof(GLfloat));
+}
+static void APIENTRY trace_glUniform3fv(GLint location, GLsizei count, const GLfloat *value)
+{
+    real_glUniform3fv(location, count, value);
+    record(GL_TRACE_UNIFORM_3FV, {(uint32_t)location, (uint32_t)count}, value, count * 3 * sizeof(GLfloat));
+}
+static void APIENTRY trace_glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+{
+    real_glUniformMatrix4fv(location, count, transpose, value);
+    record(GL_TRACE_UNIFORM_MATRIX_4FV, {(uint32_t)location, (uint32_t)count, transpose}, value, count * 16 * sizeof(GLfloat));
+}
+
+// État fixe du pipeline
+static void APIENTRY trace_glEnable(GLenum cap)
+{
+    real_glEnable(cap);
+    record(GL_TRACE_ENABLE, {cap});
+}
+static void APIENTRY trace_glDisable(GLenum cap)
+{
+    real_glDisable(cap);
+    record(GL_TRACE_DISABLE, {cap});
+}
+static void APIENTRY trace_glDepthMask(GLboolean flag)
+{
+    real_glDepthMask(flag);
+    record(GL_TRACE_DEPTH_MASK, {flag});
+}
+static void APIENTRY trace_glDepthFunc(GLenum func)
+{
+    real_glDepthFunc(func);
+    record(GL_TRACE_DEPTH_FUNC, {func});
+}
+static void APIENTRY trace_glCullFace(GLenum mode)
+{
+    real_glCullFace(mode);
+    record(GL_TRACE_CULL_FACE, {mode});
+}
+static void APIENTRY trace_glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+{
+    real_glColorMask(red, green, blue, alpha);
+    record(GL_TRACE_COLOR_MASK, {red, green, blue, alpha});
+}
+static void APIENTRY trace_glBlendFunc(GLenum sfactor, GLenum dfactor)
+{
+    real_glBlendFunc(sfactor, dfactor);
+    record(GL_TRACE_BLEND_FUNC, {sfactor, dfactor});
+}
+static void APIENTRY trace_glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    real_glViewport(x, y, width, height);
+    record(GL_TRACE_VIEWPORT, {(uint32_t)x, (uint32_t)y, (uint32_t)width, (uint32_t)height});
+}
+static void APIENTRY trace_glClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+    real_glClearColor(red, green, blue, alpha);
+    record(GL_TRACE_CLEAR_COLOR, {floatBits(red), floatBits(green), floatBits(blue), floatBits(alpha)});
+}
+
+// Effacements et draws : seulement pendant les frames capturées
+static void APIENTRY trace_glClear(GLbitfield mask)
+{
+    real_glClear(mask);
+    if (GLTrace::isCapturingFrames())
+        record(GL_TRACE_CLEAR, {mask});
+}
+static void APIENTRY trace_glDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    real_glDrawArrays(mode, first, count);
+    if (GLTrace::isCapturingFrames())
+        record(GL_TRACE_DRAW_ARRAYS, {mode, (uint32_t)first, (uint32_t)count});
+}
+static void APIENTRY trace_glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount)
+{
+    real_glDrawArraysInstanced(mode, first, count, instancecount);
+    if (GLTrace::isCapturingFrames())
+        record(GL_TRACE_DRAW_ARRAYS_INSTANCED, {mode, (uint32_t)first, (uint32_t)count, (uint32_t)instancecount});
+}
+static void APIENTRY trace_glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instancecount)
+{
+    real_glDrawElementsInstanced(mode, count, type, indices, instancecount);
+    if (GLTrace::isCapturingFrames())
+        record(GL_TRACE_DRAW_ELEMENTS_INSTANCED, {mode, (uint32_t)count, type, pointerOffset(indices), (uint32_t)instancecount});
+}
+static void APIENTRY trace_glDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instancecount, GLint basevertex)
+{
+    real_glDrawElementsInstancedBaseVertex(mode, count, type, indices, instancecount, basevertex);
+    if (GLTrace::isCapturingFrames())
+        record(GL_TRACE_DRAW_ELEMENTS_INSTANCED_BASE_VERTEX, {mode, (uint32_t)count, type, pointerOffset(indices), (uint32_t)instancecount, (uint32_t)basevertex});
+}
+static void APIENTRY trace_glMultiDrawElementsIndirect(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride)
+{
+    real_glMultiDrawElementsIndirect(mode, type, indirect, drawcount, stride);
+    if (GLTrace::isCapturingFrames())
+        record(GL_TRACE_MULTI_DRAW_ELEMENTS_INDIRECT, {mode, type, pointerOffset(indirect), (uint32_t)drawcount, (uint32_t)stride});
+}
+
+bool GLTrace::start(const std::string &path, GLADloadproc loader, int width, int height, int firstFrame, int frameCount)
+{
+    traceFile.open(path, std::ios::binary | std::ios::trunc);
+    if (!traceFile)
+    {
+        std::cout << "ERROR::GL_TRACE::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+    GLTraceHeader header;
+    std::memcpy(header.magic, GL_TRACE_MAGIC, sizeof(header.magic));
+    header.version = GL_TRACE_VERSION;
+    header.width = (uint32_t)width;
+    header.height = (uint32_t)height;
+    header.frameCount = 0;
+    traceFile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    traceLoader = loader;
+    frame = 0;
+    GLTrace::firstFrame = firstFrame;
+    lastFrame = firstFrame + frameCount;
+    capturedFrames = 0;
+    install();
+    recording = true;
+    if (firstFrame == 0)
+        record(GL_TRACE_SETUP_END, {});
+    return true;
+}
+
+void *GLTrace::getProcAddress(const char *name)
+{
+    void *proc = traceLoader ? traceLoader(name) : nullptr;
+    if (proc && std::strcmp(name, "glMultiDrawElementsIndirect") == 0)
+    {
+        real_glMultiDrawElementsIndirect = (MultiDrawElementsIndirectProc)proc;
+        return (void *)trace_glMultiDrawElementsIndirect;
+    }
+    return proc;
+}
+
+void GLTrace::endFrame()
+{
+    if (!recording)
+        return;
+    if (frame >= firstFrame)
+    {
+        record(GL_TRACE_FRAME_END, {});
+        capturedFrames++;
+    }
+    frame++;
+    if (frame == firstFrame)
+        record(GL_TRACE_SETUP_END, {});
+    if (frame >= lastFrame)
+        stop();
+}
+
+void GLTrace::stop()
+{
+    if (!recording)
+        return;
+    uninstall();
+    recording = false;
+    // Nombre de frames réellement capturées (la fenêtre a pu être fermée avant la fin)
+    traceFile.seekp(offsetof(GLTraceHeader, frameCount));
+    traceFile.write(reinterpret_cast<const char *>(&capturedFrames), sizeof(capturedFrames));
+    traceFile.close();
+    if (!traceFile)
+        std::cout << "ERROR::GL_TRACE::CANNOT_WRITE" << std::endl;
+    else
+        std::cout << "Trace OpenGL : " << capturedFrames << " frames capturees" << std::endl;
+}
+
+void GLTrace::install()
+{
+#define GL_TRACE_INSTALL(name)         \
+    real_gl##name = glad_gl##name; \
+    glad_gl##name = trace_gl##name;
+    GL_TRACE_FUNCTIONS(GL_TRACE_INSTALL)
+#undef GL_TRACE_INSTALL
+}
+
+void GLTrace::uninstall()
+{
+#define GL_TRACE_UNINSTALL(name) glad_gl##name = real_gl##name;
+    GL_TRACE_FUNCTIONS(GL_TRACE_UNINSTALL)
+#undef GL_TRACE_UNINSTALL
+}
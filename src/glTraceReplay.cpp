@@ -0,0 +1,506 @@
+#include "glTrace.hpp"
+
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+// Un appel lu dans la trace (les données restent dans le contenu du fichier)
+struct TraceCommand
+{
+    GLTraceCall call;
+    uint32_t arguments[GL_TRACE_MAX_ARGUMENTS];
+    const char *data;
+    uint32_t size;
+};
+
+typedef void(APIENTRYP MultiDrawElementsIndirectProc)(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride);
+
+// Correspondance entre les noms de la trace et ceux des objets créés au rejeu
+class TraceReplayer
+{
+public:
+    MultiDrawElementsIndirectProc multiDrawElementsIndirect = nullptr;
+    // Positions des uniforms déjà remplacées dans les commandes (plus de recherche par appel)
+    bool locationsResolved = false;
+    GLuint currentProgram = 0;
+
+    void execute(TraceCommand &command);
+    // Remplace les positions d'uniforms de la trace par celles du driver dans les commandes des frames
+    void resolveLocations(std::vector<TraceCommand> &commands);
+
+private:
+    std::vector<GLuint> buffers, vertexArrays, textures, framebuffers, renderbuffers, shaders, programs;
+    std::unordered_map<uint64_t, GLint> uniformLocations;
+    std::unordered_map<uint64_t, GLuint> uniformBlocks;
+
+    static GLuint map(const std::vector<GLuint> &names, uint32_t name)
+    {
+        return name < names.size() && names[name] != 0 ? names[name] : name;
+    }
+    static void assign(std::vector<GLuint> &names, uint32_t name, GLuint replayName)
+    {
+        if (name >= names.size())
+            names.resize(name + 1, 0);
+        names[name] = replayName;
+    }
+    static void generate(std::vector<GLuint> &names, const TraceCommand &command, void(APIENTRYP generator)(GLsizei, GLuint *))
+    {
+        std::vector<GLuint> created(command.arguments[0]);
+        generator((GLsizei)created.size(), created.data());
+        const uint32_t *recorded = reinterpret_cast<const uint32_t *>(command.data);
+        for (size_t i = 0; i < created.size(); i++)
+            assign(names, recorded[i], created[i]);
+    }
+    static void remove(const std::vector<GLuint> &names, const TraceCommand &command, void(APIENTRYP deleter)(GLsizei, const GLuint *))
+    {
+        std::vector<GLuint> deleted(command.arguments[0]);
+        const uint32_t *recorded = reinterpret_cast<const uint32_t *>(command.data);
+        for (size_t i = 0; i < deleted.size(); i++)
+            deleted[i] = map(names, recorded[i]);
+        deleter((GLsizei)deleted.size(), deleted.data());
+    }
+    GLint location(uint32_t recorded) const
+    {
+        if (locationsResolved)
+            return (GLint)recorded;
+        auto found = uniformLocations.find((uint64_t)currentProgram << 32 | recorded);
+        return found != uniformLocations.end() ? found->second : (GLint)recorded;
+    }
+};
+
+static float argumentFloat(uint32_t bits)
+{
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static const void *argumentOffset(uint32_t offset)
+{
+    return reinterpret_cast<const void *>((uintptr_t)offset);
+}
+
+void TraceReplayer::execute(TraceCommand &command)
+{
+    const uint32_t *a = command.arguments;
+    const GLfloat *values = reinterpret_cast<const GLfloat *>(command.data);
+    switch (command.call)
+    {
+    case GL_TRACE_SETUP_END:
+    case GL_TRACE_FRAME_END:
+    case GL_TRACE_CALL_COUNT:
+        break;
+    case GL_TRACE_GEN_BUFFERS:
+        generate(buffers, command, glGenBuffers);
+        break;
+    case GL_TRACE_DELETE_BUFFERS:
+        remove(buffers, command, glDeleteBuffers);
+        break;
+    case GL_TRACE_BIND_BUFFER:
+        glBindBuffer(a[0], map(buffers, a[1]));
+        break;
+    case GL_TRACE_BUFFER_DATA:
+        glBufferData(a[0], a[1], a[3] ? command.data : nullptr, a[2]);
+        break;
+    case GL_TRACE_BUFFER_SUB_DATA:
+    case GL_TRACE_MAPPED_WRITE:
+        glBufferSubData(a[0], a[1], a[2], command.data);
+        break;
+    case GL_TRACE_BIND_BUFFER_BASE:
+        glBindBufferBase(a[0], a[1], map(buffers, a[2]));
+        break;
+    case GL_TRACE_GEN_VERTEX_ARRAYS:
+        generate(vertexArrays, command, glGenVertexArrays);
+        break;
+    case GL_TRACE_DELETE_VERTEX_ARRAYS:
+        remove(vertexArrays, command, glDeleteVertexArrays);
+        break;
+    case GL_TRACE_BIND_VERTEX_ARRAY:
+        glBindVertexArray(map(vertexArrays, a[0]));
+        break;
+    case GL_TRACE_VERTEX_ATTRIB_POINTER:
+        glVertexAttribPointer(a[0], (GLint)a[1], a[2], (GLboolean)a[3], (GLsizei)a[4], argumentOffset(a[5]));
+        break;
+    case GL_TRACE_ENABLE_VERTEX_ATTRIB_ARRAY:
+        glEnableVertexAttribArray(a[0]);
+        break;
+    case GL_TRACE_VERTEX_ATTRIB_DIVISOR:
+        glVertexAttribDivisor(a[0], a[1]);
+        break;
+    case GL_TRACE_VERTEX_ATTRIB_3FV:
+        glVertexAttrib3fv(a[0], values);
+        break;
+    case GL_TRACE_GEN_TEXTURES:
+        generate(textures, command, glGenTextures);
+        break;
+    case GL_TRACE_DELETE_TEXTURES:
+        remove(textures, command, glDeleteTextures);
+        break;
+    case GL_TRACE_ACTIVE_TEXTURE:
+        glActiveTexture(a[0]);
+        break;
+    case GL_TRACE_BIND_TEXTURE:
+        glBindTexture(a[0], map(textures, a[1]));
+        break;
+    case GL_TRACE_TEX_IMAGE_2D:
+        glTexImage2D(a[0], (GLint)a[1], (GLint)a[2], (GLsizei)a[3], (GLsizei)a[4], (GLint)a[5], a[6], a[7],
+                     a[8] ? argumentOffset(a[9]) : (command.size > 0 ? command.data : nullptr));
+        break;
+    case GL_TRACE_TEX_PARAMETERI:
+        glTexParameteri(a[0], a[1], (GLint)a[2]);
+        break;
+    case GL_TRACE_GENERATE_MIPMAP:
+        glGenerateMipmap(a[0]);
+        break;
+    case GL_TRACE_PIXEL_STOREI:
+        glPixelStorei(a[0], (GLint)a[1]);
+        break;
+    case GL_TRACE_TEX_BUFFER:
+        glTexBuffer(a[0], a[1], map(buffers, a[2]));
+        break;
+    case GL_TRACE_GEN_FRAMEBUFFERS:
+        generate(framebuffers, command, glGenFramebuffers);
+        break;
+    case GL_TRACE_DELETE_FRAMEBUFFERS:
+        remove(framebuffers, command, glDeleteFramebuffers);
+        break;
+    case GL_TRACE_BIND_FRAMEBUFFER:
+        glBindFramebuffer(a[0], map(framebuffers, a[1]));
+        break;
+    case GL_TRACE_FRAMEBUFFER_TEXTURE_2D:
+        glFramebufferTexture2D(a[0], a[1], a[2], map(textures, a[3]), (GLint)a[4]);
+        break;
+    case GL_TRACE_GEN_RENDERBUFFERS:
+        generate(renderbuffers, command, glGenRenderbuffers);
+        break;
+    case GL_TRACE_DELETE_RENDERBUFFERS:
+        remove(renderbuffers, command, glDeleteRenderbuffers);
+        break;
+    case GL_TRACE_BIND_RENDERBUFFER:
+        glBindRenderbuffer(a[0], map(renderbuffers, a[1]));
+        break;
+    case GL_TRACE_RENDERBUFFER_STORAGE:
+        glRenderbufferStorage(a[0], a[1], (GLsizei)a[2], (GLsizei)a[3]);
+        break;
+    case GL_TRACE_FRAMEBUFFER_RENDERBUFFER:
+        glFramebufferRenderbuffer(a[0], a[1], a[2], map(renderbuffers, a[3]));
+        break;
+    case GL_TRACE_DRAW_BUFFERS:
+        glDrawBuffers((GLsizei)a[0], reinterpret_cast<const GLenum *>(command.data));
+        break;
+    case GL_TRACE_BLIT_FRAMEBUFFER:
+        glBlitFramebuffer((GLint)a[0], (GLint)a[1], (GLint)a[2], (GLint)a[3], (GLint)a[4], (GLint)a[5], (GLint)a[6], (GLint)a[7], a[8], a[9]);
+        break;
+    case GL_TRACE_CREATE_SHADER:
+        assign(shaders, a[1], glCreateShader(a[0]));
+        break;
+    case GL_TRACE_DELETE_SHADER:
+        glDeleteShader(map(shaders, a[0]));
+        break;
+    case GL_TRACE_SHADER_SOURCE:
+    {
+        // Parties de la source : longueur (uint32) puis caractères
+        std::vector<const GLchar *> parts;
+        std::vector<GLint> lengths;
+        const char *cursor = command.data;
+        for (uint32_t i = 0; i < a[1]; i++)
+        {
+            uint32_t length;
+            std::memcpy(&length, cursor, sizeof(length));
+            parts.push_back(cursor + sizeof(length));
+            lengths.push_back((GLint)length);
+            cursor += sizeof(length) + length;
+        }
+        glShaderSource(map(shaders, a[0]), (GLsizei)parts.size(), parts.data(), lengths.data());
+        break;
+    }
+    case GL_TRACE_COMPILE_SHADER:
+        glCompileShader(map(shaders, a[0]));
+        break;
+    case GL_TRACE_CREATE_PROGRAM:
+        assign(programs, a[0], glCreateProgram());
+        break;
+    case GL_TRACE_DELETE_PROGRAM:
+        glDeleteProgram(map(programs, a[0]));
+        break;
+    case GL_TRACE_ATTACH_SHADER:
+        glAttachShader(map(programs, a[0]), map(shaders, a[1]));
+        break;
+    case GL_TRACE_DETACH_SHADER:
+        glDetachShader(map(programs, a[0]), map(shaders, a[1]));
+        break;
+    case GL_TRACE_LINK_PROGRAM:
+        glLinkProgram(map(programs, a[0]));
+        break;
+    case GL_TRACE_USE_PROGRAM:
+        currentProgram = a[0];
+        glUseProgram(map(programs, a[0]));
+        break;
+    case GL_TRACE_GET_UNIFORM_LOCATION:
+    {
+        std::string name(command.data, command.size);
+        uniformLocations[(uint64_t)a[0] << 32 | a[1]] = glGetUniformLocation(map(programs, a[0]), name.c_str());
+        break;
+    }
+    case GL_TRACE_GET_UNIFORM_BLOCK_INDEX:
+    {
+        std::string name(command.data, command.size);
+        uniformBlocks[(uint64_t)a[0] << 32 | a[1]] = glGetUniformBlockIndex(map(programs, a[0]), name.c_str());
+        break;
+    }
+    case GL_TRACE_UNIFORM_BLOCK_BINDING:
+    {
+        auto found = uniformBlocks.find((uint64_t)a[0] << 32 | a[1]);
+        glUniformBlockBinding(map(programs, a[0]), found != uniformBlocks.end() ? found->second : a[1], a[2]);
+        break;
+    }
+    case GL_TRACE_UNIFORM_1I:
+        glUniform1i(location(a[0]), (GLint)a[1]);
+        break;
+    case GL_TRACE_UNIFORM_1F:
+        glUniform1f(location(a[0]), argumentFloat(a[1]));
+        break;
+    case GL_TRACE_UNIFORM_2FV:
+        glUniform2fv(location(a[0]), (GLsizei)a[1], values);
+        break;
+    case GL_TRACE_UNIFORM_3FV:
+        glUniform3fv(location(a[0]), (GLsizei)a[1], values);
+        break;
+    case GL_TRACE_UNIFORM_MATRIX_4FV:
+        glUniformMatrix4fv(location(a[0]), (GLsizei)a[1], (GLboolean)a[2], values);
+        break;
+    case GL_TRACE_ENABLE:
+        glEnable(a[0]);
+        break;
+    case GL_TRACE_DISABLE:
+        glDisable(a[0]);
+        break;
+    case GL_TRACE_DEPTH_MASK:
+        glDepthMask((GLboolean)a[0]);
+        break;
+    case GL_TRACE_DEPTH_FUNC:
+        glDepthFunc(a[0]);
+        break;
+    case GL_TRACE_CULL_FACE:
+        glCullFace(a[0]);
+        break;
+    case GL_TRACE_COLOR_MASK:
+        glColorMask((GLboolean)a[0], (GLboolean)a[1], (GLboolean)a[2], (GLboolean)a[3]);
+        break;
+    case GL_TRACE_BLEND_FUNC:
+        glBlendFunc(a[0], a[1]);
+        break;
+    case GL_TRACE_VIEWPORT:
+        glViewport((GLint)a[0], (GLint)a[1], (GLsizei)a[2], (GLsizei)a[3]);
+        break;
+    case GL_TRACE_CLEAR_COLOR:
+        glClearColor(argumentFloat(a[0]), argumentFloat(a[1]), argumentFloat(a[2]), argumentFloat(a[3]));
+        break;
+    case GL_TRACE_CLEAR:
+        glClear(a[0]);
+        break;
+    case GL_TRACE_DRAW_ARRAYS:
+        glDrawArrays(a[0], (GLint)a[1], (GLsizei)a[2]);
+        break;
+    case GL_TRACE_DRAW_ARRAYS_INSTANCED:
+        glDrawArraysInstanced(a[0], (GLint)a[1], (GLsizei)a[2], (GLsizei)a[3]);
+        break;
+    case GL_TRACE_DRAW_ELEMENTS_INSTANCED:
+        glDrawElementsInstanced(a[0], (GLsizei)a[1], a[2], argumentOffset(a[3]), (GLsizei)a[4]);
+        break;
+    case GL_TRACE_DRAW_ELEMENTS_INSTANCED_BASE_VERTEX:
+        glDrawElementsInstancedBaseVertex(a[0], (GLsizei)a[1], a[2], argumentOffset(a[3]), (GLsizei)a[4], (GLint)a[5]);
+        break;
+    case GL_TRACE_MULTI_DRAW_ELEMENTS_INDIRECT:
+        if (multiDrawElementsIndirect)
+            multiDrawElementsIndirect(a[0], a[1], argumentOffset(a[2]), (GLsizei)a[3], (GLsizei)a[4]);
+        break;
+    }
+}
+
+void TraceReplayer::resolveLocations(std::vector<TraceCommand> &commands)
+{
+    // Le programme actif au début des frames est celui de la fin de la boucle précédente
+    for (TraceCommand &command : commands)
+    {
+        switch (command.call)
+        {
+        case GL_TRACE_USE_PROGRAM:
+            currentProgram = command.arguments[0];
+            break;
+        case GL_TRACE_UNIFORM_1I:
+        case GL_TRACE_UNIFORM_1F:
+        case GL_TRACE_UNIFORM_2FV:
+        case GL_TRACE_UNIFORM_3FV:
+        case GL_TRACE_UNIFORM_MATRIX_4FV:
+            command.arguments[0] = (uint32_t)location(command.arguments[0]);
+            break;
+        default:
+            break;
+        }
+    }
+    locationsResolved = true;
+}
+
+// Lit les appels de la trace ; les frames commencent après GL_TRACE_SETUP_END
+static bool readTrace(const std::vector<char> &content, std::vector<TraceCommand> &setup, std::vector<TraceCommand> &frames)
+{
+    size_t cursor = sizeof(GLTraceHeader);
+    bool inFrames = false;
+    while (cursor < content.size())
+    {
+        TraceCommand command = {};
+        uint16_t id;
+        uint8_t argumentCount;
+        if (cursor + sizeof(id) + sizeof(argumentCount) > content.size())
+            return false;
+        std::memcpy(&id, &content[cursor], sizeof(id));
+        std::memcpy(&argumentCount, &content[cursor + sizeof(id)], sizeof(argumentCount));
+        cursor += sizeof(id) + sizeof(argumentCount);
+        if (id >= GL_TRACE_CALL_COUNT || argumentCount > GL_TRACE_MAX_ARGUMENTS ||
+            cursor + argumentCount * sizeof(uint32_t) + sizeof(uint32_t) > content.size())
+            return false;
+        command.call = (GLTraceCall)id;
+        std::memcpy(command.arguments, &content[cursor], argumentCount * sizeof(uint32_t));
+        cursor += argumentCount * sizeof(uint32_t);
+        std::memcpy(&command.size, &content[cursor], sizeof(command.size));
+        cursor += sizeof(command.size);
+        if (cursor + command.size > content.size())
+            return false;
+        command.data = command.size > 0 ? &content[cursor] : nullptr;
+        cursor += command.size;
+
+        if (command.call == GL_TRACE_SETUP_END)
+            inFrames = true;
+        else
+            (inFrames ? frames : setup).push_back(command);
+    }
+    return true;
+}
+
+// Minimum, moyenne et 99e centile d'une série de durées (ms)
+static void printDurations(const char *label, std::vector<double> durations)
+{
+    std::sort(durations.begin(), durations.end());
+    double sum = 0.0;
+    for (double duration : durations)
+        sum += duration;
+    size_t p99 = std::min(durations.size() - 1, (size_t)(durations.size() * 0.99));
+    std::cout << "  " << label << " : min " << durations.front() << " ms, moy " << sum / durations.size() << " ms, p99 "
+              << durations[p99] << " ms" << std::endl;
+}
+
+int runGLTraceReplay(const std::string &path, int loopCount)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        std::cout << "ERROR::GL_TRACE::CANNOT_READ " << path << std::endl;
+        return -1;
+    }
+    std::vector<char> content((size_t)file.tellg());
+    file.seekg(0);
+    file.read(content.data(), content.size());
+    GLTraceHeader header;
+    if (!file || content.size() < sizeof(header))
+    {
+        std::cout << "ERROR::GL_TRACE::INVALID_FILE " << path << std::endl;
+        return -1;
+    }
+    std::memcpy(&header, content.data(), sizeof(header));
+    std::vector<TraceCommand> setup, frames;
+    if (std::memcmp(header.magic, GL_TRACE_MAGIC, sizeof(header.magic)) != 0 || header.version != GL_TRACE_VERSION ||
+        !readTrace(content, setup, frames))
+    {
+        std::cout << "ERROR::GL_TRACE::INVALID_FILE " << path << std::endl;
+        return -1;
+    }
+    if (header.frameCount == 0 || frames.empty())
+    {
+        std::cout << "ERROR::GL_TRACE::NO_FRAME " << path << std::endl;
+        return -1;
+    }
+
+    // Contexte identique à celui de l'application, sans synchronisation verticale
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    GLFWwindow *window = glfwCreateWindow((int)header.width, (int)header.height, path.c_str(), NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwSwapInterval(0);
+
+    TraceReplayer replayer;
+    replayer.multiDrawElementsIndirect = (MultiDrawElementsIndirectProc)glfwGetProcAddress("glMultiDrawElementsIndirect");
+    size_t drawCalls = 0;
+    for (const TraceCommand &command : frames)
+    {
+        if (command.call >= GL_TRACE_DRAW_ARRAYS && command.call <= GL_TRACE_MULTI_DRAW_ELEMENTS_INDIRECT)
+            drawCalls++;
+    }
+
+    // Mise en place une seule fois (création des objets, envoi des données, compilation des programmes)
+    auto setupStart = std::chrono::steady_clock::now();
+    for (TraceCommand &command : setup)
+        replayer.execute(command);
+    glFinish();
+    double setupTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - setupStart).count();
+
+    // Un premier passage sur les frames (non mesuré) pour connaître toutes les positions d'uniforms
+    for (TraceCommand &command : frames)
+    {
+        replayer.execute(command);
+        if (command.call == GL_TRACE_FRAME_END)
+            glfwSwapBuffers(window);
+    }
+    replayer.resolveLocations(frames);
+    glFinish();
+
+    std::vector<double> submitTimes, totalTimes;
+    for (int loop = 0; loop < loopCount && !glfwWindowShouldClose(window); loop++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (TraceCommand &command : frames)
+        {
+            replayer.execute(command);
+            if (command.call == GL_TRACE_FRAME_END)
+                glfwSwapBuffers(window);
+        }
+        auto submitted = std::chrono::steady_clock::now();
+        glFinish();
+        auto finished = std::chrono::steady_clock::now();
+        submitTimes.push_back(std::chrono::duration<double, std::milli>(submitted - start).count() / header.frameCount);
+        totalTimes.push_back(std::chrono::duration<double, std::milli>(finished - start).count() / header.frameCount);
+        glfwPollEvents();
+    }
+
+    std::cout << "Trace " << path << " : " << (const char *)glGetString(GL_RENDERER) << std::endl;
+    std::cout << "  mise en place : " << setup.size() << " appels, " << setupTime << " ms" << std::endl;
+    std::cout << "  " << header.frameCount << " frames : " << (frames.size() - header.frameCount) / header.frameCount
+              << " appels et " << drawCalls / header.frameCount << " draws par frame, rejouees " << submitTimes.size() << " fois" << std::endl;
+    if (!submitTimes.empty())
+    {
+        printDurations("soumission par frame", submitTimes);
+        printDurations("total par frame (glFinish)", totalTimes);
+    }
+
+    glfwTerminate();
+    return 0;
+}
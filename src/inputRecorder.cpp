@@ -0,0 +1,259 @@
+#include "inputRecorder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// Touches lues par processInput : seules celles-ci sont enregistrées
+static const int RECORDED_KEYS[] = {GLFW_KEY_ESCAPE, GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_A, GLFW_KEY_D, GLFW_KEY_T,
+                                    GLFW_KEY_G, GLFW_KEY_Q, GLFW_KEY_GRAVE_ACCENT, GLFW_KEY_P};
+static const size_t RECORDED_KEY_COUNT = sizeof(RECORDED_KEYS) / sizeof(RECORDED_KEYS[0]);
+
+// Indice de la touche dans RECORDED_KEYS, RECORDED_KEY_COUNT si elle n'est pas suivie
+static size_t recordedKeyIndex(int key)
+{
+    for (size_t i = 0; i < RECORDED_KEY_COUNT; i++)
+        if (RECORDED_KEYS[i] == key)
+            return i;
+    return RECORDED_KEY_COUNT;
+}
+
+bool InputRecorder::startRecording(const std::string &path)
+{
+    stop();
+    output.open(path, std::ios::binary | std::ios::trunc);
+    if (!output)
+    {
+        std::cout << "ERROR::INPUT_RECORDER::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+    InputRecordingHeader header;
+    std::memcpy(header.magic, INPUT_RECORDING_MAGIC, sizeof(header.magic));
+    header.version = INPUT_RECORDING_VERSION;
+    output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    keyStates.assign(RECORDED_KEY_COUNT, GLFW_RELEASE);
+    startTime = glfwGetTime();
+    recording = true;
+    return true;
+}
+
+bool InputRecorder::startReplay(const std::string &path, float timestep)
+{
+    stop();
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::cout << "ERROR::INPUT_RECORDER::CANNOT_READ " << path << std::endl;
+        return false;
+    }
+    InputRecordingHeader header;
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, INPUT_RECORDING_MAGIC, sizeof(header.magic)) != 0 || header.version != INPUT_RECORDING_VERSION)
+    {
+        std::cout << "ERROR::INPUT_RECORDER::INVALID_FILE " << path << std::endl;
+        return false;
+    }
+    if (!readEvents(file))
+        std::cout << "ERROR::INPUT_RECORDER::TRUNCATED_FILE " << path << std::endl;
+
+    keyStates.assign(RECORDED_KEY_COUNT, GLFW_RELEASE);
+    nextEvent = 0;
+    replayTime = 0.0;
+    // Les lignes de la console sont lues juste après l'appui sur la touche du menu : on les rend dans l'ordre, sans attendre leur temps
+    pendingLines.clear();
+    nextLine = 0;
+    for (const Event &event : events)
+        if (event.type == INPUT_EVENT_LINE)
+            pendingLines.push_back(event.line);
+    this->timestep = timestep;
+    replaying = true;
+    std::cout << "Rejeu de " << path << " : " << events.size() << " evenements sur "
+              << (events.empty() ? 0.0f : events.back().time) << " s" << std::endl;
+    return true;
+}
+
+void InputRecorder::stop()
+{
+    if (recording)
+    {
+        writeEvent(INPUT_EVENT_END, nullptr, 0);
+        output.close();
+        recording = false;
+    }
+    replaying = false;
+    events.clear();
+}
+
+void InputRecorder::setPointerHandlers(std::function<void(float, float)> mouseMovement, std::function<void(float)> scroll)
+{
+    this->mouseMovement = std::move(mouseMovement);
+    this->scroll = std::move(scroll);
+}
+
+float InputRecorder::now() const
+{
+    return (float)(glfwGetTime() - startTime);
+}
+
+void InputRecorder::writeEvent(InputEventType type, const void *data, size_t size)
+{
+    float time = now();
+    output.put((char)type);
+    output.write(reinterpret_cast<const char *>(&time), sizeof(time));
+    if (size > 0)
+        output.write(reinterpret_cast<const char *>(data), size);
+}
+
+bool InputRecorder::readEvents(std::ifstream &file)
+{
+    events.clear();
+    while (true)
+    {
+        int type = file.get();
+        if (type == EOF)
+            return true;
+        Event event = {(InputEventType)type, 0.0f, 0, 0, 0.0f, 0.0f, ""};
+        file.read(reinterpret_cast<char *>(&event.time), sizeof(event.time));
+        switch (event.type)
+        {
+        case INPUT_EVENT_KEY:
+        {
+            int16_t key = 0;
+            uint8_t action = 0;
+            file.read(reinterpret_cast<char *>(&key), sizeof(key));
+            file.read(reinterpret_cast<char *>(&action), sizeof(action));
+            event.key = key;
+            event.action = action;
+            break;
+        }
+        case INPUT_EVENT_MOUSE:
+            file.read(reinterpret_cast<char *>(&event.x), sizeof(event.x));
+            file.read(reinterpret_cast<char *>(&event.y), sizeof(event.y));
+            break;
+        case INPUT_EVENT_SCROLL:
+            file.read(reinterpret_cast<char *>(&event.y), sizeof(event.y));
+            break;
+        case INPUT_EVENT_LINE:
+        {
+            uint16_t length = 0;
+            file.read(reinterpret_cast<char *>(&length), sizeof(length));
+            event.line.resize(length);
+            file.read(&event.line[0], length);
+            break;
+        }
+        case INPUT_EVENT_END:
+            break;
+        default:
+            return false;
+        }
+        if (!file)
+            return false;
+        events.push_back(event);
+    }
+}
+
+bool InputRecorder::beginFrame(GLFWwindow *window)
+{
+    if (recording)
+    {
+        // Seuls les changements d'état sont écrits
+        for (size_t i = 0; i < RECORDED_KEY_COUNT; i++)
+        {
+            int state = glfwGetKey(window, RECORDED_KEYS[i]);
+            if (state == keyStates[i])
+                continue;
+            keyStates[i] = state;
+            char data[3];
+            int16_t key = (int16_t)RECORDED_KEYS[i];
+            std::memcpy(data, &key, sizeof(key));
+            data[2] = (char)state;
+            writeEvent(INPUT_EVENT_KEY, data, sizeof(data));
+        }
+        return true;
+    }
+    if (!replaying)
+        return true;
+
+    // Le temps du rejeu avance d'un pas fixe par frame, indépendamment de la durée réelle de la frame
+    replayTime += timestep;
+    while (nextEvent < events.size() && events[nextEvent].time <= replayTime)
+    {
+        const Event &event = events[nextEvent++];
+        switch (event.type)
+        {
+        case INPUT_EVENT_KEY:
+        {
+            size_t index = recordedKeyIndex(event.key);
+            if (index < RECORDED_KEY_COUNT)
+                keyStates[index] = event.action;
+            break;
+        }
+        case INPUT_EVENT_MOUSE:
+            if (mouseMovement)
+                mouseMovement(event.x, event.y);
+            break;
+        case INPUT_EVENT_SCROLL:
+            if (scroll)
+                scroll(event.y);
+            break;
+        case INPUT_EVENT_LINE:
+        case INPUT_EVENT_END:
+            break;
+        }
+    }
+    return nextEvent < events.size();
+}
+
+int InputRecorder::getKey(GLFWwindow *window, int key) const
+{
+    size_t index = recordedKeyIndex(key);
+    if (replaying)
+        return index < RECORDED_KEY_COUNT ? keyStates[index] : GLFW_RELEASE;
+    if (recording && index < RECORDED_KEY_COUNT)
+        return keyStates[index];
+    return glfwGetKey(window, key);
+}
+
+bool InputRecorder::readLine(std::string &line)
+{
+    if (replaying)
+    {
+        if (nextLine >= pendingLines.size())
+        {
+            line.clear();
+            return false;
+        }
+        line = pendingLines[nextLine++];
+        return true;
+    }
+
+    double waitStart = glfwGetTime();
+    if (!std::getline(std::cin, line))
+        return false;
+    if (recording)
+    {
+        // Le temps passé à taper n'est pas enregistré : le rejeu n'attend pas la saisie
+        startTime += glfwGetTime() - waitStart;
+        uint16_t length = (uint16_t)std::min<size_t>(line.size(), UINT16_MAX);
+        std::vector<char> data(sizeof(length) + length);
+        std::memcpy(data.data(), &length, sizeof(length));
+        std::memcpy(data.data() + sizeof(length), line.data(), length);
+        writeEvent(INPUT_EVENT_LINE, data.data(), data.size());
+    }
+    return true;
+}
+
+void InputRecorder::recordMouseMovement(float xoffset, float yoffset)
+{
+    if (!recording)
+        return;
+    float data[2] = {xoffset, yoffset};
+    writeEvent(INPUT_EVENT_MOUSE, data, sizeof(data));
+}
+
+void InputRecorder::recordScroll(float yoffset)
+{
+    if (recording)
+        writeEvent(INPUT_EVENT_SCROLL, &yoffset, sizeof(yoffset));
+}
@@ -0,0 +1,389 @@
+#include "instancedRenderer.hpp"
+#include "assetCache.hpp"
+#include "glState.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+
+void InstancedRenderer::createPlaceholder()
+{
+    // Cube unité centré sur l'origine : 6 faces de 4 sommets avec leur normale
+    MeshData cube;
+    const glm::vec3 normals[6] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+    for (const glm::vec3 &normal : normals)
+    {
+        // Deux axes du plan de la face, orientés pour que les triangles soient dans le sens anti-horaire vu de l'extérieur
+        glm::vec3 u = glm::vec3(normal.y, normal.z, normal.x);
+        glm::vec3 v = glm::cross(normal, u);
+        unsigned int first = (unsigned int)cube.vertices.size();
+        const glm::vec2 corners[4] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+        for (const glm::vec2 &corner : corners)
+        {
+            Vertex vertex;
+            vertex.Position = 0.5f * normal + (corner.x - 0.5f) * u + (corner.y - 0.5f) * v;
+            vertex.Normal = normal;
+            vertex.TexCoords = corner;
+            cube.vertices.push_back(vertex);
+        }
+        const unsigned int faceIndices[6] = {0, 1, 2, 0, 2, 3};
+        for (unsigned int index : faceIndices)
+            cube.indices.push_back(first + index);
+    }
+    cube.vertexData = cube.vertices.data();
+    cube.vertexCount = cube.vertices.size();
+    cube.indexData = cube.indices.data();
+    cube.indexCount = cube.indices.size();
+    // La boîte sert aussi à quantifier les positions : sans elle, le cube serait aplati en un point
+    cube.bounds = computeAABB(cube.vertexData, cube.vertexCount, sizeof(Vertex));
+    cube.boundingSphere = computeBoundingSphere(cube.vertexData, cube.vertexCount, sizeof(Vertex), cube.bounds);
+
+    // Texture 1x1 grise pour la diffuse et la specular
+    std::shared_ptr<TextureAsset> grey = std::make_shared<TextureAsset>();
+    const unsigned char pixel[4] = {128, 128, 128, 255};
+    glGenTextures(1, &grey->id);
+    GLState::bindTexture(0, GL_TEXTURE_2D, grey->id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    GLState::bindTexture(0, GL_TEXTURE_2D, 0);
+    grey->ready = true;
+    cube.textures.push_back({"texture_diffuse", "", grey});
+    cube.textures.push_back({"texture_specular", "", grey});
+
+    placeholder = std::make_unique<Model>();
+    placeholder->uploadMesh(cube);
+    placeholder->finishUpload();
+}
+
+void InstancedRenderer::addInstance(Mesh *mesh, int lod, const glm::mat4 &modelMatrix, float distance)
+{
+    // Les lots sont créés dans l'ordre de première apparition des meshes
+    lod = std::min(lod, mesh->getLodCount() - 1);
+    BatchKey key = {mesh, lod};
+    auto found = batchIndices.find(key);
+    size_t index;
+    if (found == batchIndices.end())
+    {
+        index = batchCount++;
+        batchIndices[key] = index;
+        if (index == batches.size())
+            batches.push_back(Batch());
+        batches[index].mesh = mesh;
+        batches[index].lod = lod;
+        batches[index].modelMatrices.clear();
+        batches[index].distance = distance;
+    }
+    else
+    {
+        index = found->second;
+        batches[index].distance = std::min(batches[index].distance, distance);
+    }
+    batches[index].modelMatrices.push_back(modelMatrix);
+}
+
+int InstancedRenderer::selectLod(float screenSize, int currentLod)
+{
+    // LOD sans marge : le premier dont le seuil est sous la taille à l'écran
+    int lod = 0;
+    while (lod < MESH_LOD_COUNT - 1 && screenSize < MESH_LOD_SCREEN_SIZES[lod])
+        lod++;
+
+    // On ne passe au LOD le plus simple que si la taille est nettement sous le seuil, et inversement
+    if (lod > currentLod)
+    {
+        while (lod > currentLod && screenSize >= MESH_LOD_SCREEN_SIZES[lod - 1] * (1.0f - MESH_LOD_HYSTERESIS))
+            lod--;
+    }
+    else if (lod < currentLod)
+    {
+        while (lod < currentLod && screenSize <= MESH_LOD_SCREEN_SIZES[lod] * (1.0f + MESH_LOD_HYSTERESIS))
+            lod++;
+    }
+    return lod;
+}
+
+// Valeur de visible[i] pour un objet dans le frustum mais caché par les occulteurs
+static const uint8_t OCCLUDED = 2;
+
+void InstancedRenderer::draw(const Scene &scene, ShaderVariants &shaders, const RenderView &view)
+{
+    const Frustum &frustum = view.frustum;
+    stats = RenderStats();
+    batchIndices.clear();
+    batchCount = 0;
+
+    // 1. Culling par objet : la BVH écarte les groupes d'objets hors du frustum, puis les boîtes (non élargies)
+    // des candidats restants sont testées précisément
+    sceneCandidates.clear();
+    scene.queryFrustum(frustum, sceneCandidates);
+    stats.culledObjects = scene.size() - sceneCandidates.size();
+    candidates.clear();
+    worldBounds.clear();
+    for (GameObject *gameObject : sceneCandidates)
+    {
+        Model *model = gameObject->getModel();
+        if (gameObject->getLoadState() == GameObject::LoadState::Loading)
+        {
+            // Le modèle est encore en chargement : on dessine le cube de remplacement à sa place
+            if (!placeholder)
+                continue;
+            model = placeholder.get();
+        }
+        const OccluderMesh *occluder = nullptr;
+        if (gameObject->isOccluder() && model != placeholder.get() && !model->getOccluder().empty())
+            occluder = &model->getOccluder();
+        Candidate candidate = {gameObject, model, &gameObject->getModelMatrix(), occluder, 0};
+        candidates.push_back(candidate);
+        worldBounds.push_back(gameObject->getWorldBounds());
+    }
+    visible.resize(candidates.size());
+    frustum.intersects(worldBounds.data(), worldBounds.size(), visible.data());
+
+    // Occlusion culling : les occulteurs visibles remplissent le tampon de profondeur logiciel,
+    // puis les objets visibles entièrement derrière eux sont écartés
+    if (occlusionBuffer)
+    {
+        occlusionBuffer->begin(view.viewProjection);
+        for (size_t i = 0; i < candidates.size(); i++)
+        {
+            if (visible[i] && candidates[i].occluder)
+                occlusionBuffer->addOccluder(*candidates[i].occluder, *candidates[i].modelMatrix);
+        }
+        occlusionBuffer->rasterize(occlusionThreadCount);
+        stats.occlusionRasterizeTime = occlusionBuffer->getRasterizeTime();
+        for (size_t i = 0; i < candidates.size(); i++)
+        {
+            if (visible[i] && !occlusionBuffer->isVisible(worldBounds[i]))
+                visible[i] = OCCLUDED;
+        }
+    }
+
+    // 2. Culling par mesh des objets visibles (inutile pour les modèles d'un seul mesh, déjà testés)
+    meshCandidates.clear();
+    candidateMeshes.clear();
+    worldBounds.clear();
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        vector<Mesh> &meshes = candidates[i].model->getMeshes();
+        if (visible[i] == OCCLUDED)
+        {
+            stats.occludedObjects++;
+            stats.occludedMeshes += meshes.size();
+            continue;
+        }
+        if (!visible[i])
+        {
+            stats.culledObjects++;
+            stats.culledMeshes += meshes.size();
+            continue;
+        }
+        stats.visibleObjects++;
+
+        // LOD selon le rayon de la sphère qui englobe la boîte (le cube de remplacement reste au LOD 0)
+        if (candidates[i].model != placeholder.get())
+        {
+            const AABB &bounds = candidates[i].gameObject->getWorldBounds();
+            float radius = glm::length(bounds.getExtents());
+            float distance = std::max(glm::length(bounds.getCenter() - view.cameraPosition), radius);
+            float screenSize = distance > 0.0f ? radius / distance * view.projectionScale : 1.0f;
+            candidates[i].lod = selectLod(screenSize, candidates[i].gameObject->getLod());
+            candidates[i].gameObject->setLod(candidates[i].lod);
+        }
+        stats.lodHistogram[candidates[i].lod]++;
+
+        if (meshes.size() == 1)
+        {
+            stats.visibleMeshes++;
+            float distance = glm::length(candidates[i].gameObject->getWorldBounds().getCenter() - view.cameraPosition);
+            addInstance(&meshes[0], candidates[i].lod, *candidates[i].modelMatrix, distance);
+            continue;
+        }
+        for (Mesh &mesh : meshes)
+        {
+            meshCandidates.push_back(candidates[i]);
+            candidateMeshes.push_back(&mesh);
+            worldBounds.push_back(transformAABB(*candidates[i].modelMatrix, mesh.getBounds()));
+        }
+    }
+    visible.resize(candidateMeshes.size());
+    frustum.intersects(worldBounds.data(), worldBounds.size(), visible.data());
+    for (size_t i = 0; i < candidateMeshes.size(); i++)
+    {
+        if (!visible[i])
+        {
+            stats.culledMeshes++;
+            continue;
+        }
+        if (occlusionBuffer && !occlusionBuffer->isVisible(worldBounds[i]))
+        {
+            stats.occludedMeshes++;
+            continue;
+        }
+        stats.visibleMeshes++;
+        float distance = glm::length(worldBounds[i].getCenter() - view.cameraPosition);
+        addInstance(candidateMeshes[i], meshCandidates[i].lod, *meshCandidates[i].modelMatrix, distance);
+    }
+
+    // 3. File de rendu : les batches sont triés par programme (variante du shader pour le matériau), matériau et VAO
+    // pour limiter les changements d'état, puis de l'avant vers l'arrière (les objets de la scène sont tous opaques)
+    renderQueue.clear();
+    for (size_t i = 0; i < batchCount; i++)
+    {
+        const Batch &batch = batches[i];
+        float depth = batch.distance / FAR_CLIP_PLANE_DISTANCE;
+        unsigned int program = shaders.get(batch.mesh->getShaderFeatures()).ID;
+        renderQueue.push(RenderQueue::makeKey(RenderPass::Opaque, program, batch.mesh->getMaterialId(), batch.mesh->getVertexArray(false), depth),
+                         (uint32_t)i);
+    }
+    stats.shaderVariants = shaders.getVariantCount();
+    renderQueue.sort();
+
+    // Les batches des meshes rangés dans le pool de géométrie sont envoyés au GPU en une fois, dans l'ordre de la file
+    if (geometryPool)
+    {
+        geometryPool->beginFrame();
+        for (const RenderItem &item : renderQueue.getItems())
+        {
+            Batch &batch = batches[item.index];
+            if (batch.mesh->isPooled())
+                geometryPool->addDraw(*batch.mesh, batch.lod, batch.modelMatrices.data(), (GLsizei)batch.modelMatrices.size());
+        }
+        geometryPool->upload();
+    }
+    uploadInstances();
+    for (size_t i = 0; i < batchCount; i++)
+        stats.triangles += batches[i].mesh->getLod(batches[i].lod).indexCount / 3 * batches[i].modelMatrices.size();
+
+    // 4. Passe de profondeur optionnelle : la passe principale n'exécute ensuite le fragment shader que pour les surfaces visibles
+    if (depthPrepassShader)
+    {
+        PROFILE_GPU_SCOPE("depth prepass");
+        GLState::colorMask(false);
+        depthPrepassShader->use();
+        stats.programSwitches++;
+        submit(nullptr);
+        GLState::colorMask(true);
+        // Les profondeurs sont déjà écrites : on ne garde que les fragments égaux
+        GLState::depthFunc(GL_LEQUAL);
+        GLState::depthMask(false);
+    }
+
+    // 5. Passe principale
+    {
+        PROFILE_GPU_SCOPE("main pass");
+        submit(&shaders);
+    }
+
+    if (depthPrepassShader)
+    {
+        GLState::depthMask(true);
+        GLState::depthFunc(GL_LESS);
+    }
+}
+
+void InstancedRenderer::uploadInstances()
+{
+    // Les matrices des batches hors du pool sont envoyées une seule fois par frame, avant la passe de profondeur
+    // qui dessine les mêmes batches : les batches d'un même mesh (un par LOD) se suivent dans son buffer d'instances
+    instanceUploads.clear();
+    for (size_t i = 0; i < batchCount; i++)
+    {
+        if (!batches[i].mesh->isPooled())
+            instanceUploads.push_back(i);
+    }
+    std::sort(instanceUploads.begin(), instanceUploads.end(), [this](size_t a, size_t b)
+              { return batches[a].mesh < batches[b].mesh; });
+
+    for (size_t first = 0; first < instanceUploads.size();)
+    {
+        Mesh *mesh = batches[instanceUploads[first]].mesh;
+        size_t last = first + 1;
+        while (last < instanceUploads.size() && batches[instanceUploads[last]].mesh == mesh)
+            last++;
+        if (last - first == 1)
+        {
+            // Un seul LOD visible : les matrices du batch sont envoyées sans copie
+            Batch &batch = batches[instanceUploads[first]];
+            batch.firstInstance = 0;
+            mesh->uploadInstances(batch.modelMatrices.data(), (GLsizei)batch.modelMatrices.size());
+        }
+        else
+        {
+            instanceMatrices.clear();
+            for (size_t i = first; i < last; i++)
+            {
+                Batch &batch = batches[instanceUploads[i]];
+                batch.firstInstance = (GLint)instanceMatrices.size();
+                instanceMatrices.insert(instanceMatrices.end(), batch.modelMatrices.begin(), batch.modelMatrices.end());
+            }
+            mesh->uploadInstances(instanceMatrices.data(), (GLsizei)instanceMatrices.size());
+        }
+        first = last;
+    }
+}
+
+void InstancedRenderer::submit(ShaderVariants *shaders)
+{
+    bool depthOnly = shaders == nullptr;
+
+    // Quelques multi-draws pour le pool (un par matériau)
+    if (geometryPool)
+    {
+        size_t drawCalls = depthOnly ? geometryPool->submitDepth() : geometryPool->submit(*shaders);
+        stats.drawCalls += drawCalls;
+        if (drawCalls > 0)
+        {
+            stats.vertexArraySwitches++;
+            if (!depthOnly)
+            {
+                stats.textureSwitches += geometryPool->getMaterialGroupCount();
+                stats.programSwitches += geometryPool->getProgramSwitchCount();
+            }
+        }
+    }
+
+    // Puis un appel instancié par mesh et par LOD pour les autres, dans l'ordre de la file :
+    // le programme, le VAO et les textures ne sont liés que lorsqu'ils changent
+    Shader *currentShader = nullptr;
+    unsigned int currentVertexArray = 0;
+    unsigned int currentMaterial = 0;
+    bool materialBound = false;
+    for (const RenderItem &item : renderQueue.getItems())
+    {
+        Batch &batch = batches[item.index];
+        if (geometryPool && batch.mesh->isPooled())
+            continue;
+        unsigned int vertexArray = batch.mesh->getVertexArray(depthOnly);
+        if (vertexArray == 0)
+            continue;
+
+        if (vertexArray != currentVertexArray)
+        {
+            GLState::bindVertexArray(vertexArray);
+            currentVertexArray = vertexArray;
+            stats.vertexArraySwitches++;
+        }
+        if (!depthOnly)
+        {
+            Shader &shader = shaders->use(batch.mesh->getShaderFeatures());
+            if (&shader != currentShader)
+            {
+                // Les samplers sont des uniforms du programme : ils sont à relier pour la nouvelle variante
+                currentShader = &shader;
+                materialBound = false;
+                stats.programSwitches++;
+            }
+        }
+        if (!depthOnly && (!materialBound || batch.mesh->getMaterialId() != currentMaterial))
+        {
+            batch.mesh->bindTextures(*currentShader);
+            currentMaterial = batch.mesh->getMaterialId();
+            materialBound = true;
+            stats.textureSwitches++;
+        }
+        batch.mesh->drawInstancesBound(batch.firstInstance, (GLsizei)batch.modelMatrices.size(), batch.lod, depthOnly);
+        stats.drawCalls++;
+        if (!depthOnly)
+            shaders->addDraws(1);
+    }
+}
@@ -0,0 +1,108 @@
+#include "jobSystem.hpp"
+
+#include <chrono>
+
+JobSystem::JobSystem(unsigned int threadCount)
+{
+    if (threadCount == 0)
+        threadCount = 1;
+    for (unsigned int i = 0; i < threadCount; i++)
+        workers.emplace_back(&JobSystem::workerLoop, this);
+}
+
+void JobSystem::submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping)
+            return;
+        jobs.push_back(std::move(job));
+    }
+    jobAvailable.notify_one();
+}
+
+void JobSystem::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    jobAvailable.notify_all();
+    for (std::thread &worker : workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+    workers.clear();
+}
+
+void JobSystem::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this]
+                              { return stopping || !jobs.empty(); });
+            if (stopping)
+                return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            runningCount++;
+        }
+        job();
+        std::lock_guard<std::mutex> lock(mutex);
+        runningCount--;
+    }
+}
+
+size_t JobSystem::pendingCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return jobs.size() + runningCount;
+}
+
+void MainThreadQueue::push(std::function<void()> task)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    tasks.push_back(std::move(task));
+}
+
+void MainThreadQueue::process(double budgetMilliseconds)
+{
+    auto start = std::chrono::steady_clock::now();
+    while (true)
+    {
+        // Une tâche peut en ajouter d'autres : on n'en retire qu'une à la fois, hors du verrou pendant son exécution
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tasks.empty())
+                return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() >= budgetMilliseconds)
+            return;
+    }
+}
+
+void MainThreadQueue::clear()
+{
+    std::deque<std::function<void()>> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.swap(tasks);
+    }
+}
+
+size_t MainThreadQueue::pendingCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return tasks.size();
+}
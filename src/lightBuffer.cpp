@@ -0,0 +1,185 @@
+#include "lightBuffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+// Remplit la structure std140 d'une PointLight
+static PointLightStd140 toStd140(PointLight &light)
+{
+    PointLightStd140 gpuLight = {};
+    gpuLight.position = light.getPosition();
+    gpuLight.constant = light.getConstant();
+    gpuLight.ambient = light.getAmbient();
+    gpuLight.linear = light.getLinear();
+    gpuLight.diffuse = light.getDiffuse();
+    gpuLight.quadratic = light.getQuadratic();
+    gpuLight.specular = light.getSpecular();
+    gpuLight.range = std::min(light.getRange(), MAX_LIGHT_RANGE);
+    return gpuLight;
+}
+
+// Remplit la structure std140 d'une SpotLight
+static SpotLightStd140 toStd140(SpotLight &light)
+{
+    SpotLightStd140 gpuLight = {};
+    gpuLight.position = light.getPosition();
+    gpuLight.constant = light.getConstant();
+    gpuLight.direction = light.getDirection();
+    gpuLight.linear = light.getLinear();
+    gpuLight.ambient = light.getAmbient();
+    gpuLight.quadratic = light.getQuadratic();
+    gpuLight.diffuse = light.getDiffuse();
+    gpuLight.cosCutOff = light.getCosCutOff();
+    gpuLight.specular = light.getSpecular();
+    gpuLight.cosOuterCutOff = light.getCosOuterCutOff();
+    return gpuLight;
+}
+
+// Copie les lumières modifiées dans gpuLights et envoie la plage contiguë qui les contient.
+// Si le buffer est trop petit, il est ré-alloué (capacité doublée) et toutes les lumières sont ré-envoyées.
+// Renvoie true si le nombre de lumières a changé.
+template <typename Light, typename GpuLight>
+static bool uploadDirtyLights(std::vector<Light> &lights, std::vector<GpuLight> &gpuLights, TextureBuffer &buffer)
+{
+    bool countChanged = lights.size() != gpuLights.size();
+    gpuLights.resize(lights.size());
+
+    GLsizeiptr requiredSize = (GLsizeiptr)(std::max<size_t>(lights.size(), 1) * sizeof(GpuLight));
+    bool reallocated = false;
+    if (requiredSize > buffer.getSize())
+    {
+        buffer.resize(std::max(requiredSize, 2 * buffer.getSize()));
+        reallocated = true;
+    }
+
+    int first = (int)lights.size();
+    int last = -1;
+    for (int i = 0; i < (int)lights.size(); i++)
+    {
+        if (!lights[i].isDirty() && !reallocated)
+            continue;
+        gpuLights[i] = toStd140(lights[i]);
+        lights[i].clearDirty();
+        first = std::min(first, i);
+        last = i;
+    }
+
+    if (first <= last)
+        buffer.update(first * sizeof(GpuLight), (last - first + 1) * sizeof(GpuLight), &gpuLights[first]);
+
+    return countChanged;
+}
+
+// Alloue le UBO au point de liaison LIGHTS_UBO_BINDING et les texture buffers des lumières
+void LightBuffer::create()
+{
+    ubo.create(sizeof(LightsBlockStd140), LIGHTS_UBO_BINDING);
+    pointLightsBuffer.create(GL_RGBA32F);
+    spotLightsBuffer.create(GL_RGBA32F);
+    clusterDataBuffer.create(GL_RGBA32UI);
+    clusterIndicesBuffer.create(GL_R32UI);
+}
+
+// Définit la lumière directionnelle (envoyée au prochain update)
+void LightBuffer::setDirLight(glm::vec3 direction, glm::vec3 ambient, glm::vec3 diffuse, glm::vec3 specular)
+{
+    block.dirLight.direction = direction;
+    block.dirLight.ambient = ambient;
+    block.dirLight.diffuse = diffuse;
+    block.dirLight.specular = specular;
+    blockDirty = true;
+}
+
+// Envoie un tableau entier dans un texture buffer, ré-alloué (capacité doublée) s'il est trop petit
+template <typename T>
+static void uploadArray(const std::vector<T> &data, TextureBuffer &buffer)
+{
+    GLsizeiptr requiredSize = (GLsizeiptr)(std::max<size_t>(data.size(), 1) * sizeof(T));
+    if (requiredSize > buffer.getSize())
+        buffer.resize(std::max(requiredSize, 2 * buffer.getSize()));
+    if (!data.empty())
+        buffer.update(0, data.size() * sizeof(T), data.data());
+}
+
+// Active le mode clustered et envoie la grille et les listes de lumières des clusters (à appeler avant update)
+void LightBuffer::updateClusters(const ClusterGrid &grid, float framebufferWidth, float framebufferHeight)
+{
+    glm::ivec4 clusterGrid(grid.getTilesX(), grid.getTilesY(), grid.getSlicesZ(), 1);
+    glm::vec4 clusterParams(grid.getSliceScale(), grid.getSliceBias(),
+                            framebufferWidth / grid.getTilesX(), framebufferHeight / grid.getTilesY());
+    if (clusterGrid != block.clusterGrid || clusterParams != block.clusterParams)
+    {
+        block.clusterGrid = clusterGrid;
+        block.clusterParams = clusterParams;
+        blockDirty = true;
+    }
+
+    uploadArray(grid.getClusters(), clusterDataBuffer);
+    uploadArray(grid.getLightIndices(), clusterIndicesBuffer);
+}
+
+// Envoie au GPU la plage contiguë des lumières modifiées depuis le dernier appel et lie les texture buffers
+void LightBuffer::update(std::vector<PointLight> &pointLights, std::vector<SpotLight> &spotLights)
+{
+    if (uploadDirtyLights(pointLights, gpuPointLights, pointLightsBuffer))
+    {
+        block.numPointLights = (int)pointLights.size();
+        blockDirty = true;
+    }
+    if (uploadDirtyLights(spotLights, gpuSpotLights, spotLightsBuffer))
+    {
+        block.numSpotLights = (int)spotLights.size();
+        blockDirty = true;
+    }
+
+    if (blockDirty)
+    {
+        ubo.update(0, sizeof(LightsBlockStd140), &block);
+        blockDirty = false;
+    }
+
+    pointLightsBuffer.bind(POINT_LIGHTS_TEXTURE_UNIT);
+    spotLightsBuffer.bind(SPOT_LIGHTS_TEXTURE_UNIT);
+    if (block.clusterGrid.w != 0)
+    {
+        clusterDataBuffer.bind(CLUSTER_DATA_TEXTURE_UNIT);
+        clusterIndicesBuffer.bind(CLUSTER_INDICES_TEXTURE_UNIT);
+    }
+}
+
+// Relie le bloc Lights et les samplers des texture buffers du shader
+void LightBuffer::bindToShader(Shader &shader) const
+{
+    ubo.bindToShader(shader, "Lights");
+    shader.use();
+    shader.setInt("pointLightData", POINT_LIGHTS_TEXTURE_UNIT);
+    shader.setInt("spotLightData", SPOT_LIGHTS_TEXTURE_UNIT);
+    shader.setInt("clusterData", CLUSTER_DATA_TEXTURE_UNIT);
+    shader.setInt("clusterLightIndices", CLUSTER_INDICES_TEXTURE_UNIT);
+}
+
+// Suppression du UBO et des texture buffers
+void LightBuffer::deleteBuffer()
+{
+    ubo.deleteBuffer();
+    pointLightsBuffer.deleteBuffer();
+    spotLightsBuffer.deleteBuffer();
+    clusterDataBuffer.deleteBuffer();
+    clusterIndicesBuffer.deleteBuffer();
+}
+
+// N'envoie les données de la frame que si elles ont changé depuis la frame précédente
+void FrameDataBuffer::update(const glm::mat4 &view, const glm::mat4 &projection, glm::vec3 viewPos)
+{
+    FrameDataStd140 newData;
+    newData.view = view;
+    newData.projection = projection;
+    newData.viewPos = glm::vec4(viewPos, 1.0f);
+
+    if (uploaded && std::memcmp(&newData, &data, sizeof(FrameDataStd140)) == 0)
+        return;
+
+    data = newData;
+    ubo.update(0, sizeof(FrameDataStd140), &data);
+    uploaded = true;
+}
@@ -0,0 +1,87 @@
+#include "lightMarkers.hpp"
+#include "glState.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <glm/gtc/matrix_transform.hpp>
+
+// Crée le VAO du cube (positions lues dans CubeVertices.txt) et le buffer d'instances
+void LightMarkers::create(const std::vector<float> &cubeVertices)
+{
+    cubeVertexCount = (GLsizei)(cubeVertices.size() / 3);
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &cubeVBO);
+    glGenBuffers(1, &instanceVBO);
+    GLState::bindVertexArray(VAO);
+
+    // Positions du cube, communes à toutes les instances
+    GLState::bindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+    glBufferData(GL_ARRAY_BUFFER, cubeVertices.size() * sizeof(float), cubeVertices.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
+
+    // Matrice de modèle (une colonne par location, de 1 à 4) et couleur (location 5), une valeur par instance
+    GLState::bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    for (int column = 0; column < 4; column++)
+    {
+        glEnableVertexAttribArray(1 + column);
+        glVertexAttribPointer(1 + column, 4, GL_FLOAT, GL_FALSE, sizeof(LightMarkerInstance),
+                              (void *)(offsetof(LightMarkerInstance, model) + column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(1 + column, 1);
+    }
+    glEnableVertexAttribArray(5);
+    glVertexAttribPointer(5, 3, GL_FLOAT, GL_FALSE, sizeof(LightMarkerInstance), (void *)offsetof(LightMarkerInstance, color));
+    glVertexAttribDivisor(5, 1);
+
+    GLState::bindVertexArray(0);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Met à jour les instances des lumières modifiées (seule la plage contiguë qui les contient est envoyée)
+void LightMarkers::update(std::vector<PointLight> &pointLights)
+{
+    GLState::bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+
+    // Si le buffer est trop petit, on le ré-alloue (capacité doublée) et on renvoie toutes les instances
+    bool reallocated = false;
+    if (pointLights.size() > instanceCapacity)
+    {
+        instanceCapacity = std::max(pointLights.size(), 2 * instanceCapacity);
+        glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(LightMarkerInstance), NULL, GL_DYNAMIC_DRAW);
+        reallocated = true;
+    }
+    instances.resize(pointLights.size());
+
+    size_t first = pointLights.size();
+    size_t last = 0;
+    for (size_t i = 0; i < pointLights.size(); i++)
+    {
+        if (!pointLights[i].isDirty() && !reallocated)
+            continue;
+        instances[i].model = glm::translate(glm::mat4(1.0f), pointLights[i].getPosition());
+        instances[i].color = pointLights[i].getCubeRGB();
+        first = std::min(first, i);
+        last = i;
+    }
+
+    if (first <= last && first < pointLights.size())
+        glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(LightMarkerInstance), (last - first + 1) * sizeof(LightMarkerInstance), &instances[first]);
+}
+
+// Dessine tous les cubes avec glDrawArraysInstanced (le shader doit être actif)
+void LightMarkers::draw() const
+{
+    if (instances.empty())
+        return;
+    GLState::bindVertexArray(VAO);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, cubeVertexCount, (GLsizei)instances.size());
+}
+
+// Suppression des buffers et du VAO
+void LightMarkers::deleteResources()
+{
+    GLState::deleteVertexArrays(1, &VAO);
+    GLState::deleteBuffers(1, &cubeVBO);
+    GLState::deleteBuffers(1, &instanceVBO);
+}
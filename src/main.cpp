@@ -11,6 +11,10 @@
 #include <memory>
 #include <regex>
 #include <algorithm>
+#include <random>
+#include <cstring>
+#include <thread>
+#include <chrono>
 
 #include "shader.hpp"
 #include "constants.hpp"
@@ -19,6 +23,24 @@
 #include "gameObject.hpp"
 #include "spotLight.hpp"
 #include "pointLight.hpp"
+#include "lightBuffer.hpp"
+#include "clusterGrid.hpp"
+#include "deferredRenderer.hpp"
+#include "lightMarkers.hpp"
+#include "instancedRenderer.hpp"
+#include "geometryPool.hpp"
+#include "glState.hpp"
+#include "programCache.hpp"
+#include "profiler.hpp"
+#include "shaderVariants.hpp"
+#include "scene.hpp"
+#include "occlusionBuffer.hpp"
+#include "benchmark.hpp"
+#include "cameraPath.hpp"
+#include "inputRecorder.hpp"
+#include "glTrace.hpp"
+#include "assetCache.hpp"
+#include "jobSystem.hpp"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -26,8 +48,8 @@
 // Caméra
 Camera camera(CAMERA_START_POSITION);
 
-// Shader pour les objets, initialisé plus tard dans le main()
-Shader objectShader;
+// Variantes du shader des objets, créées plus tard dans le main() (le programme complet sert aux GameObjects)
+ShaderVariants objectShaders;
 
 // Temps pour une itération de la boucle de rendu
 float deltaTime = 0.0f;
@@ -39,7 +61,8 @@ bool firstMouse = true;
 float lastX;
 float lastY;
 
-std::vector<std::unique_ptr<GameObject>> gameObjects;
+// GameObjects de la scène, rangés dans une BVH pour le culling, l'éclairage et la sélection
+Scene scene;
 
 // Tableau de positions des PointLights
 std::vector<glm::vec3> pointLightPositions;
@@ -50,17 +73,48 @@ std::vector<PointLight> pointLights;
 // Tableau de SpotLights
 std::vector<SpotLight> spotLights;
 
+// UBO des données de la frame (vue, projection, position de la caméra), partagé par tous les shaders
+FrameDataBuffer frameDataBuffer;
+
+// UBO des lumières de la scène
+LightBuffer lightBuffer;
+
+// Grille de clusters du mode "--clustered" et volumes d'influence des lumières
+ClusterGrid clusterGrid(CLUSTER_GRID_X, CLUSTER_GRID_Y, CLUSTER_GRID_Z);
+std::vector<LightVolume> pointLightVolumes;
+std::vector<LightVolume> spotLightVolumes;
+
+// Rendu deferred du mode "--deferred"
+DeferredRenderer deferredRenderer;
+
+// Taille actuelle du framebuffer de la fenêtre
+float framebufferWidth = WINDOW_WIDTH;
+float framebufferHeight = WINDOW_HEIGHT;
+
 // Tableau des vertices pour LightCubes
 std::vector<float> lightCubesVertices;
 
+// Cubes des PointLights, dessinés en un seul appel instancié
+LightMarkers lightMarkers;
+
+// Dessine les GameObjects regroupés par modèle (un appel instancié par mesh)
+InstancedRenderer instancedRenderer;
+
+// Sommets et indices partagés par les meshes du mode "--geometry-pool"
+GeometryPool geometryPool;
+
+// Entrées enregistrées ("--record-input") ou rejouées ("--replay-input") à la place du clavier, de la souris et de la console
+InputRecorder inputRecorder;
+
 // Variables pour la gestion du clavier
 bool graveAccentKeyPressed = false;
+bool pickingKeyPressed = false;
 
 // Variables pour faire apparaître la souris
 bool mouseHidden = true;
 
-// Définition du motif regex pour les instructions de création d'un gameObject
-std::regex gameObjectCreationPattern(R"(^(\S+)\s+(\S+)\s+(0|1)$)");
+// Définition du motif regex pour les instructions de création d'un gameObject ("occluder" à la fin pour en faire un occulteur)
+std::regex gameObjectCreationPattern(R"(^(\S+)\s+(\S+)\s+(0|1)(\s+occluder)?$)");
 
 // Définition des motifs regex pour les instructions de transformation d'un gameObject
 std::regex translatePattern(R"(t\s+([-\d\.]+)\s+([-\d\.]+)\s+([-\d\.]+))");
@@ -70,7 +124,9 @@ std::regex scalePattern(R"(s\s+([-\d\.]+)\s+([-\d\.]+)\s+([-\d\.]+))");
 // Fonction appelée lors du redimensionnement de la fenêtre
 void framebuffer_size_callback(GLFWwindow *window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
+    framebufferWidth = (float)width;
+    framebufferHeight = (float)height;
 }
 
 void applyTransformations(const std::string &input)
@@ -86,15 +142,13 @@ void applyTransformations(const std::string &input)
     std::string transformations = input.substr(firstSpace + 1);
 
     // Trouver le GameObject par son nom
-    auto it = std::find_if(gameObjects.begin(), gameObjects.end(), [&gameObjectName](const std::unique_ptr<GameObject> &obj)
-                           { return obj->getName() == gameObjectName; });
+    GameObject *gameObject = scene.find(gameObjectName);
 
-    if (it == gameObjects.end())
+    if (!gameObject)
     {
         std::cout << "GameObject '" << gameObjectName << "' non trouve." << std::endl;
         return;
     }
-    auto &gameObject = *it; // Référence au GameObject trouvé
 
     bool transformationApplied = false; // Pour vérifier si une transformation a été appliquée
 
@@ -156,7 +210,8 @@ void loadGameObjects(const char* filePath)
                 std::string objectPath = matches[2];
                 bool flipTextureVertically = matches[3] == "1";
 
-                gameObjects.push_back(std::make_unique<GameObject>(gameObjectName, objectPath, flipTextureVertically, objectShader, gameObjects));
+                GameObject &gameObject = scene.add(std::make_unique<GameObject>(gameObjectName, objectPath, flipTextureVertically, objectShaders.getDefault(), scene));
+                gameObject.setOccluder(matches[4].matched);
             }
             else
             {
@@ -171,7 +226,7 @@ void loadGameObjects(const char* filePath)
 }
 
 // Fonction pour sauvegarder les gameObject dans un fichier .txt
-void saveGameObject(std::string gameObjectName, std::string gameObjectPath, bool flipTextureVertically, const char* filePath)
+void saveGameObject(std::string gameObjectName, std::string gameObjectPath, bool flipTextureVertically, bool occluder, const char* filePath)
 {
     std::ofstream fichier(filePath, std::ios::app); // Ouvrir en mode append
 
@@ -179,7 +234,8 @@ void saveGameObject(std::string gameObjectName, std::string gameObjectPath, bool
     {
         fichier << gameObjectName << " "
                 << gameObjectPath << " "
-                << flipTextureVertically << "\n";
+                << flipTextureVertically
+                << (occluder ? " occluder" : "") << "\n";
         fichier.close();
     }
     else
@@ -188,29 +244,47 @@ void saveGameObject(std::string gameObjectName, std::string gameObjectPath, bool
     }
 }
 
+// Affiche le GameObject visé par la caméra (rayon dans la BVH de la scène) et les GameObjects les plus proches
+void pickGameObject()
+{
+    float distance;
+    GameObject *picked = scene.raycast(camera.getPosition(), camera.getFront(), PICKING_DISTANCE, &distance);
+    if (picked)
+        std::cout << "GameObject vise : " << picked->getName() << " (distance " << distance << ")" << std::endl;
+    else
+        std::cout << "Aucun GameObject vise." << std::endl;
+
+    std::vector<GameObject *> nearest;
+    scene.queryNearest(camera.getPosition(), 3, nearest);
+    std::cout << "GameObjects les plus proches :";
+    for (GameObject *gameObject : nearest)
+        std::cout << " " << gameObject->getName();
+    std::cout << std::endl;
+}
+
 // Fonction appelée lors de l'appui sur une touche du clavier
 void processInput(GLFWwindow *window)
 {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+    if (inputRecorder.getKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 
     // Gestion des déplacements de la caméra avec les touches du clavier
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+    if (inputRecorder.getKey(window, GLFW_KEY_W) == GLFW_PRESS)
         camera.processKeyboard(FORWARD, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+    if (inputRecorder.getKey(window, GLFW_KEY_S) == GLFW_PRESS)
         camera.processKeyboard(BACKWARD, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+    if (inputRecorder.getKey(window, GLFW_KEY_A) == GLFW_PRESS)
         camera.processKeyboard(LEFT, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+    if (inputRecorder.getKey(window, GLFW_KEY_D) == GLFW_PRESS)
         camera.processKeyboard(RIGHT, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS)
+    if (inputRecorder.getKey(window, GLFW_KEY_T) == GLFW_PRESS)
         camera.processKeyboard(UP, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS)
+    if (inputRecorder.getKey(window, GLFW_KEY_G) == GLFW_PRESS)
         camera.processKeyboard(DOWN, deltaTime);
 
 
     // Montrer/Masquer curseur souris
-    if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+    if (inputRecorder.getKey(window, GLFW_KEY_Q) == GLFW_PRESS)
     {
         if(mouseHidden)
         {
@@ -230,7 +304,7 @@ void processInput(GLFWwindow *window)
 
 
     // Menu "²"
-    if (glfwGetKey(window, GLFW_KEY_GRAVE_ACCENT) == GLFW_PRESS && !graveAccentKeyPressed)
+    if (inputRecorder.getKey(window, GLFW_KEY_GRAVE_ACCENT) == GLFW_PRESS && !graveAccentKeyPressed)
     {
         graveAccentKeyPressed = true;
         // Menu principal
@@ -244,7 +318,7 @@ void processInput(GLFWwindow *window)
                   << std::endl;
 
         std::string choice;
-        std::getline(std::cin, choice);
+        inputRecorder.readLine(choice);
 
         if (choice == "1" || choice == "2")
         {
@@ -257,25 +331,30 @@ void processInput(GLFWwindow *window)
                 std::cout << "Pour creer un nouveau GameObject :"
                           << std::endl
                           << "nomDuGameObject path/vers/mon/modele.obj 1 pour inverser verticalement les texture ou 0 pour ne pas les inverser :"
+                          << std::endl
+                          << "(ajoutez occluder a la fin pour que l'objet cache les objets derriere lui)"
                           << std::endl;
 
                 std::string userInput;
-                std::getline(std::cin, userInput);
+                inputRecorder.readLine(userInput);
                 std::smatch matches;
                 if (std::regex_search(userInput, matches, gameObjectCreationPattern))
                 {
                     std::string gameObjectName = matches[1];
                     std::string objectPath = matches[2];
                     bool flipTextureVertically = matches[3] == "1";
+                    bool occluder = matches[4].matched;
 
                     std::cout << "GameObject '" << gameObjectName << "' cree.\n"
                               << "Path: " << objectPath << "\n"
-                              << "Inverser verticalement les textures: " << std::boolalpha << flipTextureVertically << std::endl;
+                              << "Inverser verticalement les textures: " << std::boolalpha << flipTextureVertically << "\n"
+                              << "Occulteur: " << occluder << std::endl;
 
-                    gameObjects.push_back(std::make_unique<GameObject>(gameObjectName, objectPath, flipTextureVertically, objectShader, gameObjects));
+                    GameObject &gameObject = scene.add(std::make_unique<GameObject>(gameObjectName, objectPath, flipTextureVertically, objectShaders.getDefault(), scene));
+                    gameObject.setOccluder(occluder);
 
                     // On sauvegarde le gameObject dans le fichier GameObjectList.txt
-                    saveGameObject(gameObjectName, objectPath, flipTextureVertically, GAMEOBJECT_LIST_PATH);
+                    saveGameObject(gameObjectName, objectPath, flipTextureVertically, occluder, GAMEOBJECT_LIST_PATH);
                 }
                 else
                 {
@@ -290,7 +369,7 @@ void processInput(GLFWwindow *window)
                           << "nomDuGameObject t valeurX valeurY valeurZ r valeurAngle valeurAxeX valeurAxeY valeurAxeZ s valeurX valeurY valeurZ :"
                           << std::endl;
                 string userInput;
-                std::getline(std::cin, userInput);
+                inputRecorder.readLine(userInput);
                 applyTransformations(userInput);
             }
         }
@@ -303,10 +382,21 @@ void processInput(GLFWwindow *window)
             std::cout << "Entree invalide." << std::endl;
         }
     }
-    else if (glfwGetKey(window, GLFW_KEY_GRAVE_ACCENT) == GLFW_RELEASE)
+    else if (inputRecorder.getKey(window, GLFW_KEY_GRAVE_ACCENT) == GLFW_RELEASE)
     {
         graveAccentKeyPressed = false;
     }
+
+    // Sélection du GameObject au centre de l'écran
+    if (inputRecorder.getKey(window, GLFW_KEY_P) == GLFW_PRESS && !pickingKeyPressed)
+    {
+        pickingKeyPressed = true;
+        pickGameObject();
+    }
+    else if (inputRecorder.getKey(window, GLFW_KEY_P) == GLFW_RELEASE)
+    {
+        pickingKeyPressed = false;
+    }
 }
 
 // Fonction appelée lors du déplacement de la souris
@@ -330,12 +420,19 @@ void mouse_callback(GLFWwindow *window, double xposIn, double yposIn)
     lastX = xpos;
     lastY = ypos;
 
+    // Au rejeu, seuls les déplacements enregistrés font tourner la caméra
+    if (inputRecorder.isReplaying())
+        return;
+    inputRecorder.recordMouseMovement(xoffset, yoffset);
     camera.processMouseMovement(xoffset, yoffset);
 }
 
 // Fonction appelée lors du défilement de la molette de la souris
 void scroll_callback(GLFWwindow *window, double xoffset, double yoffset)
 {
+    if (inputRecorder.isReplaying())
+        return;
+    inputRecorder.recordScroll(static_cast<float>(yoffset));
     camera.processMouseScroll(static_cast<float>(yoffset));
 }
 
@@ -523,6 +620,37 @@ void loadSpotLights(std::vector<SpotLight>& vecSpotLights, const char* filePath)
     }
 }
 
+// Fonction pour générer procéduralement des PointLights (mode "--lights N" pour les benchmarks)
+void generatePointLights(std::vector<PointLight>& vecPointLights, int count)
+{
+    // Graine fixe pour que deux lancements génèrent exactement la même scène
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    for (int i = 0; i < count; i++)
+    {
+        glm::vec3 position = STRESS_LIGHTS_AREA_MIN + glm::vec3(unit(generator), unit(generator), unit(generator)) * (STRESS_LIGHTS_AREA_MAX - STRESS_LIGHTS_AREA_MIN);
+        glm::vec3 color(unit(generator), unit(generator), unit(generator));
+        // Atténuation forte pour que chaque lumière n'éclaire que son voisinage
+        vecPointLights.push_back(PointLight(position, color * 0.05f, color, glm::vec3(1.0f), 1.0f, 0.35f, 0.44f, color));
+    }
+}
+
+// Fonction pour calculer les volumes d'influence (sphères) des lumières pour le mode clustered
+// Une lumière dont la sphère ne touche aucun GameObject n'éclaire rien : sa portée est mise à 0 pour l'écarter des clusters
+template <typename Light>
+void buildLightVolumes(std::vector<Light>& lights, std::vector<LightVolume>& volumes)
+{
+    volumes.resize(lights.size());
+    for (size_t i = 0; i < lights.size(); i++)
+    {
+        float range = lights[i].getRange();
+        if (!scene.touchesSphere(lights[i].getPosition(), range))
+            range = 0.0f;
+        volumes[i] = {lights[i].getPosition(), range};
+    }
+}
+
 // Fonction pour charger les vertices de lightCube à partir d'un fichier .txt
 void loadLightCubesVertices(std::vector<float>& vecVertices, const char* filePath)
 {
@@ -549,8 +677,123 @@ void loadLightCubesVertices(std::vector<float>& vecVertices, const char* filePat
 }
 
 
-int main()
+// Affiche les FPS et les compteurs de culling dans le titre de la fenêtre, toutes les STATS_TITLE_INTERVAL secondes
+void updateStatsTitle(GLFWwindow *window, float currentTime, const RenderStats &stats)
+{
+    static float lastUpdate = 0.0f;
+    static int frames = 0;
+    frames++;
+    if (currentTime - lastUpdate < STATS_TITLE_INTERVAL)
+        return;
+
+    std::ostringstream title;
+    title << WINDOW_NAME << " - " << (int)(frames / (currentTime - lastUpdate)) << " FPS"
+          << " - objets : " << stats.visibleObjects << " visibles / " << stats.culledObjects << " elimines"
+          << " - meshes : " << stats.visibleMeshes << " visibles / " << stats.culledMeshes << " elimines"
+          << " - draw calls : " << stats.drawCalls
+          << " (programmes/textures/VAO : " << stats.programSwitches << "/" << stats.textureSwitches << "/" << stats.vertexArraySwitches << ")"
+          << " - variantes : " << stats.shaderVariants
+          << " - triangles : " << stats.triangles << " - LODs :";
+    for (int lod = 0; lod < MESH_LOD_COUNT; lod++)
+        title << (lod == 0 ? " " : "/") << stats.lodHistogram[lod];
+    const GLState::Counters &glCounters = GLState::getCounters();
+    title << " - appels GL : " << glCounters.forwarded << " transmis / " << glCounters.filtered << " filtres";
+    const Mesh::GeometryMemory &geometryMemory = Mesh::getGeometryMemory();
+    title << " - geometrie : " << geometryMemory.packed / 1024 << " Ko (" << geometryMemory.unpacked / 1024 << " Ko non compactee)";
+    if (stats.occludedObjects > 0 || stats.occlusionRasterizeTime > 0.0)
+        title << " - caches : " << stats.occludedObjects << " objets / " << stats.occludedMeshes << " meshes ("
+              << stats.occlusionRasterizeTime << " ms)";
+    glfwSetWindowTitle(window, title.str().c_str());
+    lastUpdate = currentTime;
+    frames = 0;
+}
+
+int main(int argc, char *argv[])
 {
+    // Lecture des options de la ligne de commande
+    int stressLightCount = 0;
+    bool clusteredShading = false;
+    bool deferredShading = false;
+    bool occlusionCulling = false;
+    bool depthPrepass = false;
+    bool useGeometryPool = false;
+    bool multiDrawIndirect = true;
+    bool validateGLState = false;
+    bool shaderCache = true;
+    bool shaderVariants = true;
+    bool profile = false;
+    std::string tracePath;
+    int benchmarkFrames = 0;
+    std::string benchmarkOutput = BENCHMARK_OUTPUT_PATH;
+    std::string recordInputPath;
+    std::string replayInputPath;
+    std::string glTracePath;
+    int glTraceFrames = GL_TRACE_DEFAULT_FRAMES;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--lights") == 0 && i + 1 < argc)
+            stressLightCount = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--clustered") == 0)
+            clusteredShading = true;
+        else if (std::strcmp(argv[i], "--deferred") == 0)
+            deferredShading = true;
+        else if (std::strcmp(argv[i], "--occlusion") == 0)
+            occlusionCulling = true;
+        else if (std::strcmp(argv[i], "--depth-prepass") == 0)
+            depthPrepass = true;
+        else if (std::strcmp(argv[i], "--geometry-pool") == 0)
+            useGeometryPool = true;
+        else if (std::strcmp(argv[i], "--no-mdi") == 0)
+            multiDrawIndirect = false;
+        else if (std::strcmp(argv[i], "--gl-validate") == 0)
+            validateGLState = true;
+        else if (std::strcmp(argv[i], "--no-shader-cache") == 0)
+            shaderCache = false;
+        else if (std::strcmp(argv[i], "--no-shader-variants") == 0)
+            shaderVariants = false;
+        else if (std::strcmp(argv[i], "--profile") == 0)
+            profile = true;
+        else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            profile = true;
+            tracePath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--bench") == 0)
+        {
+            // Nombre de frames mesurées optionnel
+            benchmarkFrames = BENCHMARK_DEFAULT_FRAMES;
+            if (i + 1 < argc && std::atoi(argv[i + 1]) > 0)
+                benchmarkFrames = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--bench-output") == 0 && i + 1 < argc)
+            benchmarkOutput = argv[++i];
+        else if (std::strcmp(argv[i], "--record-input") == 0 && i + 1 < argc)
+            recordInputPath = argv[++i];
+        else if (std::strcmp(argv[i], "--replay-input") == 0 && i + 1 < argc)
+            replayInputPath = argv[++i];
+        else if (std::strcmp(argv[i], "--gl-trace") == 0 && i + 1 < argc)
+        {
+            // Nombre de frames capturées optionnel
+            glTracePath = argv[++i];
+            if (i + 1 < argc && std::atoi(argv[i + 1]) > 0)
+                glTraceFrames = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--replay-trace") == 0 && i + 1 < argc)
+        {
+            // Rejeu d'une trace OpenGL, sans scène ni fenêtre de l'application
+            std::string tracePath = argv[++i];
+            int loopCount = i + 1 < argc ? std::atoi(argv[i + 1]) : 0;
+            return runGLTraceReplay(tracePath, loopCount > 0 ? loopCount : GL_TRACE_REPLAY_LOOPS);
+        }
+        else if (std::strcmp(argv[i], "--half-positions") == 0)
+            Mesh::setPositionEncoding(PositionEncoding::HalfFloat);
+    }
+
+    // Mode "--bench N" : la caméra suit un chemin scripté à pas de temps fixe, les durées des frames sont écrites en JSON
+    bool benchmark = benchmarkFrames > 0;
+    BenchmarkReport benchmarkReport;
+    auto loadStart = std::chrono::steady_clock::now();
+
     // Initialisation de GLFW
     glfwInit();
     // On dit à GLFW qu'on veut utiliser OpenGL 3.3
@@ -558,6 +801,9 @@ int main()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     // On dit à GLFW qu'on veut utiliser le core profile qui ne fournit que les fonctionnalités modernes d'OpenGL
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    // En benchmark, la fenêtre reste cachée : on dessine toujours dans son framebuffer, sans rien afficher
+    if (benchmark)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 
     // Création de la fenêtre GLFW
     GLFWwindow *window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_NAME, NULL, NULL);
@@ -569,6 +815,9 @@ int main()
     }
     // On rend le contexte de la fenêtre actif pour les appels OpenGL
     glfwMakeContextCurrent(window);
+    // Les frames du benchmark ne doivent pas attendre la synchronisation verticale
+    if (benchmark)
+        glfwSwapInterval(0);
 
     // Initialisation de GLAD, ce qui configure les pointeurs de fonctions OpenGL pour qu'on puisse les utiliser
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
@@ -576,53 +825,195 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    auto contextReady = std::chrono::steady_clock::now();
+    // Mode "--gl-trace fichier N" : tous les appels OpenGL sont enregistrés à partir d'ici (voir GLTrace)
+    if (!glTracePath.empty())
+    {
+        int traceWidth, traceHeight;
+        glfwGetFramebufferSize(window, &traceWidth, &traceHeight);
+        GLTrace::start(glTracePath, (GLADloadproc)glfwGetProcAddress, traceWidth, traceHeight, GL_TRACE_FIRST_FRAME, glTraceFrames);
+    }
+    // Les changements d'état passent par GLState, qui part de l'état initial du contexte
+    // ("--gl-validate" : la copie est comparée à l'état réel avec glGet*)
+    GLState::reset();
+    GLState::setValidation(validateGLState);
+    // Les programmes déjà compilés sont relus depuis le disque ("--no-shader-cache" : toujours compilés)
+    // (pendant une capture, les programmes doivent être compilés pour que leurs sources soient dans la trace)
+    ProgramCache::init(shaderCache && !GLTrace::isCapturing() ? SHADER_CACHE_DIRECTORY : "", (GLADloadproc)glfwGetProcAddress);
+    // Mode "--profile" : scopes CPU et requêtes GPU de chaque frame ("--trace" : chronologie des premières frames)
+    Profiler::setEnabled(profile);
+    if (!tracePath.empty())
+        Profiler::startTrace(PROFILER_TRACE_MAX_FRAMES);
 
     // On dit à OpenGL la taille de la fenêtre pour le viewport
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLState::viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+
+    // Le framebuffer peut être plus grand que la fenêtre (écrans haute densité)
+    int initialFramebufferWidth, initialFramebufferHeight;
+    glfwGetFramebufferSize(window, &initialFramebufferWidth, &initialFramebufferHeight);
+    framebufferWidth = (float)initialFramebufferWidth;
+    framebufferHeight = (float)initialFramebufferHeight;
 
     // On appelle la fonction framebuffer_size_callback à chaque fois que la fenêtre est redimensionnée
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
-    objectShader = Shader(OBJECT_VERTEX_SHADER_PATH, OBJECT_FRAGMENT_SHADER_PATH);
-    Shader lightSourceShader(LIGHT_VERTEX_SHADER_PATH, LIGHT_FRAGMENT_SHADER_PATH);
+    // Création des UBO (avant les shaders, qui relient leurs blocs à leurs points de liaison)
+    frameDataBuffer.create();
+    lightBuffer.create();
+    lightBuffer.setDirLight(DIR_LIGHT_DIRECTION, DIR_LIGHT_AMBIENT, DIR_LIGHT_DIFFUSE, DIR_LIGHT_SPECULAR);
+
+    // Chaque variante du shader des objets est reliée aux UBO à sa création. Les uniforms classiques restent
+    // dans l'état du programme : le matériau n'est envoyé qu'une fois.
+    // ("--no-shader-variants" : le programme complet pour tous les matériaux)
+    objectShaders.create(OBJECT_VERTEX_SHADER_PATH, OBJECT_FRAGMENT_SHADER_PATH, [](Shader &shader)
+                         {
+                             frameDataBuffer.bindToShader(shader);
+                             lightBuffer.bindToShader(shader);
+                             shader.use();
+                             shader.setFloat("material.shininess", MATERIAL_SHININESS); });
+    objectShaders.setEnabled(shaderVariants);
+    std::shared_ptr<Shader> lightSourceShader = AssetCache::loadShader(LIGHT_VERTEX_SHADER_PATH, LIGHT_FRAGMENT_SHADER_PATH);
+    // Mode "--depth-prepass" : les meshes gardent aussi leurs positions seules pour la passe de profondeur
+    std::shared_ptr<Shader> depthShader;
+    if (depthPrepass)
+    {
+        depthShader = AssetCache::loadShader(DEPTH_VERTEX_SHADER_PATH, DEPTH_FRAGMENT_SHADER_PATH);
+        Mesh::enablePositionStream(true);
+        instancedRenderer.enableDepthPrepass(depthShader.get());
+    }
+    // Mode "--geometry-pool" : les meshes chargés ensuite partagent un buffer de sommets et d'indices
+    // ("--no-mdi" : glDrawElementsInstancedBaseVertex au lieu de glMultiDrawElementsIndirect)
+    if (useGeometryPool)
+    {
+        geometryPool.create(GEOMETRY_POOL_VERTEX_CAPACITY, GEOMETRY_POOL_INDEX_CAPACITY, depthPrepass,
+                            GLTrace::isCapturing() ? GLTrace::getProcAddress : (GLADloadproc)glfwGetProcAddress);
+        geometryPool.setUseMultiDrawIndirect(multiDrawIndirect);
+        Mesh::setGeometryPool(&geometryPool);
+        instancedRenderer.enableGeometryPool(&geometryPool);
+        std::cout << "Geometry pool : " << (geometryPool.isUsingMultiDrawIndirect() ? "glMultiDrawElementsIndirect" : "glDrawElementsInstancedBaseVertex") << std::endl;
+    }
 
     // Charge les positions des point lights à partir du fhichier CubeVertices.txt
     loadLightCubesVertices(lightCubesVertices, CUBE_VERTICES_PATH);
 
     // On active le test de profondeur
-    glEnable(GL_DEPTH_TEST);
+    GLState::enable(GL_DEPTH_TEST);
 
-    // On active le curseur et on le cache
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-    // On associe la fonction mouse_callback à l'évènement de déplacement de la souris
-    glfwSetCursorPosCallback(window, mouse_callback);
-    // On associe la fonction scroll_callback à l'évènement de roulement de la mollette
-    glfwSetScrollCallback(window, scroll_callback);
-
-    // Création des VBO et VAO
-    unsigned int VBO;
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, lightCubesVertices.size() * sizeof(float), &lightCubesVertices[0], GL_STATIC_DRAW);
-
-    // On crée un VAO pour le cube qui va émettre la lumière, on utilise le même VBO
-    unsigned int lightSourceVAO;
-    glGenVertexArrays(1, &lightSourceVAO);
-    glBindVertexArray(lightSourceVAO);
+    // On active le curseur et on le cache (en benchmark, la caméra ne suit que son chemin)
+    if (!benchmark)
+    {
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        // On associe la fonction mouse_callback à l'évènement de déplacement de la souris
+        glfwSetCursorPosCallback(window, mouse_callback);
+        // On associe la fonction scroll_callback à l'évènement de roulement de la mollette
+        glfwSetScrollCallback(window, scroll_callback);
+    }
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(0);
+    // Création du VAO des cubes des PointLights et de leur buffer d'instances
+    lightMarkers.create(lightCubesVertices);
 
     // Charge les positions des point lights à partir du fhichier PointLightsPositions.txt
     //loadPointLightsPositions(pointLightPositions, POINT_LIGHTS_PATH);
 
-    loadPointLights(pointLights, POINT_LIGHTS_PATH);
+    // En mode "--lights N", les PointLights sont générées au lieu d'être lues dans PointLights.txt
+    if (stressLightCount > 0)
+        generatePointLights(pointLights, stressLightCount);
+    else
+        loadPointLights(pointLights, POINT_LIGHTS_PATH);
 
     loadSpotLights(spotLights, SPOT_LIGHTS_PATH);
 
+    // Les modèles et textures sont lus et décodés sur les autres coeurs, puis envoyés au GPU par petites tâches à chaque frame
+    unsigned int coreCount = std::thread::hardware_concurrency();
+    JobSystem jobSystem(coreCount > 1 ? coreCount - 1 : 1);
+    MainThreadQueue uploadQueue;
+    AssetCache::enableAsyncLoading(jobSystem, uploadQueue);
+    // Cube dessiné à la place des objets tant que leur modèle n'est pas prêt
+    instancedRenderer.createPlaceholder();
+    // Mode "--occlusion" : les GameObjects marqués "occluder" cachent ceux qui sont derrière eux
+    OcclusionBuffer occlusionBuffer(OCCLUSION_BUFFER_WIDTH, OCCLUSION_BUFFER_HEIGHT);
+    if (occlusionCulling)
+        instancedRenderer.enableOcclusionCulling(&occlusionBuffer, coreCount);
+
     // Charge les gameObjects à partir du fichier GameObjectList.txt
     loadGameObjects(GAMEOBJECT_LIST_PATH);
 
+    // La Spot Light de la caméra occupe spotLights[0], sa position et sa direction sont mises à jour à chaque frame
+    spotLights.insert(spotLights.begin(), SpotLight(camera.getPosition(), camera.getFront(), glm::vec3(0.0f), glm::vec3(1.0f), glm::vec3(1.0f),
+                                                    1.0f, 0.09f, 0.032f, CAMERA_SPOT_LIGHT_CUTOFF, CAMERA_SPOT_LIGHT_OUTER_CUTOFF));
+
+    // Le nombre de lumières est maintenant connu : les variantes des matériaux pour cet éclairage sont compilées ensemble
+    objectShaders.setLighting((int)pointLights.size(), (int)spotLights.size(), clusteredShading);
+    if (!deferredShading)
+        objectShaders.prepare();
+
+    // Liaison des blocs aux autres shaders
+    frameDataBuffer.bindToShader(*lightSourceShader);
+    if (depthShader)
+        frameDataBuffer.bindToShader(*depthShader);
+
+    // Le mode de rendu (forward ou deferred) est choisi au lancement
+    if (deferredShading)
+        deferredRenderer.create((int)framebufferWidth, (int)framebufferHeight, frameDataBuffer, lightBuffer, shaderVariants);
+    // Programmes attendus au démarrage (les variantes encore en compilation sont comptées quand elles sont prêtes)
+    ProgramCache::printStats();
+
+    // En benchmark, toutes les frames mesurées voient la scène complète : on attend la fin des chargements
+    CameraPath cameraPath;
+    int benchmarkFrame = 0;
+    if (benchmark)
+    {
+        while (jobSystem.pendingCount() > 0 || uploadQueue.pendingCount() > 0)
+        {
+            uploadQueue.process(ASSET_UPLOAD_BUDGET_MS);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        // Les frames mesurées dessinent avec les vraies variantes, pas avec le programme complet qui les remplace
+        objectShaders.finish();
+        if (deferredShading)
+            deferredRenderer.getGeometryShaders().finish();
+        glFinish();
+        scene.update();
+        const ProgramCache::Stats &programStats = ProgramCache::getStats();
+        benchmarkReport.addLoadTime("contexte", std::chrono::duration<double, std::milli>(contextReady - loadStart).count());
+        benchmarkReport.addLoadTime("shaders", programStats.loadTime + programStats.submitTime + programStats.waitTime);
+        benchmarkReport.addLoadTime("total", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count());
+
+        if (!cameraPath.load(CAMERA_PATH_PATH))
+            cameraPath.makeOrbit(glm::vec3(0.0f), 8.0f, 2.0f, 8);
+        benchmarkReport.setConfiguration("renderer", (const char *)glGetString(GL_RENDERER));
+        benchmarkReport.setConfiguration("version", (const char *)glGetString(GL_VERSION));
+        benchmarkReport.setConfiguration("resolution", std::to_string((int)framebufferWidth) + "x" + std::to_string((int)framebufferHeight));
+        benchmarkReport.setConfiguration("rendu", deferredShading ? "deferred" : (clusteredShading ? "clustered" : "forward"));
+        benchmarkReport.setConfiguration("occlusion", occlusionCulling ? "oui" : "non");
+        benchmarkReport.setConfiguration("depthPrepass", depthPrepass ? "oui" : "non");
+        benchmarkReport.setConfiguration("geometryPool", useGeometryPool ? (multiDrawIndirect ? "mdi" : "baseVertex") : "non");
+        benchmarkReport.setConfiguration("shaderVariants", shaderVariants ? "oui" : "non");
+        benchmarkReport.setConfiguration("pointLights", std::to_string(pointLights.size()));
+        benchmarkReport.setConfiguration("gameObjects", std::to_string(scene.size()));
+        benchmarkReport.setConfiguration("geometrieKo", std::to_string(Mesh::getGeometryMemory().packed / 1024));
+        benchmarkReport.setConfiguration("geometrieNonCompacteeKo", std::to_string(Mesh::getGeometryMemory().unpacked / 1024));
+        benchmarkReport.setConfiguration("frames", std::to_string(benchmarkFrames));
+        benchmarkReport.setConfiguration("pasDeTemps", std::to_string(BENCHMARK_TIMESTEP));
+        benchmarkReport.setConfiguration("camera", replayInputPath.empty() ? CAMERA_PATH_PATH : replayInputPath);
+        std::cout << "Benchmark : " << BENCHMARK_WARMUP_FRAMES << " frames de chauffe puis " << benchmarkFrames << " frames mesurees" << std::endl;
+    }
+
+    // Mode "--record-input fichier" : les entrées de la session sont enregistrées à partir de la première frame.
+    // Mode "--replay-input fichier" : elles remplacent les entrées réelles, sur un pas de temps fixe
+    // (avec "--bench", la caméra suit l'enregistrement au lieu de son chemin)
+    if (!replayInputPath.empty() && inputRecorder.startReplay(replayInputPath, benchmark ? BENCHMARK_TIMESTEP : INPUT_REPLAY_TIMESTEP))
+    {
+        inputRecorder.setPointerHandlers([](float xoffset, float yoffset)
+                                         { camera.processMouseMovement(xoffset, yoffset); },
+                                         [](float yoffset)
+                                         { camera.processMouseScroll(yoffset); });
+    }
+    else if (!recordInputPath.empty())
+    {
+        inputRecorder.startRecording(recordInputPath);
+    }
+
     // Boucle de rendu
     while (!glfwWindowShouldClose(window))
     {
@@ -630,9 +1021,39 @@ int main()
         float currentFrame = glfwGetTime();
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
+        auto frameStart = std::chrono::steady_clock::now();
+        GLState::resetCounters();
+        PROFILE_BEGIN_FRAME();
+
+        {
+            PROFILE_SCOPE("input");
+            if (benchmark && !inputRecorder.isReplaying())
+            {
+                // Pas de temps fixe : la frame N montre toujours la même vue, quelle que soit la machine
+                deltaTime = BENCHMARK_TIMESTEP;
+                glm::vec3 position, target;
+                cameraPath.sample(benchmarkFrame * BENCHMARK_TIMESTEP / BENCHMARK_PATH_DURATION, position, target);
+                camera.setPose(position, target);
+            }
+            else
+            {
+                // Le rejeu se termine avec l'enregistrement
+                if (!inputRecorder.beginFrame(window))
+                    glfwSetWindowShouldClose(window, true);
+                if (inputRecorder.isReplaying())
+                    deltaTime = inputRecorder.getTimestep();
+                // On traite un éventuel appui sur une touche (ici, ECHAP pour fermer la fenêtre)
+                processInput(window);
+            }
+        }
 
-        // On traite un éventuel appui sur une touche (ici, ECHAP pour fermer la fenêtre)
-        processInput(window);
+        {
+            PROFILE_GPU_SCOPE("asset uploads");
+            // Envoi au GPU des assets chargés en arrière-plan, sans dépasser le budget de la frame
+            uploadQueue.process(ASSET_UPLOAD_BUDGET_MS);
+            // Les GameObjects déplacés ou chargés pendant la frame sont remis à jour dans la BVH
+            scene.update();
+        }
 
         // On nettoie la couleur du buffer d'écran et on la remplit avec la couleur de fond
         glClearColor(CLEAR_COLOR.r, CLEAR_COLOR.g, CLEAR_COLOR.b, CLEAR_COLOR.a);
@@ -641,108 +1062,141 @@ int main()
 
         // Rendu de l'objet qui va réfléchir la lumière
 
-        // On utilise le shader program de l'objet qui va réfléchir la lumière
-        objectShader.use();
-        // On envoie les valeurs des couleurs de l'objet et de la lumière au shader via les uniform
-        glUniform3f(glGetUniformLocation(objectShader.ID, "material.ambient"), 0.1f, 0.1f, 0.1f);
-        glUniform1f(glGetUniformLocation(objectShader.ID, "material.shininess"), 32.0f);
-
-        // Uniforms de la lumière directionnelle
-        glUniform3f(glGetUniformLocation(objectShader.ID, "dirLight.direction"), -0.2f, -1.0f, -0.3f);
-        glUniform3f(glGetUniformLocation(objectShader.ID, "dirLight.ambient"), 0.05f, 0.05f, 0.05f);
-        glUniform3f(glGetUniformLocation(objectShader.ID, "dirLight.diffuse"), 0.4f, 0.4f, 0.4f);
-        glUniform3f(glGetUniformLocation(objectShader.ID, "dirLight.specular"), 0.5f, 0.5f, 0.5f);
+        // La Spot Light de la caméra suit la caméra
+        spotLights[0].setPosition(camera.getPosition());
+        spotLights[0].setDirection(camera.getFront());
 
+        // On calcule les matrices de transformation de la scène
+        glm::mat4 view = camera.getViewMatrix();
+        // On prend en compte le FOV de la caméra pour la matrice de projection
+        glm::mat4 projection = glm::perspective(glm::radians(camera.getZoom()), WINDOW_WIDTH / WINDOW_HEIGHT, NEAR_CLIP_PLANE_DISTANCE, FAR_CLIP_PLANE_DISTANCE);
+        // Les objets et meshes hors du frustum ne sont pas dessinés, les LODs dépendent de la distance à la caméra
+        RenderView renderView = {camera.getFrustum(projection), projection * view, camera.getPosition(), projection[1][1]};
 
-        /// Point Lights
-        for (unsigned int i = 0; i < pointLights.size(); i++)
+        if (clusteredShading)
         {
-            glUniform3f(glGetUniformLocation(objectShader.ID, ("pointLights[" + to_string(i) + "].position").c_str()), pointLights[i].getPosition().x, pointLights[i].getPosition().y, pointLights[i].getPosition().z);
-            glUniform3f(glGetUniformLocation(objectShader.ID, ("pointLights[" + to_string(i) + "].ambient").c_str()),  pointLights[i].getAmbient().r, pointLights[i].getAmbient().g, pointLights[i].getAmbient().b);
-            glUniform3f(glGetUniformLocation(objectShader.ID, ("pointLights[" + to_string(i) + "].diffuse").c_str()), pointLights[i].getDiffuse().r, pointLights[i].getDiffuse().g, pointLights[i].getDiffuse().b);
-            glUniform3f(glGetUniformLocation(objectShader.ID, ("pointLights[" + to_string(i) + "].specular").c_str()), pointLights[i].getSpecular().r, pointLights[i].getSpecular().g, pointLights[i].getSpecular().b);
-            glUniform1f(glGetUniformLocation(objectShader.ID, ("pointLights[" + to_string(i) + "].constant").c_str()), pointLights[i].getConstant());
-            glUniform1f(glGetUniformLocation(objectShader.ID, ("pointLights[" + to_string(i) + "].linear").c_str()), pointLights[i].getLinear());
-            glUniform1f(glGetUniformLocation(objectShader.ID, ("pointLights[" + to_string(i) + "].quadratic").c_str()), pointLights[i].getQuadratic());
+            PROFILE_SCOPE("light clusters");
+            // On répartit les lumières dans les clusters du frustum (sur tous les coeurs du CPU)
+            clusterGrid.setProjection(glm::radians(camera.getZoom()), WINDOW_WIDTH / WINDOW_HEIGHT, NEAR_CLIP_PLANE_DISTANCE, FAR_CLIP_PLANE_DISTANCE);
+            buildLightVolumes(pointLights, pointLightVolumes);
+            buildLightVolumes(spotLights, spotLightVolumes);
+            clusterGrid.build(view, pointLightVolumes, spotLightVolumes, std::thread::hardware_concurrency());
+            lightBuffer.updateClusters(clusterGrid, framebufferWidth, framebufferHeight);
+        }
+        {
+            PROFILE_GPU_SCOPE("uniform upload");
+            // On n'envoie que les lumières modifiées depuis la frame précédente
+            // (les cubes d'abord : LightBuffer::update remet les lumières à l'état "propre")
+            lightMarkers.update(pointLights);
+            lightBuffer.update(pointLights, spotLights);
+            // Un seul envoi pour tous les shaders qui utilisent le bloc FrameData
+            frameDataBuffer.update(view, projection, camera.getPosition());
         }
 
+        if (deferredShading)
+        {
+            // Rendu deferred : passe géométrie dans le G-buffer, puis éclairage une fois par pixel
+            {
+                PROFILE_GPU_SCOPE("object pass");
+                ShaderVariants &geometryShaders = deferredRenderer.beginGeometryPass((int)framebufferWidth, (int)framebufferHeight);
+                instancedRenderer.draw(scene, geometryShaders, renderView);
+            }
+            deferredRenderer.lightingPass((int)pointLights.size());
+        }
+        else
+        {
+            PROFILE_GPU_SCOPE("object pass");
+            // Les objets visibles qui réfléchissent la lumière, regroupés par mesh
+            instancedRenderer.draw(scene, objectShaders, renderView);
+        }
 
-        // Spot Light de la caméra
-        glUniform3f(glGetUniformLocation(objectShader.ID, "spotLights[0].position"), camera.getPosition().x, camera.getPosition().y, camera.getPosition().z);
-        glUniform3f(glGetUniformLocation(objectShader.ID, "spotLights[0].direction"), camera.getFront().x, camera.getFront().y, camera.getFront().z);
-        glUniform3f(glGetUniformLocation(objectShader.ID, "spotLights[0].ambient"), 0.0f, 0.0f, 0.0f);
-        glUniform3f(glGetUniformLocation(objectShader.ID, "spotLights[0].diffuse"), 1.0f, 1.0f, 1.0f);
-        glUniform3f(glGetUniformLocation(objectShader.ID, "spotLights[0].specular"), 1.0f, 1.0f, 1.0f);
-        glUniform1f(glGetUniformLocation(objectShader.ID, "spotLights[0].constant"), 1.0f);
-        glUniform1f(glGetUniformLocation(objectShader.ID, "spotLights[0].linear"), 0.09f);
-        glUniform1f(glGetUniformLocation(objectShader.ID, "spotLights[0].quadratic"), 0.032f);
-        glUniform1f(glGetUniformLocation(objectShader.ID, "spotLights[0].cosCutOff"), glm::cos(glm::radians(12.5f)));
-        glUniform1f(glGetUniformLocation(objectShader.ID, "spotLights[0].cosOuterCutOff"), glm::cos(glm::radians(15.0f)));
-
-        // Autres Spot Lights
-        for (unsigned int i = 1; i < (spotLights.size()+1); i++)
+        // Rendu des cubes source de lumière
         {
-            glUniform3f(glGetUniformLocation(objectShader.ID, ("spotLights[" + to_string(i) + "].position").c_str()), spotLights[i-1].getPosition().x, spotLights[i-1].getPosition().y, spotLights[i-1].getPosition().z);
-            glUniform3f(glGetUniformLocation(objectShader.ID, ("spotLights[" + to_string(i) + "].direction").c_str()), spotLights[i-1].getDirection().x, spotLights[i-1].getDirection().y, spotLights[i-1].getDirection().z);
-            glUniform3f(glGetUniformLocation(objectShader.ID, ("spotLights[" + to_string(i) + "].ambient").c_str()), spotLights[i-1].getAmbient().r, spotLights[i-1].getAmbient().g, spotLights[i-1].getAmbient().b);
-            glUniform3f(glGetUniformLocation(objectShader.ID, ("spotLights[" + to_string(i) + "].diffuse").c_str()), spotLights[i-1].getDiffuse().r, spotLights[i-1].getDiffuse().g, spotLights[i-1].getDiffuse().b);
-            glUniform3f(glGetUniformLocation(objectShader.ID, ("spotLights[" + to_string(i) + "].specular").c_str()), spotLights[i-1].getSpecular().r, spotLights[i-1].getSpecular().g, spotLights[i-1].getSpecular().b);
-            glUniform1f(glGetUniformLocation(objectShader.ID, ("spotLights[" + to_string(i) + "].constant").c_str()), spotLights[i-1].getConstant());
-            glUniform1f(glGetUniformLocation(objectShader.ID, ("spotLights[" + to_string(i) + "].linear").c_str()), spotLights[i-1].getLinear());
-            glUniform1f(glGetUniformLocation(objectShader.ID, ("spotLights[" + to_string(i) + "].quadratic").c_str()), spotLights[i-1].getQuadratic());
-            glUniform1f(glGetUniformLocation(objectShader.ID, ("spotLights[" + to_string(i) + "].cosCutOff").c_str()), spotLights[i-1].getCosCutOff());
-            glUniform1f(glGetUniformLocation(objectShader.ID, ("spotLights[" + to_string(i) + "].cosOuterCutOff").c_str()), spotLights[i-1].getCosOuterCutOff());
+            PROFILE_GPU_SCOPE("light markers");
+            // Les matrices de vue et de projection viennent du bloc FrameData, comme pour les objets
+            lightSourceShader->use();
+
+            // Tous les cubes source de lumière en un seul appel, avec les matrices et couleurs du buffer d'instances
+            lightMarkers.draw();
         }
 
-        glUniform3f(glGetUniformLocation(objectShader.ID, "viewPos"), camera.getPosition().x, camera.getPosition().y, camera.getPosition().z);
+        // Mode "--gl-validate" : la copie de l'état OpenGL doit correspondre à l'état réel à la fin de chaque frame
+        if (GLState::isValidating())
+            GLState::validate();
 
-        // On calcule les matrices de transformation de la scène
-        glm::mat4 view = camera.getViewMatrix();
-        glUniformMatrix4fv(glGetUniformLocation(objectShader.ID, "view"), 1, GL_FALSE, glm::value_ptr(view));
+        // Statistiques de la frame dans le titre de la fenêtre (rafraîchies deux fois par seconde)
+        if (!benchmark)
+            updateStatsTitle(window, currentFrame, instancedRenderer.getStats());
 
-        // On prend en compte le FOV de la caméra pour la matrice de projection
-        glm::mat4 projection = glm::perspective(glm::radians(camera.getZoom()), WINDOW_WIDTH / WINDOW_HEIGHT, NEAR_CLIP_PLANE_DISTANCE, FAR_CLIP_PLANE_DISTANCE);
-        glUniformMatrix4fv(glGetUniformLocation(objectShader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+        // Fin de la frame pour la capture OpenGL (la dernière frame capturée termine la trace)
+        GLTrace::endFrame();
 
-        for (auto &gameObject : gameObjects)
         {
-            gameObject->Draw();
+            PROFILE_SCOPE("swap");
+            // On échange les buffers de la fenêtre pour que ce qu'on vient de dessiner soit visible
+            glfwSwapBuffers(window);
+            // On regarde s'il y a des évènements (appui sur une touche, déplacement de la souris, etc.)
+            glfwPollEvents();
         }
+        PROFILE_END_FRAME();
 
-        // Rendu des cubes source de lumière
-
-        lightSourceShader.use();
-        // On utilise les mêmes matrices de vue et de projection que pour le cube qui va réfléchir la lumière
-        glUniformMatrix4fv(glGetUniformLocation(lightSourceShader.ID, "view"), 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(glGetUniformLocation(lightSourceShader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-
-        // Matrice de modèle des sources de lumière
-        glm::mat4 model = glm::mat4(1.0f);
-
-        // On dessine les cubes source de lumière en utilisant le VAO qui leur est associé
-        glBindVertexArray(lightSourceVAO);
-        for (unsigned int i = 0; i < pointLights.size(); i++)
+        if (benchmark)
         {
-            glUniform3f(glGetUniformLocation(lightSourceShader.ID, "lightColor"), pointLights[i].getCubeRGB().r, pointLights[i].getCubeRGB().g, pointLights[i].getCubeRGB().b);
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, pointLights[i].getPosition());
-            // model = glm::scale(model, glm::vec3(0.2f));
-            glUniformMatrix4fv(glGetUniformLocation(lightSourceShader.ID, "model"), 1, GL_FALSE, glm::value_ptr(model));
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            // La frame n'est finie que quand le GPU a tout exécuté
+            glFinish();
+            double frameTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+            if (benchmarkFrame >= BENCHMARK_WARMUP_FRAMES)
+                benchmarkReport.addFrame(frameTime, instancedRenderer.getStats(), GLState::getCounters().forwarded);
+            benchmarkFrame++;
+            if ((int)benchmarkReport.getFrameCount() >= benchmarkFrames)
+                glfwSetWindowShouldClose(window, true);
         }
+    }
 
-        // On échange les buffers de la fenêtre pour que ce qu'on vient de dessiner soit visible
-        glfwSwapBuffers(window);
-        // On regarde s'il y a des évènements (appui sur une touche, déplacement de la souris, etc.)
-        glfwPollEvents();
+    if (benchmark)
+    {
+        benchmarkReport.print();
+        if (benchmarkReport.writeJson(benchmarkOutput))
+            std::cout << "Resultats ecrits dans " << benchmarkOutput << std::endl;
     }
 
-    // Quand la fenêtre est fermée, on libère les ressources
-    glDeleteVertexArrays(1, &lightSourceVAO);
-    glDeleteBuffers(1, &VBO);
-    gameObjects.clear();
-    objectShader.deleteProgram();
-    lightSourceShader.deleteProgram();
+    // Mode "--profile" : durées de chaque scope, et chronologie des dernières frames avec "--trace fichier.json"
+    if (Profiler::isEnabled())
+    {
+        Profiler::flush();
+        Profiler::printReport();
+        if (!tracePath.empty() && Profiler::writeTrace(tracePath))
+            std::cout << "Chronologie ecrite dans " << tracePath << std::endl;
+        Profiler::deleteResources();
+    }
+
+    // Variantes compilées pendant la session et nombre de draws de chacune
+    if (deferredShading)
+        deferredRenderer.getGeometryShaders().printStats();
+    else
+        objectShaders.printStats();
+
+    // Fin de l'enregistrement des entrées et de la capture OpenGL (si la fenêtre a été fermée avant la dernière frame)
+    inputRecorder.stop();
+    GLTrace::stop();
+
+    // Quand la fenêtre est fermée, on arrête les chargements en cours avant de libérer les ressources
+    jobSystem.shutdown();
+    AssetCache::disableAsyncLoading();
+    uploadQueue.clear();
+    instancedRenderer.deleteResources();
+    lightMarkers.deleteResources();
+    frameDataBuffer.deleteBuffer();
+    lightBuffer.deleteBuffer();
+    if (deferredShading)
+        deferredRenderer.deleteResources();
+    // Les modèles, textures et shaders sont libérés avec leur dernier handle
+    scene.clear();
+    if (useGeometryPool)
+        geometryPool.deleteResources();
+    objectShaders.deleteResources();
+    lightSourceShader.reset();
+    depthShader.reset();
 
     // On termine GLFW
     glfwTerminate();
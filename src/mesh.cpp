@@ -1,67 +1,319 @@
 #include "mesh.hpp"
+#include "assetCache.hpp"
+#include "glState.hpp"
+#include "shaderVariants.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+PositionEncoding Mesh::positionEncoding = PositionEncoding::Quantized;
+bool Mesh::positionStreamEnabled = false;
+GeometryPool *Mesh::geometryPool = nullptr;
+Mesh::GeometryMemory Mesh::geometryMemory;
+static const std::string MISSING_SPECULAR_SAMPLER = "material.texture_specular1";
 
 Mesh::Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures)
 {
-    this->vertices = vertices;
-    this->indices = indices;
-    this->textures = textures;
+    MeshData data;
+    data.vertices = std::move(vertices);
+    data.indices = std::move(indices);
+    data.textures = std::move(textures);
+    data.vertexData = data.vertices.data();
+    data.vertexCount = data.vertices.size();
+    data.indexData = data.indices.data();
+    data.indexCount = data.indices.size();
+    computeBounds(data);
+    setupMesh(data);
+}
+
+Mesh::Mesh(const Vertex *vertexData, size_t vertexCount, const unsigned int *indexData, size_t indexCount, vector<Texture> textures)
+{
+    MeshData data;
+    data.textures = std::move(textures);
+    data.vertexData = vertexData;
+    data.vertexCount = vertexCount;
+    data.indexData = indexData;
+    data.indexCount = indexCount;
+    computeBounds(data);
+    setupMesh(data);
+}
 
-    setupMesh();
+Mesh::Mesh(MeshData &data)
+{
+    setupMesh(data);
+}
+
+void Mesh::computeBounds(MeshData &data)
+{
+    data.bounds = computeAABB(data.vertexData, data.vertexCount, sizeof(Vertex));
+    data.boundingSphere = computeBoundingSphere(data.vertexData, data.vertexCount, sizeof(Vertex), data.bounds);
 }
 
-void Mesh::setupMesh()
+void Mesh::packMeshData(MeshData &data)
 {
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int),
-                 &indices[0], GL_STATIC_DRAW);
-
-    // Coordonnées des vertices
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
-    // Normales des vertices
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Normal));
-    // Coordonnées de texture des vertices
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, TexCoords));
-
-    glBindVertexArray(0);
+    // Conversion au format compact : positions quantifiées ou en demi-flottants, normales octaédriques, UVs en demi-flottants
+    data.positionDecode = computePositionDecode(positionEncoding, data.bounds);
+    data.packedVertices.resize(data.vertexCount);
+    data.packedPositions.resize(data.vertexCount * 4);
+    for (size_t i = 0; i < data.vertexCount; i++)
+    {
+        PackedVertex &packed = data.packedVertices[i];
+        packPosition(data.vertexData[i].Position, positionEncoding, data.positionDecode, packed.position);
+        packNormal(data.vertexData[i].Normal, packed.normal);
+        packed.texCoords[0] = packHalf(data.vertexData[i].TexCoords.x);
+        packed.texCoords[1] = packHalf(data.vertexData[i].TexCoords.y);
+        // Flux des positions seules : une passe de profondeur ne lit que 8 octets par sommet
+        std::copy(packed.position, packed.position + 4, &data.packedPositions[i * 4]);
+    }
+    data.packedVertexData = data.packedVertices.data();
+    data.positionData = data.packedPositions.data();
+
+    // Indices sur 16 bits si tous les sommets sont adressables
+    if (data.vertexCount <= 65536)
+    {
+        data.shortIndices.assign(data.indexData, data.indexData + data.indexCount);
+        data.packedIndexData = data.shortIndices.data();
+        data.indexSize = sizeof(uint16_t);
+    }
+    else
+    {
+        data.packedIndexData = data.indexData;
+        data.indexSize = sizeof(unsigned int);
+    }
 }
 
-void Mesh::Draw(Shader &shader)
+void Mesh::setupSamplerNames()
 {
-    // Initialisation des indices des maps diffuse et specular pour accéder aux uniforms sampler2D
+    // On récupère le type (texture_diffuse ou texture_specular) et le numéro de chaque texture pour les uniform sampler2D
     unsigned int diffuseNr = 1;
     unsigned int specularNr = 1;
-
-    for (unsigned int i = 0; i < textures.size(); i++)
+    for (unsigned int i = 0; i < this->textures.size(); i++)
     {
-        glActiveTexture(GL_TEXTURE0 + i); // On active la texture avant de la lier
-        // On récupère le type (texture_diffuse ou texture_specular) et le numéro de la texture pour les uniform sampler2D
-        string name = textures[i].type;
+        string name = this->textures[i].type;
         string number;
 
         if (name == "texture_diffuse")
             number = std::to_string(diffuseNr++);
         else if (name == "texture_specular")
+        {
             number = std::to_string(specularNr++);
+            shaderFeatures |= SHADER_FEATURE_SPECULAR_MAP;
+        }
+
+        samplerNames.push_back("material." + name + number);
+    }
+    // Sans texture spéculaire, le programme complet (qui a le sampler) doit lire une spéculaire nulle, comme les variantes
+    if (!(shaderFeatures & SHADER_FEATURE_SPECULAR_MAP))
+        missingSpecular = AssetCache::getBlackTexture();
+
+    // Une même liste de textures (et de samplers) donne le même matériau, donc le même identifiant
+    MaterialKey key;
+    for (unsigned int i = 0; i < this->textures.size(); i++)
+        key.emplace_back(this->textures[i].asset.get(), samplerNames[i]);
+    material = AssetCache::getMaterial(key);
+    materialId = material->id;
+}
+
+void Mesh::setupMesh(MeshData &data)
+{
+    this->textures = std::move(data.textures);
+    bounds = data.bounds;
+    boundingSphere = data.boundingSphere;
+    setupSamplerNames();
+
+    // Seuls les meshes lus par Assimp (ou créés à la main) sont convertis ici : un fichier précompilé est déjà au format compact
+    if (!data.packedVertexData)
+        packMeshData(data);
+    size_t vertexCount = data.vertexCount;
+    size_t indexCount = data.indexCount;
+    positionDecode = data.positionDecode;
+
+    // Sans LODs, le mesh complet est le seul niveau
+    lods = data.lods;
+    if (lods.empty())
+        lods.push_back({0, (unsigned int)indexCount, 0.0f});
+
+    // Taille qu'aurait la géométrie avec des Vertex complets et des indices sur 32 bits, pour mesurer le gain du format compact
+    unpackedMemory = vertexCount * sizeof(Vertex) + indexCount * sizeof(unsigned int);
+
+    indexSize = data.indexSize;
+    indexType = indexSize == sizeof(uint16_t) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    // Les sommets et indices sur 16 bits vont dans le pool partagé s'il reste de la place
+    if (indexType == GL_UNSIGNED_SHORT && geometryPool &&
+        geometryPool->allocate(data.packedVertexData, data.positionData, vertexCount, static_cast<const uint16_t *>(data.packedIndexData),
+                               indexCount, allocation))
+    {
+        pool = geometryPool;
+        gpuMemory = vertexCount * sizeof(PackedVertex) + indexCount * indexSize;
+        if (pool->hasPositionStream())
+            gpuMemory += vertexCount * 4 * sizeof(uint16_t);
+        geometryMemory.packed += gpuMemory;
+        geometryMemory.unpacked += unpackedMemory;
+    }
+    else
+    {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+
+        GLState::bindVertexArray(VAO);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
+
+        glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(PackedVertex), data.packedVertexData, GL_STATIC_DRAW);
+
+        GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * indexSize, data.packedIndexData, GL_STATIC_DRAW);
+
+        // Coordonnées des vertices : unorm16 ramenés entre 0 et 1 par OpenGL, ou demi-flottants
+        glEnableVertexAttribArray(0);
+        if (positionEncoding == PositionEncoding::Quantized)
+            glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, position));
+        else
+            glVertexAttribPointer(0, 3, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, position));
+        // Normales des vertices (snorm16 ramenés entre -1 et 1, décodées dans le vertex shader)
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, normal));
+        // Coordonnées de texture des vertices
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, texCoords));
+
+        glGenBuffers(1, &instanceVBO);
+        pointInstanceAttributes(0);
+        gpuMemory = vertexCount * sizeof(PackedVertex) + indexCount * indexSize;
+
+        if (positionStreamEnabled)
+        {
+            // Flux des positions seules, avec son VAO qui partage l'EBO et le buffer d'instances
+            glGenVertexArrays(1, &depthVAO);
+            glGenBuffers(1, &positionVBO);
+            GLState::bindVertexArray(depthVAO);
+            GLState::bindBuffer(GL_ARRAY_BUFFER, positionVBO);
+            glBufferData(GL_ARRAY_BUFFER, vertexCount * 4 * sizeof(uint16_t), data.positionData, GL_STATIC_DRAW);
+            GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+            glEnableVertexAttribArray(0);
+            if (positionEncoding == PositionEncoding::Quantized)
+                glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, 4 * sizeof(uint16_t), (void *)0);
+            else
+                glVertexAttribPointer(0, 3, GL_HALF_FLOAT, GL_FALSE, 4 * sizeof(uint16_t), (void *)0);
+
+            pointInstanceAttributes(0);
+            gpuMemory += vertexCount * 4 * sizeof(uint16_t);
+        }
+        geometryMemory.packed += gpuMemory;
+        geometryMemory.unpacked += unpackedMemory;
 
-        glUniform1i(glGetUniformLocation(shader.ID, ("material." + name + number).c_str()), i);
-        glBindTexture(GL_TEXTURE_2D, textures[i].id);
+        GLState::bindVertexArray(0);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
     }
-    glActiveTexture(GL_TEXTURE0);
 
-    // On dessine le mesh
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
-}
\ No newline at end of file
+    // Le mesh garde les tableaux de sommets complets (vides pour un fichier précompilé)
+    this->vertices = std::move(data.vertices);
+    this->indices = std::move(data.indices);
+}
+
+unsigned int Mesh::getVertexArray(bool depthOnly) const
+{
+    if (pool)
+        return pool->getVertexArray(depthOnly);
+    return depthOnly ? depthVAO : VAO;
+}
+
+void Mesh::bindTextures(Shader &shader) const
+{
+    for (unsigned int i = 0; i < textures.size(); i++)
+    {
+        shader.setInt(samplerNames[i], i);
+        GLState::bindTexture(i, GL_TEXTURE_2D, textures[i].asset->id);
+    }
+    if (missingSpecular)
+    {
+        // Le sampler n'existe que dans les programmes compilés avec HAS_SPECULAR_MAP
+        GLint location = shader.getUniformLocation(MISSING_SPECULAR_SAMPLER);
+        if (location != -1)
+        {
+            unsigned int unit = (unsigned int)textures.size();
+            shader.setInt(location, unit);
+            GLState::bindTexture(unit, GL_TEXTURE_2D, missingSpecular->id);
+        }
+    }
+}
+
+// Matrices de modèle des instances pour le VAO lié : une mat4 occupe 4 locations consécutives (une colonne par location),
+// avec une valeur par instance, à partir de la matrice firstInstance du buffer d'instances
+void Mesh::pointInstanceAttributes(GLint firstInstance)
+{
+    GLState::bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    size_t base = firstInstance * sizeof(glm::mat4);
+    for (unsigned int column = 0; column < 4; column++)
+    {
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void *)(base + column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(3 + column, 1);
+    }
+}
+
+void Mesh::uploadInstances(const glm::mat4 *modelMatrices, GLsizei instanceCount)
+{
+    GLState::bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    if (instanceCount > instanceCapacity)
+    {
+        // Le buffer est trop petit : on double sa capacité pour ne pas ré-allouer à chaque nouvelle instance
+        instanceCapacity = std::max(instanceCount, 2 * instanceCapacity);
+        glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(glm::mat4), NULL, GL_DYNAMIC_DRAW);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, instanceCount * sizeof(glm::mat4), modelMatrices);
+}
+
+void Mesh::drawInstancesBound(GLint firstInstance, GLsizei instanceCount, int lod, bool depthOnly)
+{
+    // Sans baseInstance (OpenGL 3.3), les attributs d'instance du VAO sont décalés sur la première instance à dessiner.
+    // Chaque VAO garde son décalage : on ne le change que s'il est différent.
+    GLint &boundFirstInstance = depthOnly ? depthFirstInstance : mainFirstInstance;
+    if (boundFirstInstance != firstInstance)
+    {
+        pointInstanceAttributes(firstInstance);
+        boundFirstInstance = firstInstance;
+    }
+
+    // Le décodage des positions est le même pour toutes les instances : valeurs constantes des attributs 7 et 8
+    glVertexAttrib3fv(7, &positionDecode.offset[0]);
+    glVertexAttrib3fv(8, &positionDecode.scale[0]);
+
+    // On dessine toutes les instances du mesh en un seul appel, avec la plage d'indices du LOD
+    const MeshLod &range = getLod(lod);
+    glDrawElementsInstanced(GL_TRIANGLES, range.indexCount, indexType, (void *)(range.firstIndex * indexSize), instanceCount);
+}
+
+void Mesh::DrawInstanced(Shader &shader, const glm::mat4 *modelMatrices, GLsizei instanceCount, int lod)
+{
+    if (instanceCount <= 0)
+        return;
+
+    bindTextures(shader);
+    if (pool)
+    {
+        pool->drawInstanced(*this, lod, modelMatrices, instanceCount, false);
+        return;
+    }
+    uploadInstances(modelMatrices, instanceCount);
+    GLState::bindVertexArray(VAO);
+    drawInstancesBound(0, instanceCount, lod, false);
+}
+
+void Mesh::DrawDepthInstanced(const glm::mat4 *modelMatrices, GLsizei instanceCount, int lod)
+{
+    if (instanceCount <= 0)
+        return;
+    if (pool)
+    {
+        pool->drawInstanced(*this, lod, modelMatrices, instanceCount, true);
+        return;
+    }
+    if (!depthVAO)
+        return;
+    uploadInstances(modelMatrices, instanceCount);
+    GLState::bindVertexArray(depthVAO);
+    drawInstancesBound(0, instanceCount, lod, true);
+}
@@ -0,0 +1,268 @@
+#include "meshOptimizer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+VertexCacheStats analyzeVertexCache(const unsigned int *indices, size_t indexCount, size_t vertexCount, size_t cacheSize)
+{
+    // Date d'entrée de chaque sommet dans le cache FIFO : il y est encore si moins de cacheSize sommets sont entrés depuis
+    std::vector<size_t> entryTime(vertexCount, 0);
+    size_t time = cacheSize + 1;
+    size_t misses = 0;
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        unsigned int vertex = indices[i];
+        if (time - entryTime[vertex] > cacheSize)
+        {
+            entryTime[vertex] = time++;
+            misses++;
+        }
+    }
+
+    VertexCacheStats stats;
+    stats.acmr = indexCount >= 3 ? (float)misses / (indexCount / 3) : 0.0f;
+    stats.atvr = vertexCount > 0 ? (float)misses / vertexCount : 0.0f;
+    return stats;
+}
+
+size_t weldVertices(void *vertices, size_t vertexCount, size_t stride, unsigned int *indices, size_t indexCount)
+{
+    unsigned char *bytes = static_cast<unsigned char *>(vertices);
+    std::unordered_map<std::string, unsigned int> uniqueVertices;
+    uniqueVertices.reserve(vertexCount);
+    std::vector<unsigned int> remap(vertexCount);
+    size_t uniqueCount = 0;
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        std::string key(reinterpret_cast<const char *>(bytes + v * stride), stride);
+        auto inserted = uniqueVertices.emplace(std::move(key), (unsigned int)uniqueCount);
+        remap[v] = inserted.first->second;
+        if (inserted.second)
+        {
+            // Les sommets uniques sont compactés au début du tableau (uniqueCount <= v : on ne lit jamais une zone déjà écrasée)
+            if (uniqueCount != v)
+                std::memcpy(bytes + uniqueCount * stride, bytes + v * stride, stride);
+            uniqueCount++;
+        }
+    }
+    for (size_t i = 0; i < indexCount; i++)
+        indices[i] = remap[indices[i]];
+    return uniqueCount;
+}
+
+void optimizeVertexCache(unsigned int *indices, size_t indexCount, size_t vertexCount, size_t cacheSize)
+{
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+
+    // Triangles autour de chaque sommet et nombre de triangles pas encore émis ("vivants")
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++)
+        offsets[indices[i] + 1]++;
+    for (size_t v = 0; v < vertexCount; v++)
+        offsets[v + 1] += offsets[v];
+    std::vector<unsigned int> adjacency(triangleCount * 3);
+    std::vector<unsigned int> liveTriangles(vertexCount);
+    {
+        std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; i++)
+            adjacency[fill[indices[i]]++] = (unsigned int)(i / 3);
+        for (size_t v = 0; v < vertexCount; v++)
+            liveTriangles[v] = offsets[v + 1] - offsets[v];
+    }
+
+    std::vector<unsigned int> input(indices, indices + triangleCount * 3);
+    std::vector<size_t> cacheTime(vertexCount, 0);
+    std::vector<unsigned char> emitted(triangleCount, 0);
+    std::vector<unsigned int> deadEnds;
+    std::vector<unsigned int> candidates;
+    size_t time = cacheSize + 1;
+    size_t cursor = 0;
+    size_t output = 0;
+
+    // On émet tous les triangles autour d'un sommet ("éventail"), puis on choisit le prochain sommet
+    // parmi ceux qui viennent d'être utilisés et seront encore dans le cache
+    long fanningVertex = 0;
+    while (fanningVertex >= 0)
+    {
+        candidates.clear();
+        for (unsigned int k = offsets[fanningVertex]; k < offsets[fanningVertex + 1]; k++)
+        {
+            unsigned int triangle = adjacency[k];
+            if (emitted[triangle])
+                continue;
+            emitted[triangle] = 1;
+            for (int v = 0; v < 3; v++)
+            {
+                unsigned int vertex = input[triangle * 3 + v];
+                indices[output++] = vertex;
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+                liveTriangles[vertex]--;
+                if (time - cacheTime[vertex] > cacheSize)
+                    cacheTime[vertex] = time++;
+            }
+        }
+
+        // Meilleur candidat : celui qui est dans le cache depuis le plus longtemps, à condition que ses triangles restants
+        // puissent être émis avant qu'il en sorte
+        long best = -1;
+        long bestPriority = -1;
+        for (unsigned int vertex : candidates)
+        {
+            if (liveTriangles[vertex] == 0)
+                continue;
+            long priority = 0;
+            if (time - cacheTime[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+                priority = (long)(time - cacheTime[vertex]);
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                best = vertex;
+            }
+        }
+
+        // Impasse : on revient sur les sommets récemment utilisés, puis sur le premier sommet qui a encore des triangles
+        if (best < 0)
+        {
+            while (!deadEnds.empty() && best < 0)
+            {
+                unsigned int vertex = deadEnds.back();
+                deadEnds.pop_back();
+                if (liveTriangles[vertex] > 0)
+                    best = vertex;
+            }
+            while (best < 0 && cursor < vertexCount)
+            {
+                if (liveTriangles[cursor] > 0)
+                    best = (long)cursor;
+                cursor++;
+            }
+        }
+        fanningVertex = best;
+    }
+}
+
+void optimizeOverdraw(unsigned int *indices, size_t indexCount, const void *vertices, size_t vertexCount, size_t stride, float threshold)
+{
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount < 2)
+        return;
+
+    const unsigned char *bytes = static_cast<const unsigned char *>(vertices);
+    auto position = [&](unsigned int vertex)
+    {
+        glm::vec3 p;
+        std::memcpy(&p, bytes + vertex * stride, sizeof(p));
+        return p;
+    };
+
+    // Découpage en groupes là où un triangle rate ses trois sommets dans le cache : réordonner les groupes
+    // ne coûte alors presque rien en transformations de sommets
+    std::vector<size_t> clusterStarts;
+    {
+        std::vector<size_t> entryTime(vertexCount, 0);
+        size_t time = VERTEX_CACHE_SIZE + 1;
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            int misses = 0;
+            for (int v = 0; v < 3; v++)
+            {
+                unsigned int vertex = indices[t * 3 + v];
+                if (time - entryTime[vertex] > VERTEX_CACHE_SIZE)
+                {
+                    entryTime[vertex] = time++;
+                    misses++;
+                }
+            }
+            if (t == 0 || misses == 3)
+                clusterStarts.push_back(t);
+        }
+    }
+    if (clusterStarts.size() < 2)
+        return;
+
+    // Centre du mesh, puis clé de chaque groupe : un groupe dont la normale moyenne s'éloigne du centre est dessiné en premier
+    glm::vec3 meshCenter(0.0f);
+    float meshArea = 0.0f;
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        glm::vec3 p0 = position(indices[t * 3]), p1 = position(indices[t * 3 + 1]), p2 = position(indices[t * 3 + 2]);
+        float area = glm::length(glm::cross(p1 - p0, p2 - p0));
+        meshCenter += (p0 + p1 + p2) * (area / 3.0f);
+        meshArea += area;
+    }
+    if (meshArea > 0.0f)
+        meshCenter /= meshArea;
+
+    struct Cluster
+    {
+        size_t first, count;
+        float key;
+    };
+    std::vector<Cluster> clusters;
+    for (size_t c = 0; c < clusterStarts.size(); c++)
+    {
+        Cluster cluster;
+        cluster.first = clusterStarts[c];
+        cluster.count = (c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : triangleCount) - cluster.first;
+        glm::vec3 center(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for (size_t t = cluster.first; t < cluster.first + cluster.count; t++)
+        {
+            glm::vec3 p0 = position(indices[t * 3]), p1 = position(indices[t * 3 + 1]), p2 = position(indices[t * 3 + 2]);
+            glm::vec3 weightedNormal = glm::cross(p1 - p0, p2 - p0);
+            float triangleArea = glm::length(weightedNormal);
+            center += (p0 + p1 + p2) * (triangleArea / 3.0f);
+            normal += weightedNormal;
+            area += triangleArea;
+        }
+        if (area > 0.0f)
+            center /= area;
+        float normalLength = glm::length(normal);
+        cluster.key = normalLength > 0.0f ? glm::dot(center - meshCenter, normal / normalLength) : 0.0f;
+        clusters.push_back(cluster);
+    }
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster &a, const Cluster &b)
+                     { return a.key > b.key; });
+
+    std::vector<unsigned int> reordered;
+    reordered.reserve(triangleCount * 3);
+    for (const Cluster &cluster : clusters)
+        reordered.insert(reordered.end(), indices + cluster.first * 3, indices + (cluster.first + cluster.count) * 3);
+
+    // On garde l'ordre d'origine si le nouvel ordre dégrade trop le cache
+    float before = analyzeVertexCache(indices, triangleCount * 3, vertexCount).acmr;
+    float after = analyzeVertexCache(reordered.data(), reordered.size(), vertexCount).acmr;
+    if (after <= before * threshold)
+        std::copy(reordered.begin(), reordered.end(), indices);
+}
+
+size_t optimizeVertexFetch(void *vertices, size_t vertexCount, size_t stride, unsigned int *indices, size_t indexCount)
+{
+    const unsigned int unused = ~0u;
+    std::vector<unsigned int> remap(vertexCount, unused);
+    unsigned int nextVertex = 0;
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        unsigned int &target = remap[indices[i]];
+        if (target == unused)
+            target = nextVertex++;
+        indices[i] = target;
+    }
+
+    unsigned char *bytes = static_cast<unsigned char *>(vertices);
+    std::vector<unsigned char> reordered((size_t)nextVertex * stride);
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        if (remap[v] != unused)
+            std::memcpy(reordered.data() + (size_t)remap[v] * stride, bytes + v * stride, stride);
+    }
+    std::memcpy(bytes, reordered.data(), reordered.size());
+    return nextVertex;
+}
@@ -0,0 +1,253 @@
+#include "meshSimplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+// Quadrique symétrique 4x4 (10 coefficients) : somme des carrés des distances à un ensemble de plans
+struct Quadric
+{
+    double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+    double a11 = 0, a12 = 0, a13 = 0;
+    double a22 = 0, a23 = 0;
+    double a33 = 0;
+
+    void addPlane(const glm::dvec3 &normal, double distance)
+    {
+        a00 += normal.x * normal.x, a01 += normal.x * normal.y, a02 += normal.x * normal.z, a03 += normal.x * distance;
+        a11 += normal.y * normal.y, a12 += normal.y * normal.z, a13 += normal.y * distance;
+        a22 += normal.z * normal.z, a23 += normal.z * distance;
+        a33 += distance * distance;
+    }
+
+    void add(const Quadric &other)
+    {
+        a00 += other.a00, a01 += other.a01, a02 += other.a02, a03 += other.a03;
+        a11 += other.a11, a12 += other.a12, a13 += other.a13;
+        a22 += other.a22, a23 += other.a23;
+        a33 += other.a33;
+    }
+
+    // Somme des carrés des distances du point aux plans
+    double evaluate(const glm::vec3 &p) const
+    {
+        double x = p.x, y = p.y, z = p.z;
+        double value = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x +
+                       a11 * y * y + 2 * a12 * y * z + 2 * a13 * y +
+                       a22 * z * z + 2 * a23 * z + a33;
+        return std::max(value, 0.0);
+    }
+};
+
+struct Collapse
+{
+    unsigned int from;
+    unsigned int to;
+    double cost;
+};
+
+struct PositionHash
+{
+    size_t operator()(const glm::vec3 &p) const
+    {
+        return std::hash<float>()(p.x) ^ (std::hash<float>()(p.y) * 31) ^ (std::hash<float>()(p.z) * 961);
+    }
+};
+}
+
+float simplifyMesh(const void *vertices, size_t vertexCount, size_t stride,
+                   const unsigned int *indices, size_t indexCount, size_t targetIndexCount,
+                   std::vector<unsigned int> &result)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(vertices);
+    auto position = [&](unsigned int vertex)
+    {
+        glm::vec3 p;
+        std::memcpy(&p, bytes + vertex * stride, sizeof(p));
+        return p;
+    };
+
+    // 1. Sommets identiques (position et attributs) fusionnés : canonical[v] est le premier sommet égal à v
+    std::vector<unsigned int> canonical(vertexCount);
+    {
+        std::unordered_map<std::string, unsigned int> firstVertex;
+        firstVertex.reserve(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            std::string key(reinterpret_cast<const char *>(bytes + v * stride), stride);
+            canonical[v] = firstVertex.emplace(std::move(key), (unsigned int)v).first->second;
+        }
+    }
+    result.resize(indexCount);
+    for (size_t i = 0; i < indexCount; i++)
+        result[i] = canonical[indices[i]];
+
+    // 2. Sommets bloqués : position partagée par des sommets d'attributs différents (couture), ou bord d'une surface ouverte
+    std::vector<unsigned char> locked(vertexCount, 0);
+    std::vector<unsigned int> positionId(vertexCount);
+    {
+        std::unordered_map<glm::vec3, unsigned int, PositionHash> firstAtPosition;
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            unsigned int vertex = result[i];
+            auto inserted = firstAtPosition.emplace(position(vertex), vertex);
+            positionId[vertex] = inserted.first->second;
+            if (inserted.first->second != vertex)
+            {
+                locked[vertex] = 1;
+                locked[inserted.first->second] = 1;
+            }
+        }
+
+        // Une arête (entre positions) qui n'appartient qu'à un triangle est un bord
+        std::unordered_map<unsigned long long, int> edgeCounts;
+        for (size_t t = 0; t + 2 < indexCount; t += 3)
+        {
+            for (int e = 0; e < 3; e++)
+            {
+                unsigned long long a = positionId[result[t + e]], b = positionId[result[t + (e + 1) % 3]];
+                edgeCounts[std::min(a, b) << 32 | std::max(a, b)]++;
+            }
+        }
+        for (size_t t = 0; t + 2 < indexCount; t += 3)
+        {
+            for (int e = 0; e < 3; e++)
+            {
+                unsigned int a = result[t + e], b = result[t + (e + 1) % 3];
+                unsigned long long pa = positionId[a], pb = positionId[b];
+                if (edgeCounts[std::min(pa, pb) << 32 | std::max(pa, pb)] == 1)
+                    locked[a] = locked[b] = 1;
+            }
+        }
+    }
+
+    // 3. Quadrique de chaque sommet : plans de tous les triangles qui l'entourent
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t t = 0; t + 2 < indexCount; t += 3)
+    {
+        glm::dvec3 p0 = position(result[t]), p1 = position(result[t + 1]), p2 = position(result[t + 2]);
+        glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+        double length = glm::length(normal);
+        if (length <= 0.0)
+            continue;
+        normal /= length;
+        Quadric plane;
+        plane.addPlane(normal, -glm::dot(normal, p0));
+        for (int v = 0; v < 3; v++)
+            quadrics[result[t + v]].add(plane);
+    }
+
+    // 4. Passes de fusion : à chaque passe, on trie les arêtes par coût et on fusionne les moins chères
+    // sans toucher deux fois la même région, jusqu'à atteindre le nombre d'indices visé
+    double maxError = 0.0;
+    std::vector<Collapse> collapses;
+    std::vector<unsigned int> triangleOffsets(vertexCount + 1);
+    std::vector<unsigned int> vertexTriangles;
+    std::vector<unsigned char> touched(vertexCount);
+    while (result.size() > targetIndexCount)
+    {
+        size_t triangleCount = result.size() / 3;
+
+        collapses.clear();
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            for (int e = 0; e < 3; e++)
+            {
+                unsigned int a = result[t * 3 + e], b = result[t * 3 + (e + 1) % 3];
+                Quadric combined = quadrics[a];
+                combined.add(quadrics[b]);
+                if (!locked[a])
+                    collapses.push_back({a, b, combined.evaluate(position(b))});
+                if (!locked[b])
+                    collapses.push_back({b, a, combined.evaluate(position(a))});
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse &x, const Collapse &y)
+                  { return x.cost < y.cost; });
+
+        // Triangles autour de chaque sommet (format compact : triangleOffsets[v] .. triangleOffsets[v + 1])
+        std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+        for (unsigned int vertex : result)
+            triangleOffsets[vertex + 1]++;
+        for (size_t v = 0; v < vertexCount; v++)
+            triangleOffsets[v + 1] += triangleOffsets[v];
+        vertexTriangles.resize(result.size());
+        {
+            std::vector<unsigned int> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+            for (size_t i = 0; i < result.size(); i++)
+                vertexTriangles[fill[result[i]]++] = (unsigned int)(i / 3);
+        }
+
+        // Chaque fusion supprime environ deux triangles
+        size_t wantedCollapses = (result.size() - targetIndexCount) / 6 + 1;
+        size_t collapseCount = 0;
+        std::fill(touched.begin(), touched.end(), 0);
+        std::vector<unsigned int> remap;
+        remap.reserve(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+            remap.push_back((unsigned int)v);
+
+        for (const Collapse &collapse : collapses)
+        {
+            if (collapseCount >= wantedCollapses)
+                break;
+            if (touched[collapse.from] || touched[collapse.to])
+                continue;
+
+            // Refus si un triangle autour de "from" se retourne ou tourne trop (les normales de la surface seraient faussées)
+            glm::vec3 target = position(collapse.to);
+            bool valid = true;
+            for (unsigned int k = triangleOffsets[collapse.from]; k < triangleOffsets[collapse.from + 1] && valid; k++)
+            {
+                const unsigned int *triangle = &result[vertexTriangles[k] * 3];
+                if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to)
+                    continue;
+                glm::vec3 before[3], after[3];
+                for (int v = 0; v < 3; v++)
+                {
+                    before[v] = position(triangle[v]);
+                    after[v] = triangle[v] == collapse.from ? target : before[v];
+                }
+                glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+                glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+                float lengths = glm::length(normalBefore) * glm::length(normalAfter);
+                if (lengths <= 0.0f || glm::dot(normalBefore, normalAfter) < 0.25f * lengths)
+                    valid = false;
+            }
+            if (!valid)
+                continue;
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            maxError = std::max(maxError, collapse.cost);
+            collapseCount++;
+            // Les sommets voisins sont bloqués jusqu'à la prochaine passe : les triangles autour ont changé
+            for (unsigned int k = triangleOffsets[collapse.from]; k < triangleOffsets[collapse.from + 1]; k++)
+            {
+                const unsigned int *triangle = &result[vertexTriangles[k] * 3];
+                touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1;
+            }
+        }
+        if (collapseCount == 0)
+            break;
+
+        // Application des fusions et suppression des triangles dégénérés
+        size_t write = 0;
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            unsigned int a = remap[result[t * 3]], b = remap[result[t * 3 + 1]], c = remap[result[t * 3 + 2]];
+            if (a == b || b == c || a == c)
+                continue;
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+    return (float)std::sqrt(maxError);
+}
@@ -1,84 +1,288 @@
 #include "model.hpp"
+#include "assetCache.hpp"
+#include "cookedMesh.hpp"
+#include "mappedFile.hpp"
+#include "constants.hpp"
+#include "meshSimplifier.hpp"
+#include "meshOptimizer.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
+#include <unordered_map>
 
-unsigned int TextureFromFile(const char *path, const string &directory)
+bool Model::readModelData(const string &path, bool flipTextureVertically, ModelData &data)
 {
-    string filename = string(path);
-    filename = directory + '/' + filename;
-
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 2)
-            format = GL_RG;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
+    data.directory = path.substr(0, path.find_last_of('/'));
+    data.flipTextureVertically = flipTextureVertically;
+
+    // Si le modèle a déjà été cuisiné, on évite complètement Assimp (le fichier contient aussi l'occulteur)
+    if (loadCookedModel(path, data))
+        return true;
+
+    Assimp::Importer import;
+    const aiScene *scene = import.ReadFile(path, aiProcess_Triangulate /*| aiProcess_FlipUVs*/);
+
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+    {
+        cout << "ERROR::ASSIMP::" << import.GetErrorString() << endl;
+        return false;
     }
-    else
+
+    processNode(scene->mRootNode, scene, data);
+    buildOccluder(data);
+    cookModel(path, data);
+    return true;
+}
+
+bool Model::loadCookedModel(const string &path, ModelData &model)
+{
+    shared_ptr<MappedFile> file = make_shared<MappedFile>();
+    if (!file->open(path + COOKED_MESH_EXTENSION))
+        return false;
+
+    // Vérification de l'en-tête : format, version, structure PackedVertex, encodage des positions et fichier source
+    const unsigned char *data = file->data();
+    size_t size = file->size();
+    if (size < sizeof(CookedMeshHeader))
+        return false;
+    CookedMeshHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, COOKED_MESH_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != COOKED_MESH_VERSION || header.vertexSize != sizeof(PackedVertex) ||
+        header.positionEncoding != (uint32_t)Mesh::getPositionEncoding() || !isCookedMeshUpToDate(header, path))
+        return false;
+
+    if (sizeof(CookedMeshHeader) + (uint64_t)header.meshCount * sizeof(CookedMeshEntry) > size)
+        return false;
+    const CookedMeshEntry *meshEntries = reinterpret_cast<const CookedMeshEntry *>(data + sizeof(CookedMeshHeader));
+    // Le nombre total de LODs se déduit des entrées des meshes
+    uint64_t lodCount = 0;
+    for (uint32_t i = 0; i < header.meshCount; i++)
+        lodCount += meshEntries[i].lodCount;
+    uint64_t tablesSize = (uint64_t)header.meshCount * sizeof(CookedMeshEntry) + (uint64_t)header.textureCount * sizeof(CookedTextureEntry) +
+                          lodCount * sizeof(CookedLodEntry) + header.stringTableSize;
+    if (sizeof(CookedMeshHeader) + tablesSize > size)
+        return false;
+    const CookedTextureEntry *textureEntries = reinterpret_cast<const CookedTextureEntry *>(meshEntries + header.meshCount);
+    const CookedLodEntry *lodEntries = reinterpret_cast<const CookedLodEntry *>(textureEntries + header.textureCount);
+    const char *stringTable = reinterpret_cast<const char *>(lodEntries + lodCount);
+
+    // On vérifie toutes les plages avant de créer le moindre buffer OpenGL
+    const CookedLodEntry *meshLods = lodEntries;
+    for (uint32_t i = 0; i < header.meshCount; i++)
     {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
+        const CookedMeshEntry &entry = meshEntries[i];
+        // Au-delà de 65536 sommets, des indices sur 16 bits seraient tronqués
+        bool shortIndices = entry.indexSize == sizeof(uint16_t);
+        if ((!shortIndices && entry.indexSize != sizeof(unsigned int)) || (shortIndices && entry.vertexCount > 65536) ||
+            entry.vertexOffset % alignof(PackedVertex) != 0 || entry.positionOffset % alignof(uint16_t) != 0 ||
+            entry.indexOffset % entry.indexSize != 0 ||
+            entry.vertexOffset + (uint64_t)entry.vertexCount * sizeof(PackedVertex) > size ||
+            entry.positionOffset + (uint64_t)entry.vertexCount * 4 * sizeof(uint16_t) > size ||
+            entry.indexOffset + (uint64_t)entry.indexCount * entry.indexSize > size ||
+            (uint64_t)entry.firstTexture + entry.textureCount > header.textureCount || entry.lodCount == 0)
+            return false;
+        for (uint32_t l = 0; l < entry.lodCount; l++)
+        {
+            if ((uint64_t)meshLods[l].firstIndex + meshLods[l].indexCount > entry.indexCount)
+                return false;
+        }
+        meshLods += entry.lodCount;
+        // Un indice hors des sommets du mesh serait lu par le GPU en dehors du buffer : le fichier est rejeté
+        // et le modèle est relu par Assimp
+        unsigned int maxIndex = 0;
+        if (shortIndices)
+        {
+            const uint16_t *indices = reinterpret_cast<const uint16_t *>(data + entry.indexOffset);
+            for (uint32_t k = 0; k < entry.indexCount; k++)
+                maxIndex = std::max(maxIndex, (unsigned int)indices[k]);
+        }
+        else
+        {
+            const unsigned int *indices = reinterpret_cast<const unsigned int *>(data + entry.indexOffset);
+            for (uint32_t k = 0; k < entry.indexCount; k++)
+                maxIndex = std::max(maxIndex, indices[k]);
+        }
+        if (entry.indexCount > 0 && maxIndex >= entry.vertexCount)
+            return false;
+    }
+    // Même vérification pour l'occulteur, rastérisé sur le CPU
+    if (header.occluderVertexOffset % alignof(float) != 0 || header.occluderIndexOffset % alignof(unsigned int) != 0 ||
+        header.occluderVertexOffset + (uint64_t)header.occluderVertexCount * sizeof(glm::vec3) > size ||
+        header.occluderIndexOffset + (uint64_t)header.occluderIndexCount * sizeof(unsigned int) > size)
+        return false;
+    const glm::vec3 *occluderVertices = reinterpret_cast<const glm::vec3 *>(data + header.occluderVertexOffset);
+    const unsigned int *occluderIndices = reinterpret_cast<const unsigned int *>(data + header.occluderIndexOffset);
+    for (uint32_t k = 0; k < header.occluderIndexCount; k++)
+    {
+        if (occluderIndices[k] >= header.occluderVertexCount)
+            return false;
+    }
+    for (uint32_t i = 0; i < header.textureCount; i++)
+    {
+        const CookedTextureEntry &entry = textureEntries[i];
+        if ((uint64_t)entry.typeOffset + entry.typeLength > header.stringTableSize ||
+            (uint64_t)entry.pathOffset + entry.pathLength > header.stringTableSize)
+            return false;
     }
 
-    return textureID;
+    // Les meshes pointent directement dans la projection du fichier, qui reste ouverte jusqu'à l'envoi au GPU :
+    // les plages sont copiées telles quelles dans les buffers OpenGL
+    model.cookedFile = file;
+    model.meshes.resize(header.meshCount);
+    for (uint32_t i = 0; i < header.meshCount; i++)
+    {
+        const CookedMeshEntry &entry = meshEntries[i];
+        MeshData &mesh = model.meshes[i];
+        mesh.packedVertexData = reinterpret_cast<const PackedVertex *>(data + entry.vertexOffset);
+        mesh.positionData = reinterpret_cast<const uint16_t *>(data + entry.positionOffset);
+        mesh.vertexCount = entry.vertexCount;
+        mesh.packedIndexData = data + entry.indexOffset;
+        mesh.indexSize = entry.indexSize;
+        mesh.indexCount = entry.indexCount;
+        mesh.positionDecode.offset = glm::vec3(entry.decodeOffset[0], entry.decodeOffset[1], entry.decodeOffset[2]);
+        mesh.positionDecode.scale = glm::vec3(entry.decodeScale[0], entry.decodeScale[1], entry.decodeScale[2]);
+        mesh.bounds.min = glm::vec3(entry.boundsMin[0], entry.boundsMin[1], entry.boundsMin[2]);
+        mesh.bounds.max = glm::vec3(entry.boundsMax[0], entry.boundsMax[1], entry.boundsMax[2]);
+        mesh.boundingSphere.center = mesh.bounds.getCenter();
+        mesh.boundingSphere.radius = entry.boundingRadius;
+        for (uint32_t l = 0; l < entry.lodCount; l++)
+            mesh.lods.push_back({lodEntries[l].firstIndex, lodEntries[l].indexCount, lodEntries[l].error});
+        lodEntries += entry.lodCount;
+        mesh.textures.reserve(entry.textureCount);
+        for (uint32_t t = entry.firstTexture; t < entry.firstTexture + entry.textureCount; t++)
+        {
+            Texture texture;
+            texture.type.assign(stringTable + textureEntries[t].typeOffset, textureEntries[t].typeLength);
+            texture.path.assign(stringTable + textureEntries[t].pathOffset, textureEntries[t].pathLength);
+            texture.asset = AssetCache::loadTexture(model.directory + '/' + texture.path, model.flipTextureVertically);
+            mesh.textures.push_back(texture);
+        }
+    }
+    model.occluder.vertices.assign(occluderVertices, occluderVertices + header.occluderVertexCount);
+    model.occluder.indices.assign(occluderIndices, occluderIndices + header.occluderIndexCount);
+    return true;
 }
 
-void Model::loadModel(string path)
+void Model::cookModel(const string &path, const ModelData &data)
 {
-    Assimp::Importer import;
-    const aiScene *scene = import.ReadFile(path, aiProcess_Triangulate /*| aiProcess_FlipUVs*/);
+    CookedSourceInfo source;
+    if (!readCookedSourceInfo(path, source, true))
+        return;
+    writeCookedMesh(path + COOKED_MESH_EXTENSION, source, data.meshes, data.occluder);
+}
 
-    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+void Model::buildOccluder(ModelData &data)
+{
+    // L'occulteur est construit à partir du LOD le plus simple de chaque mesh
+    auto occluderRange = [](const MeshData &mesh)
     {
-        cout << "ERROR::ASSIMP::" << import.GetErrorString() << endl;
+        return mesh.lods.empty() ? MeshLod{0, (unsigned int)mesh.indexCount, 0.0f} : mesh.lods.back();
+    };
+    size_t indexCount = 0;
+    for (const MeshData &mesh : data.meshes)
+        indexCount += occluderRange(mesh).indexCount;
+    // Un modèle trop détaillé coûterait plus cher à rastériser qu'il ne ferait gagner
+    if (indexCount == 0 || indexCount / 3 > OCCLUDER_MAX_TRIANGLES)
         return;
+
+    // Les sommets ne diffèrent souvent que par leur normale ou leurs coordonnées de texture : on ne garde que les positions distinctes
+    struct PositionHash
+    {
+        size_t operator()(const glm::vec3 &p) const
+        {
+            return std::hash<float>()(p.x) ^ (std::hash<float>()(p.y) * 31) ^ (std::hash<float>()(p.z) * 961);
+        }
+    };
+    std::unordered_map<glm::vec3, unsigned int, PositionHash> positionIndices;
+    OccluderMesh &occluder = data.occluder;
+    occluder.indices.reserve(indexCount);
+    for (const MeshData &mesh : data.meshes)
+    {
+        MeshLod range = occluderRange(mesh);
+        for (size_t i = range.firstIndex; i + 2 < range.firstIndex + range.indexCount; i += 3)
+        {
+            unsigned int triangle[3];
+            for (int v = 0; v < 3; v++)
+            {
+                const glm::vec3 &position = mesh.vertexData[mesh.indexData[i + v]].Position;
+                auto inserted = positionIndices.emplace(position, (unsigned int)occluder.vertices.size());
+                if (inserted.second)
+                    occluder.vertices.push_back(position);
+                triangle[v] = inserted.first->second;
+            }
+            // Les triangles dégénérés après soudure ne cachent rien
+            if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2])
+                continue;
+            occluder.indices.insert(occluder.indices.end(), triangle, triangle + 3);
+        }
     }
-    directory = path.substr(0, path.find_last_of('/'));
+}
+
+void Model::uploadMesh(MeshData &meshData)
+{
+    meshes.emplace_back(meshData);
+}
+
+void Model::finishUpload()
+{
+    for (size_t i = 0; i < meshes.size(); i++)
+        bounds = i == 0 ? meshes[i].getBounds() : mergeAABB(bounds, meshes[i].getBounds());
+    uploaded = true;
+}
+
+bool Model::isReady()
+{
+    if (ready || !uploaded)
+        return ready;
+
+    // Les textures sont décodées et envoyées indépendamment des meshes
+    for (const Mesh &mesh : meshes)
+    {
+        for (const Texture &texture : mesh.textures)
+        {
+            if (!texture.asset->ready)
+                return false;
+        }
+    }
+    ready = true;
+    return true;
+}
+
+void Model::DrawInstanced(Shader &shader, const glm::mat4 *modelMatrices, GLsizei instanceCount)
+{
+    // Un modèle en cours de chargement n'est pas dessiné
+    if (!uploaded)
+        return;
 
-    processNode(scene->mRootNode, scene);
+    for (unsigned int i = 0; i < meshes.size(); i++)
+        meshes[i].DrawInstanced(shader, modelMatrices, instanceCount);
 }
 
-void Model::processNode(aiNode *node, const aiScene *scene)
+void Model::processNode(aiNode *node, const aiScene *scene, ModelData &data)
 {
     // Pour chaque mesh de la node, on le traite et on l'ajoute à la liste des meshes du modèle
     for (unsigned int i = 0; i < node->mNumMeshes; i++)
     {
         aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-        meshes.push_back(processMesh(mesh, scene));
+        data.meshes.push_back(processMesh(mesh, scene, data));
     }
     // Puis on fait la même chose pour chaque node enfant de cette node
     for (unsigned int i = 0; i < node->mNumChildren; i++)
     {
-        processNode(node->mChildren[i], scene);
+        processNode(node->mChildren[i], scene, data);
     }
 }
 
-Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
+MeshData Model::processMesh(aiMesh *mesh, const aiScene *scene, ModelData &data)
 {
     vector<Vertex> vertices;
     vector<unsigned int> indices;
     vector<Texture> textures;
+    vertices.reserve(mesh->mNumVertices);
+    indices.reserve(mesh->mNumFaces * 3);
 
     // Pour chaque vertex du mesh, on récupère ses coordonnées, normales et coordonnées de texture
     for (unsigned int i = 0; i < mesh->mNumVertices; i++)
@@ -122,20 +326,83 @@ Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
         // On charge les textures de diffuse
         vector<Texture> diffuseMaps = loadMaterialTextures(material,
                                                            aiTextureType_DIFFUSE,
-                                                           "texture_diffuse");
+                                                           "texture_diffuse", data);
         // On ajoute la totalité des textures de diffuse chargées à la fin de la liste des textures du mesh
         textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
         // On charge les textures de specular
         vector<Texture> specularMaps = loadMaterialTextures(material,
                                                             aiTextureType_SPECULAR,
-                                                            "texture_specular");
+                                                            "texture_specular", data);
         // On ajoute la totalité des textures de specular chargées à la fin de la liste des textures du mesh
         textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
     }
-    return Mesh(vertices, indices, textures);
+    MeshData meshData;
+    meshData.vertices = std::move(vertices);
+    meshData.indices = std::move(indices);
+    meshData.textures = std::move(textures);
+    optimizeMesh(meshData, mesh->mName.C_Str());
+    meshData.vertexData = meshData.vertices.data();
+    meshData.vertexCount = meshData.vertices.size();
+    meshData.indexData = meshData.indices.data();
+    meshData.indexCount = meshData.indices.size();
+    meshData.bounds = computeAABB(meshData.vertexData, meshData.vertexCount, sizeof(Vertex));
+    meshData.boundingSphere = computeBoundingSphere(meshData.vertexData, meshData.vertexCount, sizeof(Vertex), meshData.bounds);
+    // Conversion au format compact sur le thread de travail : elle est aussi écrite dans le fichier précompilé
+    Mesh::packMeshData(meshData);
+    return meshData;
 }
 
-vector<Texture> Model::loadMaterialTextures(aiMaterial *mat, aiTextureType type, string typeName)
+void Model::optimizeMesh(MeshData &meshData, const string &name)
+{
+    vector<Vertex> &vertices = meshData.vertices;
+    vector<unsigned int> &indices = meshData.indices;
+    size_t originalVertexCount = vertices.size();
+    VertexCacheStats before = analyzeVertexCache(indices.data(), indices.size(), vertices.size());
+
+    // Assimp crée un sommet par coin de face : on fusionne d'abord les sommets identiques
+    vertices.resize(weldVertices(vertices.data(), vertices.size(), sizeof(Vertex), indices.data(), indices.size()));
+    optimizeVertexCache(indices.data(), indices.size(), vertices.size());
+    optimizeOverdraw(indices.data(), indices.size(), vertices.data(), vertices.size(), sizeof(Vertex));
+
+    // Les LODs sont simplifiés à partir de l'ordre optimisé, puis chacun est réordonné pour le cache
+    generateLods(meshData);
+    for (size_t level = 1; level < meshData.lods.size(); level++)
+        optimizeVertexCache(indices.data() + meshData.lods[level].firstIndex, meshData.lods[level].indexCount, vertices.size());
+
+    // En dernier : les sommets sont rangés dans l'ordre où le LOD 0 les utilise
+    vertices.resize(optimizeVertexFetch(vertices.data(), vertices.size(), sizeof(Vertex), indices.data(), indices.size()));
+
+    VertexCacheStats after = analyzeVertexCache(indices.data(), meshData.lods[0].indexCount, vertices.size());
+    cout << "Mesh " << name << " : " << originalVertexCount << " -> " << vertices.size() << " sommets, "
+         << "ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr << endl;
+}
+
+void Model::generateLods(MeshData &meshData)
+{
+    unsigned int fullIndexCount = (unsigned int)meshData.indices.size();
+    meshData.lods.push_back({0, fullIndexCount, 0.0f});
+
+    // Chaque LOD est simplifié à partir du précédent, jusqu'à ce que la simplification ne gagne plus assez
+    vector<unsigned int> simplified;
+    for (int level = 1; level < MESH_LOD_COUNT; level++)
+    {
+        MeshLod previous = meshData.lods.back();
+        size_t target = previous.indexCount / 6 * 3;
+        float error = simplifyMesh(meshData.vertices.data(), meshData.vertices.size(), sizeof(Vertex),
+                                   meshData.indices.data() + previous.firstIndex, previous.indexCount, target, simplified);
+        if (simplified.empty() || simplified.size() > previous.indexCount * MESH_LOD_MIN_REDUCTION)
+            break;
+
+        MeshLod lod;
+        lod.firstIndex = (unsigned int)meshData.indices.size();
+        lod.indexCount = (unsigned int)simplified.size();
+        lod.error = std::max(previous.error, error);
+        meshData.indices.insert(meshData.indices.end(), simplified.begin(), simplified.end());
+        meshData.lods.push_back(lod);
+    }
+}
+
+vector<Texture> Model::loadMaterialTextures(aiMaterial *mat, aiTextureType type, string typeName, const ModelData &data)
 {
     vector<Texture> textures;
     // On parcourt toutes les textures du type spécifié (diffuse ou specular)
@@ -145,28 +412,12 @@ vector<Texture> Model::loadMaterialTextures(aiMaterial *mat, aiTextureType type,
         aiString str;
         mat->GetTexture(type, i, &str);
 
-        // On vérifie si la texture a déjà été chargée
-        bool skip = false;
-        for (unsigned int j = 0; j < textures_loaded.size(); j++)
-        {
-            // On compare le path de la texture avec chaque path des textures déjà chargées
-            if (std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0)
-            {
-                textures.push_back(textures_loaded[j]);
-                skip = true;
-                break;
-            }
-        }
-        // Si la texture n'a pas déjà été chargée, on la charge dans un objet Texture
-        if (!skip)
-        {
-            Texture texture;
-            texture.id = TextureFromFile(str.C_Str(), directory);
-            texture.type = typeName;
-            texture.path = str.C_Str();
-            textures.push_back(texture);
-            textures_loaded.push_back(texture); // On ajoute la texture aux textures déjà chargées
-        }
+        // Le registre global ne décode et n'envoie la texture au GPU qu'une fois pour toute l'application
+        Texture texture;
+        texture.asset = AssetCache::loadTexture(data.directory + '/' + str.C_Str(), data.flipTextureVertically);
+        texture.type = typeName;
+        texture.path = str.C_Str();
+        textures.push_back(texture);
     }
     return textures;
 }
\ No newline at end of file
@@ -0,0 +1,297 @@
+#include "occlusionBuffer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+// Le chemin AVX2 est compilé avec l'attribut target (pas besoin de -mavx2) et choisi à l'exécution selon le processeur
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define OCCLUSION_USE_AVX2
+#include <immintrin.h>
+#define OCCLUSION_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+OcclusionBuffer::OcclusionBuffer(int width, int height)
+    : width((width + TILE_SIZE - 1) / TILE_SIZE * TILE_SIZE), height((height + TILE_SIZE - 1) / TILE_SIZE * TILE_SIZE),
+      useAVX2(supportsAVX2())
+{
+    tilesX = this->width / TILE_SIZE;
+    tilesY = this->height / TILE_SIZE;
+    depth.assign((size_t)this->width * this->height, 1.0f);
+    tileMaxDepth.assign((size_t)tilesX * tilesY, 1.0f);
+}
+
+bool OcclusionBuffer::supportsAVX2()
+{
+#ifdef OCCLUSION_USE_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+void OcclusionBuffer::begin(const glm::mat4 &viewProjection)
+{
+    this->viewProjection = viewProjection;
+    std::fill(depth.begin(), depth.end(), 1.0f);
+    std::fill(tileMaxDepth.begin(), tileMaxDepth.end(), 1.0f);
+    triangles.clear();
+}
+
+void OcclusionBuffer::addOccluder(const OccluderMesh &mesh, const glm::mat4 &modelMatrix)
+{
+    glm::mat4 transform = viewProjection * modelMatrix;
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+    {
+        glm::vec3 screen[3];
+        bool clipped = false;
+        for (int v = 0; v < 3; v++)
+        {
+            glm::vec4 clip = transform * glm::vec4(mesh.vertices[mesh.indices[i + v]], 1.0f);
+            // Sommet devant le plan proche (ou derrière la caméra) : on ignore le triangle, ce qui reste conservatif
+            if (clip.z < -clip.w)
+            {
+                clipped = true;
+                break;
+            }
+            glm::vec3 ndc = glm::vec3(clip) / clip.w;
+            screen[v] = glm::vec3((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height, ndc.z * 0.5f + 0.5f);
+        }
+        if (clipped)
+            continue;
+
+        ScreenTriangle triangle;
+        float minX = std::min(std::min(screen[0].x, screen[1].x), screen[2].x);
+        float maxX = std::max(std::max(screen[0].x, screen[1].x), screen[2].x);
+        float minY = std::min(std::min(screen[0].y, screen[1].y), screen[2].y);
+        float maxY = std::max(std::max(screen[0].y, screen[1].y), screen[2].y);
+        triangle.minX = std::max(0, (int)std::floor(minX));
+        triangle.maxX = std::min(width - 1, (int)std::ceil(maxX));
+        triangle.minY = std::max(0, (int)std::floor(minY));
+        triangle.maxY = std::min(height - 1, (int)std::ceil(maxY));
+        if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+            continue;
+
+        // Fonctions de bord E(x, y) = A x + B y + C, orientées pour être positives à l'intérieur quel que soit le sens du triangle
+        for (int e = 0; e < 3; e++)
+        {
+            const glm::vec3 &p0 = screen[e];
+            const glm::vec3 &p1 = screen[(e + 1) % 3];
+            triangle.edgeA[e] = p0.y - p1.y;
+            triangle.edgeB[e] = p1.x - p0.x;
+            triangle.edgeC[e] = p0.x * p1.y - p1.x * p0.y;
+        }
+        float area = triangle.edgeA[0] * screen[2].x + triangle.edgeB[0] * screen[2].y + triangle.edgeC[0];
+        if (std::fabs(area) < 1e-6f)
+            continue;
+        if (area < 0.0f)
+        {
+            for (int e = 0; e < 3; e++)
+            {
+                triangle.edgeA[e] = -triangle.edgeA[e];
+                triangle.edgeB[e] = -triangle.edgeB[e];
+                triangle.edgeC[e] = -triangle.edgeC[e];
+            }
+        }
+
+        // Plan de profondeur z = a x + b y + c (z / w est linéaire dans l'espace écran)
+        glm::vec3 normal = glm::cross(screen[1] - screen[0], screen[2] - screen[0]);
+        triangle.depthA = -normal.x / normal.z;
+        triangle.depthB = -normal.y / normal.z;
+        triangle.depthC = screen[0].z - triangle.depthA * screen[0].x - triangle.depthB * screen[0].y;
+        triangles.push_back(triangle);
+    }
+}
+
+void OcclusionBuffer::rasterizeRowsScalar(const ScreenTriangle &triangle, int firstRow, int lastRow)
+{
+    for (int y = firstRow; y <= lastRow; y++)
+    {
+        float py = y + 0.5f;
+        float *row = depth.data() + (size_t)y * width;
+        for (int x = triangle.minX; x <= triangle.maxX; x++)
+        {
+            float px = x + 0.5f;
+            if (triangle.edgeA[0] * px + triangle.edgeB[0] * py + triangle.edgeC[0] < 0.0f ||
+                triangle.edgeA[1] * px + triangle.edgeB[1] * py + triangle.edgeC[1] < 0.0f ||
+                triangle.edgeA[2] * px + triangle.edgeB[2] * py + triangle.edgeC[2] < 0.0f)
+                continue;
+            float z = triangle.depthA * px + triangle.depthB * py + triangle.depthC;
+            row[x] = std::min(row[x], z);
+        }
+    }
+}
+
+void OcclusionBuffer::updateTileRowScalar(int tileRow)
+{
+    for (int tileX = 0; tileX < tilesX; tileX++)
+    {
+        float maxDepth = 0.0f;
+        for (int y = tileRow * TILE_SIZE; y < (tileRow + 1) * TILE_SIZE; y++)
+        {
+            const float *row = depth.data() + (size_t)y * width + tileX * TILE_SIZE;
+            for (int x = 0; x < TILE_SIZE; x++)
+                maxDepth = std::max(maxDepth, row[x]);
+        }
+        tileMaxDepth[(size_t)tileRow * tilesX + tileX] = maxDepth;
+    }
+}
+
+#ifdef OCCLUSION_USE_AVX2
+// 8 pixels par itération. La largeur du tampon est un multiple de 8 : on part du multiple de 8 inférieur à minX,
+// les pixels hors de la boîte du triangle échouent de toute façon au test des bords.
+OCCLUSION_AVX2_TARGET static void rasterizeRowsAVX2(const float edgeA[3], const float edgeB[3], const float edgeC[3],
+                                                    float depthA, float depthB, float depthC, int minX, int maxX,
+                                                    int firstRow, int lastRow, float *depth, int width)
+{
+    const __m256 pixelOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    const __m256 zero = _mm256_setzero_ps();
+    __m256 a0 = _mm256_set1_ps(edgeA[0]), a1 = _mm256_set1_ps(edgeA[1]), a2 = _mm256_set1_ps(edgeA[2]);
+    __m256 za = _mm256_set1_ps(depthA);
+    int startX = minX & ~7;
+
+    for (int y = firstRow; y <= lastRow; y++)
+    {
+        float py = y + 0.5f;
+        // Partie constante de la ligne : B y + C
+        __m256 c0 = _mm256_set1_ps(edgeB[0] * py + edgeC[0]);
+        __m256 c1 = _mm256_set1_ps(edgeB[1] * py + edgeC[1]);
+        __m256 c2 = _mm256_set1_ps(edgeB[2] * py + edgeC[2]);
+        __m256 zc = _mm256_set1_ps(depthB * py + depthC);
+        float *row = depth + (size_t)y * width;
+        for (int x = startX; x <= maxX; x += 8)
+        {
+            __m256 px = _mm256_add_ps(_mm256_set1_ps((float)x), pixelOffsets);
+            __m256 e0 = _mm256_add_ps(_mm256_mul_ps(a0, px), c0);
+            __m256 e1 = _mm256_add_ps(_mm256_mul_ps(a1, px), c1);
+            __m256 e2 = _mm256_add_ps(_mm256_mul_ps(a2, px), c2);
+            __m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(e0, zero, _CMP_GE_OQ), _mm256_cmp_ps(e1, zero, _CMP_GE_OQ)),
+                                          _mm256_cmp_ps(e2, zero, _CMP_GE_OQ));
+            if (_mm256_movemask_ps(inside) == 0)
+                continue;
+            __m256 z = _mm256_add_ps(_mm256_mul_ps(za, px), zc);
+            __m256 current = _mm256_loadu_ps(row + x);
+            _mm256_storeu_ps(row + x, _mm256_blendv_ps(current, _mm256_min_ps(current, z), inside));
+        }
+    }
+}
+
+OCCLUSION_AVX2_TARGET static void updateTileRowAVX2(const float *depth, int width, int tilesX, int tileRow, float *tileMaxDepth)
+{
+    const int tileSize = OcclusionBuffer::TILE_SIZE;
+    for (int tileX = 0; tileX < tilesX; tileX++)
+    {
+        const float *tile = depth + (size_t)tileRow * tileSize * width + tileX * tileSize;
+        __m256 maxDepth = _mm256_loadu_ps(tile);
+        for (int y = 1; y < tileSize; y++)
+            maxDepth = _mm256_max_ps(maxDepth, _mm256_loadu_ps(tile + (size_t)y * width));
+        // Maximum horizontal des 8 valeurs
+        __m128 half = _mm_max_ps(_mm256_castps256_ps128(maxDepth), _mm256_extractf128_ps(maxDepth, 1));
+        half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_max_ss(half, _mm_shuffle_ps(half, half, 1));
+        tileMaxDepth[(size_t)tileRow * tilesX + tileX] = _mm_cvtss_f32(half);
+    }
+}
+#endif
+
+void OcclusionBuffer::rasterizeTileRow(int tileRow)
+{
+    int firstRow = tileRow * TILE_SIZE;
+    int lastRow = firstRow + TILE_SIZE - 1;
+    for (const ScreenTriangle &triangle : triangles)
+    {
+        if (triangle.maxY < firstRow || triangle.minY > lastRow)
+            continue;
+        int rowBegin = std::max(firstRow, triangle.minY);
+        int rowEnd = std::min(lastRow, triangle.maxY);
+#ifdef OCCLUSION_USE_AVX2
+        if (useAVX2)
+        {
+            rasterizeRowsAVX2(triangle.edgeA, triangle.edgeB, triangle.edgeC, triangle.depthA, triangle.depthB, triangle.depthC,
+                              triangle.minX, triangle.maxX, rowBegin, rowEnd, depth.data(), width);
+            continue;
+        }
+#endif
+        rasterizeRowsScalar(triangle, rowBegin, rowEnd);
+    }
+
+#ifdef OCCLUSION_USE_AVX2
+    if (useAVX2)
+    {
+        updateTileRowAVX2(depth.data(), width, tilesX, tileRow, tileMaxDepth.data());
+        return;
+    }
+#endif
+    updateTileRowScalar(tileRow);
+}
+
+void OcclusionBuffer::rasterize(unsigned int threadCount)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    // Chaque rangée de tuiles est une tâche du pool : chaque pixel n'est écrit que par un thread
+    threadCount = std::max(1u, std::min(threadCount, (unsigned int)tilesY));
+    if (!workerPool || workerPool->getThreadCount() != threadCount)
+        workerPool = std::make_unique<WorkerPool>(threadCount);
+    workerPool->run((unsigned int)tilesY, [this](unsigned int tileRow)
+                    { rasterizeTileRow((int)tileRow); });
+
+    rasterizeTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool OcclusionBuffer::isVisible(const AABB &worldBounds) const
+{
+    // Rectangle écran et profondeur la plus proche de la boîte
+    glm::vec2 screenMin(std::numeric_limits<float>::max());
+    glm::vec2 screenMax(-std::numeric_limits<float>::max());
+    float nearestDepth = 1.0f;
+    for (int corner = 0; corner < 8; corner++)
+    {
+        glm::vec3 position((corner & 1) ? worldBounds.max.x : worldBounds.min.x,
+                           (corner & 2) ? worldBounds.max.y : worldBounds.min.y,
+                           (corner & 4) ? worldBounds.max.z : worldBounds.min.z);
+        glm::vec4 clip = viewProjection * glm::vec4(position, 1.0f);
+        // La boîte traverse le plan proche : elle touche la caméra, on ne peut rien conclure
+        if (clip.z < -clip.w)
+            return true;
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        glm::vec2 screen((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height);
+        screenMin = glm::min(screenMin, screen);
+        screenMax = glm::max(screenMax, screen);
+        nearestDepth = std::min(nearestDepth, ndc.z * 0.5f + 0.5f);
+    }
+
+    int minX = std::max(0, (int)std::floor(screenMin.x));
+    int maxX = std::min(width - 1, (int)std::ceil(screenMax.x));
+    int minY = std::max(0, (int)std::floor(screenMin.y));
+    int maxY = std::min(height - 1, (int)std::ceil(screenMax.y));
+    // Hors de l'écran : c'est au frustum culling de décider
+    if (minX > maxX || minY > maxY)
+        return true;
+
+    for (int tileY = minY / TILE_SIZE; tileY <= maxY / TILE_SIZE; tileY++)
+    {
+        for (int tileX = minX / TILE_SIZE; tileX <= maxX / TILE_SIZE; tileX++)
+        {
+            // Tous les pixels de la tuile sont plus proches que la boîte : elle est cachée sur cette tuile
+            if (tileMaxDepth[(size_t)tileY * tilesX + tileX] < nearestDepth)
+                continue;
+
+            // Sinon on examine les pixels communs à la tuile et au rectangle
+            int x0 = std::max(minX, tileX * TILE_SIZE), x1 = std::min(maxX, tileX * TILE_SIZE + TILE_SIZE - 1);
+            int y0 = std::max(minY, tileY * TILE_SIZE), y1 = std::min(maxY, tileY * TILE_SIZE + TILE_SIZE - 1);
+            for (int y = y0; y <= y1; y++)
+            {
+                const float *row = depth.data() + (size_t)y * width;
+                for (int x = x0; x <= x1; x++)
+                {
+                    if (row[x] >= nearestDepth)
+                        return true;
+                }
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,278 @@
+#include "profiler.hpp"
+#include "constants.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+bool Profiler::enabled = false;
+std::vector<Profiler::Frame> Profiler::frames;
+size_t Profiler::currentFrame = 0;
+bool Profiler::frameOpen = false;
+std::vector<size_t> Profiler::openScopes;
+std::vector<Profiler::History> Profiler::histories;
+std::unordered_map<std::string, size_t> Profiler::historyIndices;
+int64_t Profiler::gpuReference = 0;
+double Profiler::cpuReference = 0.0;
+size_t Profiler::droppedFrames = 0;
+std::vector<Profiler::Event> Profiler::trace;
+size_t Profiler::traceFramesLeft = 0;
+
+// Scope ouvert en dehors d'une frame : il n'est pas enregistré
+static const size_t UNRECORDED_SCOPE = (size_t)-1;
+
+double Profiler::now()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+    if (enabled && frames.empty())
+    {
+        frames.resize(PROFILER_FRAME_LATENCY);
+        // Les deux horloges sont lues au même moment pour placer les mesures du GPU sur la chronologie du CPU
+        glGetInteger64v(GL_TIMESTAMP, &gpuReference);
+        cpuReference = now();
+    }
+    Profiler::enabled = enabled;
+}
+
+void Profiler::startTrace(size_t maxFrames)
+{
+    trace.clear();
+    traceFramesLeft = maxFrames;
+}
+
+void Profiler::beginFrame()
+{
+    if (!enabled)
+        return;
+
+    // L'emplacement de la frame a servi il y a PROFILER_FRAME_LATENCY frames : ses requêtes sont normalement prêtes
+    currentFrame = (currentFrame + 1) % frames.size();
+    Frame &frame = frames[currentFrame];
+    if (frame.pending)
+        resolve(frame, false);
+    frame.events.clear();
+    frame.queryCount = 0;
+    frame.pending = true;
+    frameOpen = true;
+    beginScope("frame", true);
+}
+
+void Profiler::endFrame()
+{
+    if (!enabled || !frameOpen)
+        return;
+    // Les scopes restés ouverts sont fermés avec la frame
+    while (!openScopes.empty())
+        endScope();
+    frameOpen = false;
+}
+
+void Profiler::beginScope(const char *name, bool gpu)
+{
+    if (!frameOpen)
+    {
+        openScopes.push_back(UNRECORDED_SCOPE);
+        return;
+    }
+
+    Frame &frame = frames[currentFrame];
+    Event event = {name, (int)openScopes.size(), now(), 0.0, -1, 0.0, 0.0};
+    if (gpu)
+    {
+        // Deux requêtes par scope (timestamps de début et de fin), créées au besoin et réutilisées d'une frame à l'autre
+        if (frame.queryCount + 2 > frame.queries.size())
+        {
+            size_t first = frame.queries.size();
+            frame.queries.resize(first + 16);
+            glGenQueries(16, &frame.queries[first]);
+        }
+        event.query = (int)frame.queryCount;
+        frame.queryCount += 2;
+        glQueryCounter(frame.queries[event.query], GL_TIMESTAMP);
+    }
+    openScopes.push_back(frame.events.size());
+    frame.events.push_back(event);
+}
+
+void Profiler::endScope()
+{
+    if (openScopes.empty())
+        return;
+    size_t index = openScopes.back();
+    openScopes.pop_back();
+    if (index == UNRECORDED_SCOPE)
+        return;
+
+    Frame &frame = frames[currentFrame];
+    Event &event = frame.events[index];
+    event.cpuEnd = now();
+    if (event.query >= 0)
+        glQueryCounter(frame.queries[event.query + 1], GL_TIMESTAMP);
+}
+
+void Profiler::addSample(std::vector<float> &samples, size_t &next, float value)
+{
+    if (samples.size() < PROFILER_HISTORY_FRAMES)
+    {
+        samples.push_back(value);
+        return;
+    }
+    samples[next] = value;
+    next = (next + 1) % samples.size();
+}
+
+void Profiler::resolve(Frame &frame, bool wait)
+{
+    frame.pending = false;
+
+    // Sans attendre : si la dernière requête n'est pas prête, les mesures GPU de la frame sont abandonnées
+    bool gpuReady = true;
+    if (!wait && frame.queryCount > 0)
+    {
+        GLint available = 0;
+        glGetQueryObjectiv(frame.queries[frame.queryCount - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        gpuReady = available != 0;
+        if (!gpuReady)
+            droppedFrames++;
+    }
+
+    for (Event &event : frame.events)
+    {
+        auto found = historyIndices.find(event.name);
+        if (found == historyIndices.end())
+        {
+            found = historyIndices.emplace(event.name, histories.size()).first;
+            histories.push_back({event.name, event.depth, {}, {}, 0, 0});
+        }
+        History &history = histories[found->second];
+        addSample(history.cpu, history.nextCpu, (float)(event.cpuEnd - event.cpuBegin));
+
+        if (event.query >= 0 && gpuReady)
+        {
+            GLuint64 begin = 0, end = 0;
+            glGetQueryObjectui64v(frame.queries[event.query], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(frame.queries[event.query + 1], GL_QUERY_RESULT, &end);
+            event.gpuBegin = cpuReference + (double)((int64_t)begin - gpuReference) / 1e6;
+            event.gpuEnd = cpuReference + (double)((int64_t)end - gpuReference) / 1e6;
+            addSample(history.gpu, history.nextGpu, (float)(event.gpuEnd - event.gpuBegin));
+        }
+        else
+        {
+            event.query = -1;
+        }
+    }
+
+    if (traceFramesLeft > 0)
+    {
+        trace.insert(trace.end(), frame.events.begin(), frame.events.end());
+        traceFramesLeft--;
+    }
+}
+
+void Profiler::flush()
+{
+    if (frames.empty())
+        return;
+    endFrame();
+    // Dans l'ordre des frames, de la plus ancienne à la plus récente
+    for (size_t i = 1; i <= frames.size(); i++)
+    {
+        Frame &frame = frames[(currentFrame + i) % frames.size()];
+        if (frame.pending)
+            resolve(frame, true);
+    }
+}
+
+// Minimum, moyenne et 99e centile d'une série de durées
+static void printDurations(const std::vector<float> &samples)
+{
+    if (samples.empty())
+    {
+        std::cout << std::setw(26) << "-";
+        return;
+    }
+    std::vector<float> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0;
+    for (float sample : sorted)
+        sum += sample;
+    size_t p99 = std::min(sorted.size() - 1, (size_t)(sorted.size() * 0.99));
+    std::cout << std::setw(8) << sorted.front() << std::setw(9) << sum / sorted.size() << std::setw(9) << sorted[p99];
+}
+
+void Profiler::printReport()
+{
+    if (histories.empty())
+        return;
+    std::cout << "Profiler (ms, " << PROFILER_HISTORY_FRAMES << " dernieres mesures) : scope, CPU min/moy/p99, GPU min/moy/p99";
+    if (droppedFrames > 0)
+        std::cout << " - " << droppedFrames << " frames sans mesures GPU";
+    std::cout << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    for (const History &history : histories)
+    {
+        std::string label = std::string(2 * history.depth, ' ') + history.name;
+        std::cout << "  " << std::left << std::setw(24) << label << std::right;
+        printDurations(history.cpu);
+        printDurations(history.gpu);
+        std::cout << std::endl;
+    }
+    std::cout << std::defaultfloat;
+}
+
+// Échappe une chaîne pour le JSON
+static std::string jsonString(const char *text)
+{
+    std::string result = "\"";
+    for (const char *c = text; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            result += '\\';
+        result += *c;
+    }
+    return result + "\"";
+}
+
+bool Profiler::writeTrace(const std::string &path)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cout << "ERROR::PROFILER::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+
+    // Format "Trace Event" : un évènement complet ("X") par scope, en microsecondes, CPU sur le fil 1 et GPU sur le fil 2
+    file << std::fixed << std::setprecision(3);
+    file << "{\"traceEvents\":[\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+    for (const Event &event : trace)
+    {
+        file << ",\n{\"name\":" << jsonString(event.name) << ",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << event.cpuBegin * 1000.0
+             << ",\"dur\":" << (event.cpuEnd - event.cpuBegin) * 1000.0 << "}";
+        if (event.query >= 0)
+            file << ",\n{\"name\":" << jsonString(event.name) << ",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":" << event.gpuBegin * 1000.0
+                 << ",\"dur\":" << (event.gpuEnd - event.gpuBegin) * 1000.0 << "}";
+    }
+    file << "\n]}\n";
+    return (bool)file;
+}
+
+void Profiler::deleteResources()
+{
+    for (Frame &frame : frames)
+    {
+        if (!frame.queries.empty())
+            glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data());
+    }
+    frames.clear();
+    enabled = false;
+}
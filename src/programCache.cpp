@@ -0,0 +1,227 @@
+#include "programCache.hpp"
+#include "hash.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// Constantes absentes de GLAD (OpenGL 3.3)
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+ProgramCache::GetProgramBinaryProc ProgramCache::getProgramBinary = nullptr;
+ProgramCache::ProgramBinaryProc ProgramCache::programBinary = nullptr;
+ProgramCache::ProgramParameteriProc ProgramCache::programParameteri = nullptr;
+ProgramCache::MaxShaderCompilerThreadsProc ProgramCache::maxShaderCompilerThreads = nullptr;
+bool ProgramCache::enabled = false;
+std::string ProgramCache::directory;
+std::string ProgramCache::driver;
+ProgramCache::Stats ProgramCache::stats;
+
+// Vrai si le contexte annonce l'extension
+static bool hasExtension(const char *extension)
+{
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount; i++)
+        if (std::strcmp((const char *)glGetStringi(GL_EXTENSIONS, i), extension) == 0)
+            return true;
+    return false;
+}
+
+void ProgramCache::init(const std::string &directory, GLADloadproc loader)
+{
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+    // Compilation en parallèle : le driver choisit lui-même son nombre de threads
+    if (hasExtension("GL_KHR_parallel_shader_compile"))
+        maxShaderCompilerThreads = (MaxShaderCompilerThreadsProc)loader("glMaxShaderCompilerThreadsKHR");
+    else if (hasExtension("GL_ARB_parallel_shader_compile"))
+        maxShaderCompilerThreads = (MaxShaderCompilerThreadsProc)loader("glMaxShaderCompilerThreadsARB");
+    if (maxShaderCompilerThreads)
+        maxShaderCompilerThreads(0xFFFFFFFF);
+
+    enabled = false;
+    if (directory.empty())
+        return;
+    if (major > 4 || (major == 4 && minor >= 1) || hasExtension("GL_ARB_get_program_binary"))
+    {
+        getProgramBinary = (GetProgramBinaryProc)loader("glGetProgramBinary");
+        programBinary = (ProgramBinaryProc)loader("glProgramBinary");
+        programParameteri = (ProgramParameteriProc)loader("glProgramParameteri");
+    }
+    // Certains drivers exposent l'API sans aucun format de binaire
+    GLint formatCount = 0;
+    if (getProgramBinary && programBinary && programParameteri)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    if (formatCount <= 0)
+        return;
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        std::cout << "ERROR::PROGRAM_CACHE::CANNOT_CREATE_DIRECTORY " << directory << std::endl;
+        return;
+    }
+    ProgramCache::directory = directory;
+    if (ProgramCache::directory.back() != '/' && ProgramCache::directory.back() != '\\')
+        ProgramCache::directory += '/';
+    driver = std::string((const char *)glGetString(GL_VENDOR)) + '|' + (const char *)glGetString(GL_RENDERER) + '|' +
+             (const char *)glGetString(GL_VERSION);
+    enabled = true;
+}
+
+uint64_t ProgramCache::makeKey(const std::string &vertexCode, const std::string &fragmentCode, const std::string &defines)
+{
+    // Les parties sont séparées par un caractère nul pour que leurs frontières comptent dans le hash
+    std::string keySource;
+    keySource.reserve(driver.size() + defines.size() + vertexCode.size() + fragmentCode.size() + 3);
+    keySource.append(driver).append(1, '\0');
+    keySource.append(defines).append(1, '\0');
+    keySource.append(vertexCode).append(1, '\0');
+    keySource.append(fragmentCode);
+    return fnv1aHash(reinterpret_cast<const unsigned char *>(keySource.data()), keySource.size()) ^ PROGRAM_CACHE_VERSION;
+}
+
+std::string ProgramCache::pathOf(uint64_t key)
+{
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+    return directory + name + PROGRAM_CACHE_EXTENSION;
+}
+
+bool ProgramCache::load(GLuint program, uint64_t key)
+{
+    if (!enabled)
+        return false;
+
+    auto start = std::chrono::steady_clock::now();
+    std::string path = pathOf(key);
+    std::error_code error;
+    uintmax_t fileSize = std::filesystem::file_size(path, error);
+    if (error)
+        return false;
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    ProgramCacheHeader header;
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, PROGRAM_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != PROGRAM_CACHE_VERSION || header.key != key)
+        return false;
+    // Fichier tronqué ou abîmé : la taille annoncée doit être exactement celle qui suit l'en-tête (pas d'allocation démesurée)
+    if ((uintmax_t)header.binaryLength != fileSize - sizeof(header))
+        return false;
+    std::vector<char> binary(header.binaryLength);
+    file.read(binary.data(), binary.size());
+    if (!file)
+        return false;
+
+    // Le driver peut refuser un binaire valide (mise à jour, autre GPU...) : le programme sera recompilé
+    programBinary(program, header.binaryFormat, binary.data(), (GLsizei)binary.size());
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    stats.loadTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (!success)
+    {
+        stats.rejected++;
+        return false;
+    }
+    stats.loaded++;
+    return true;
+}
+
+void ProgramCache::prepareLink(GLuint program)
+{
+    if (enabled)
+        programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void ProgramCache::store(GLuint program, uint64_t key)
+{
+    if (!enabled)
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+    std::vector<char> binary(length);
+    GLenum binaryFormat = 0;
+    getProgramBinary(program, length, &length, &binaryFormat, binary.data());
+
+    ProgramCacheHeader header;
+    std::memcpy(header.magic, PROGRAM_CACHE_MAGIC, sizeof(header.magic));
+    header.version = PROGRAM_CACHE_VERSION;
+    header.key = key;
+    header.binaryFormat = binaryFormat;
+    header.binaryLength = (uint32_t)length;
+
+    // Écriture dans un fichier temporaire puis renommage : un lancement interrompu ne laisse pas de binaire tronqué
+    std::string path = pathOf(key);
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(binary.data(), length);
+        if (!file)
+        {
+            std::cout << "ERROR::PROGRAM_CACHE::CANNOT_WRITE " << temporaryPath << std::endl;
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error)
+    {
+        std::cout << "ERROR::PROGRAM_CACHE::CANNOT_RENAME " << path << std::endl;
+        std::filesystem::remove(temporaryPath, error);
+    }
+}
+
+bool ProgramCache::isLinkCompleted(GLuint program)
+{
+    if (!maxShaderCompilerThreads)
+        return true;
+    GLint completed = GL_TRUE;
+    glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &completed);
+    return completed == GL_TRUE;
+}
+
+void ProgramCache::addCompileTimes(double submitTime, double waitTime)
+{
+    stats.compiled++;
+    stats.submitTime += submitTime;
+    stats.waitTime += waitTime;
+}
+
+void ProgramCache::printStats()
+{
+    std::cout << "Programmes : " << stats.loaded << " charges depuis le cache (" << stats.loadTime << " ms), "
+              << stats.compiled << " compiles (" << stats.submitTime << " ms d'envoi, " << stats.waitTime << " ms d'attente)";
+    if (stats.rejected > 0)
+        std::cout << ", " << stats.rejected << " binaires refuses par le driver";
+    if (!enabled)
+        std::cout << " - cache desactive";
+    if (isParallelCompileSupported())
+        std::cout << " - compilation parallele";
+    std::cout << std::endl;
+}
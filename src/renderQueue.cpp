@@ -0,0 +1,50 @@
+#include "renderQueue.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+uint64_t RenderQueue::makeKey(RenderPass pass, unsigned int program, unsigned int material, unsigned int vertexArray, float depth)
+{
+    const uint64_t depthMax = (1ull << DEPTH_BITS) - 1;
+    uint64_t depthBits = (uint64_t)std::lround(std::clamp(depth, 0.0f, 1.0f) * (float)depthMax);
+    // Les objets transparents sont dessinés du plus loin au plus proche
+    if (pass == RenderPass::Transparent)
+        depthBits = depthMax - depthBits;
+
+    uint64_t key = (uint64_t)pass;
+    key = (key << PROGRAM_BITS) | (program & ((1u << PROGRAM_BITS) - 1));
+    key = (key << MATERIAL_BITS) | (material & ((1u << MATERIAL_BITS) - 1));
+    key = (key << VERTEX_ARRAY_BITS) | (vertexArray & ((1u << VERTEX_ARRAY_BITS) - 1));
+    key = (key << DEPTH_BITS) | depthBits;
+    return key;
+}
+
+void RenderQueue::sort()
+{
+    size_t count = items.size();
+    if (count < 2)
+        return;
+    scratch.resize(count);
+
+    // Radix sort LSD : une passe de tri par comptage par octet, en commençant par le moins significatif.
+    // Les octets identiques pour toute la file (programme unique, profondeurs proches...) sont sautés.
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        size_t histogram[256] = {};
+        for (const RenderItem &item : items)
+            histogram[(item.key >> shift) & 0xFF]++;
+        if (histogram[(items[0].key >> shift) & 0xFF] == count)
+            continue;
+
+        size_t offset = 0;
+        for (size_t &bucket : histogram)
+        {
+            size_t bucketCount = bucket;
+            bucket = offset;
+            offset += bucketCount;
+        }
+        for (const RenderItem &item : items)
+            scratch[histogram[(item.key >> shift) & 0xFF]++] = item;
+        items.swap(scratch);
+    }
+}
@@ -0,0 +1,112 @@
+#include "scene.hpp"
+
+#include <algorithm>
+
+#include "constants.hpp"
+
+Scene::Scene() : tree(SCENE_BVH_MARGIN)
+{
+}
+
+GameObject &Scene::add(std::unique_ptr<GameObject> gameObject)
+{
+    GameObject &added = *gameObject;
+    added.updateWorldBounds();
+    added.bvhProxy = tree.createProxy(added.getWorldBounds(), &added);
+    gameObjectsByName[added.getName()] = &added;
+    if (added.getLoadState() == GameObject::LoadState::Loading)
+        loadingObjects.push_back(&added);
+    gameObjects.push_back(std::move(gameObject));
+    treeChanged = true;
+    return added;
+}
+
+GameObject *Scene::find(const std::string &name) const
+{
+    auto found = gameObjectsByName.find(name);
+    return found == gameObjectsByName.end() ? nullptr : found->second;
+}
+
+void Scene::clear()
+{
+    gameObjects.clear();
+    gameObjectsByName.clear();
+    movedObjects.clear();
+    loadingObjects.clear();
+    tree.clear();
+    rebuiltAreaRatio = 0.0f;
+    treeChanged = false;
+}
+
+void Scene::onTransformChanged(GameObject &gameObject)
+{
+    // Un objet déplacé plusieurs fois dans la même frame n'est ajouté qu'une fois
+    if (gameObject.transformChanged)
+        return;
+    gameObject.transformChanged = true;
+    movedObjects.push_back(&gameObject);
+}
+
+void Scene::update()
+{
+    // Un modèle qui vient de finir de charger remplace le cube de remplacement : sa boîte change
+    auto loaded = std::remove_if(loadingObjects.begin(), loadingObjects.end(), [this](GameObject *gameObject)
+                                 {
+        if (gameObject->getLoadState() == GameObject::LoadState::Loading)
+            return false;
+        onTransformChanged(*gameObject);
+        return true; });
+    loadingObjects.erase(loaded, loadingObjects.end());
+
+    for (GameObject *gameObject : movedObjects)
+    {
+        gameObject->transformChanged = false;
+        gameObject->updateWorldBounds();
+        if (tree.moveProxy(gameObject->bvhProxy, gameObject->getWorldBounds()))
+            treeChanged = true;
+    }
+    movedObjects.clear();
+
+    if (!treeChanged)
+        return;
+    treeChanged = false;
+
+    // Les insertions successives dégradent l'arbre : au-delà du seuil, on le reconstruit entièrement
+    if (rebuiltAreaRatio == 0.0f || tree.getAreaRatio() > rebuiltAreaRatio * SCENE_BVH_REBUILD_RATIO)
+    {
+        tree.rebuild();
+        rebuiltAreaRatio = tree.getAreaRatio();
+    }
+}
+
+void Scene::copyResults(std::vector<GameObject *> &results) const
+{
+    for (void *userData : queryResults)
+        results.push_back(static_cast<GameObject *>(userData));
+}
+
+void Scene::queryFrustum(const Frustum &frustum, std::vector<GameObject *> &results) const
+{
+    queryResults.clear();
+    tree.queryFrustum(frustum, queryResults);
+    copyResults(results);
+}
+
+void Scene::querySphere(const glm::vec3 &center, float radius, std::vector<GameObject *> &results) const
+{
+    queryResults.clear();
+    tree.querySphere(center, radius, queryResults);
+    copyResults(results);
+}
+
+GameObject *Scene::raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, float *hitDistance) const
+{
+    return static_cast<GameObject *>(tree.raycast(origin, direction, maxDistance, hitDistance));
+}
+
+void Scene::queryNearest(const glm::vec3 &point, size_t k, std::vector<GameObject *> &results) const
+{
+    queryResults.clear();
+    tree.queryNearest(point, k, queryResults);
+    copyResults(results);
+}
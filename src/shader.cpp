@@ -1,16 +1,73 @@
 #include <glad/glad.h>
+#include <chrono>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
 
 #include "shader.hpp"
+#include "glState.hpp"
+#include "programCache.hpp"
+
+// Remplace les lignes #include "fichier" par le contenu du fichier (chemin relatif au dossier du shader), récursivement
+static std::string expandIncludes(const std::string &source, const std::string &directory)
+{
+    std::istringstream sourceStream(source);
+    std::stringstream result;
+    std::string line;
+    while (std::getline(sourceStream, line))
+    {
+        size_t lineStart = line.find_first_not_of(" \t");
+        size_t firstQuote = line.find('"');
+        size_t lastQuote = line.rfind('"');
+        if (lineStart == std::string::npos || line.compare(lineStart, 8, "#include") != 0 ||
+            firstQuote == std::string::npos || lastQuote <= firstQuote)
+        {
+            result << line << '\n';
+            continue;
+        }
+
+        std::string includePath = directory + line.substr(firstQuote + 1, lastQuote - firstQuote - 1);
+        std::ifstream includeFile;
+        includeFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        includeFile.open(includePath);
+        std::stringstream includeStream;
+        includeStream << includeFile.rdbuf();
+        includeFile.close();
+
+        std::string includeDirectory = includePath.substr(0, includePath.find_last_of("/\\") + 1);
+        result << expandIncludes(includeStream.str(), includeDirectory);
+    }
+    return result.str();
+}
+
+// Renvoie le dossier d'un fichier, avec le séparateur final
+static std::string directoryOf(const std::string &path)
+{
+    size_t lastSlash = path.find_last_of("/\\");
+    return lastSlash == std::string::npos ? "" : path.substr(0, lastSlash + 1);
+}
+
+// Ajoute les defines juste après la ligne #version (qui doit rester la première instruction du shader)
+static std::string insertDefines(const std::string &source, const std::string &defineLines)
+{
+    if (defineLines.empty())
+        return source;
+    size_t version = source.find("#version");
+    size_t lineEnd = version == std::string::npos ? std::string::npos : source.find('\n', version);
+    if (lineEnd == std::string::npos)
+        return defineLines + source;
+    return source.substr(0, lineEnd + 1) + defineLines + source.substr(lineEnd + 1);
+}
 
 // Constructeur qui lit et construit le shader
-Shader::Shader(const GLchar *vertexPath, const GLchar *fragmentPath)
+Shader::Shader(const GLchar *vertexPath, const GLchar *fragmentPath, const std::vector<std::string> &defines)
 {
+    auto start = std::chrono::steady_clock::now();
     // 1. récupère le code du vertex/fragment shader depuis filePath
     std::string vertexCode;
     std::string fragmentCode;
+    std::string defineLines;
     std::ifstream vShaderFile;
     std::ifstream fShaderFile;
     // s'assure que les objets ifstream peuvent envoyer des exceptions:
@@ -31,53 +88,89 @@ Shader::Shader(const GLchar *vertexPath, const GLchar *fragmentPath)
         // conversion des flux en string
         vertexCode = vShaderStream.str();
         fragmentCode = fShaderStream.str();
+        // inclusion des fichiers communs (#include "fichier.glsl")
+        vertexCode = expandIncludes(vertexCode, directoryOf(vertexPath));
+        fragmentCode = expandIncludes(fragmentCode, directoryOf(fragmentPath));
+        // defines de la variante
+        for (const std::string &define : defines)
+            defineLines += "#define " + define + "\n";
+        vertexCode = insertDefines(vertexCode, defineLines);
+        fragmentCode = insertDefines(fragmentCode, defineLines);
     }
     catch (std::ifstream::failure e)
     {
         std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
     }
+    // 2. charge le programme depuis le cache s'il a déjà été compilé avec les mêmes sources et le même driver
+    ID = glCreateProgram();
+    cacheKey = ProgramCache::makeKey(vertexCode, fragmentCode, defineLines);
+    if (ProgramCache::load(ID, cacheKey))
+    {
+        cacheUniformLocations();
+        compileTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return;
+    }
+
+    // 3. sinon, envoie la compilation et l'édition de liens au driver. Leur statut n'est pas lu ici pour ne pas
+    // attendre le driver (avec GL_KHR_parallel_shader_compile, tous les programmes se compilent en même temps).
     // convertion des string en const char*
     const char *vShaderCode = vertexCode.c_str();
     const char *fShaderCode = fragmentCode.c_str();
 
-    // 2. compiler les shaders
-    unsigned int vertex, fragment;
+    // vertex shader
+    pendingVertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(pendingVertex, 1, &vShaderCode, NULL);
+    glCompileShader(pendingVertex);
+
+    // Création du fragment shader
+    pendingFragment = glCreateShader(GL_FRAGMENT_SHADER);
+    // On donne son code source au fragment shader via son identifiant
+    glShaderSource(pendingFragment, 1, &fShaderCode, NULL);
+    // On compile le fragment shader
+    glCompileShader(pendingFragment);
+
+    // program shader
+    glAttachShader(ID, pendingVertex);
+    glAttachShader(ID, pendingFragment);
+    ProgramCache::prepareLink(ID);
+    glLinkProgram(ID);
+    linkPending = true;
+    submitTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    compileTime = submitTime;
+}
+
+bool Shader::isReady() const
+{
+    return !linkPending || ProgramCache::isLinkCompleted(ID);
+}
+
+// Attend la fin de la compilation, affiche les erreurs, puis met le programme en cache
+void Shader::finishLink() const
+{
+    if (!linkPending)
+        return;
+    linkPending = false;
+
+    auto start = std::chrono::steady_clock::now();
     int success;
     char infoLog[512];
 
-    // vertex shader
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
     // affiche les erreurs de compilation si besoin
-    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+    glGetShaderiv(pendingVertex, GL_COMPILE_STATUS, &success);
     if (!success)
     {
-        glGetShaderInfoLog(vertex, 512, NULL, infoLog);
+        glGetShaderInfoLog(pendingVertex, 512, NULL, infoLog);
         std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
                   << infoLog << std::endl;
     };
-
-    // Création du fragment shader
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    // On donne son code source au fragment shader via son identifiant
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    // On compile le fragment shader
-    glCompileShader(fragment);
     // On vérifie que la compilation s'est bien passée
-    glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
+    glGetShaderiv(pendingFragment, GL_COMPILE_STATUS, &success);
     if (!success)
     {
-        glGetShaderInfoLog(fragment, 512, NULL, infoLog);
+        glGetShaderInfoLog(pendingFragment, 512, NULL, infoLog);
         std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
                   << infoLog << std::endl;
     }
-
-    // program shader
-    ID = glCreateProgram();
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
-    glLinkProgram(ID);
     // affiche les erreurs d'édition de liens si besoin
     glGetProgramiv(ID, GL_LINK_STATUS, &success);
     if (!success)
@@ -86,20 +179,93 @@ Shader::Shader(const GLchar *vertexPath, const GLchar *fragmentPath)
         std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
                   << infoLog << std::endl;
     }
+    double waitTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    ProgramCache::addCompileTimes(submitTime, waitTime);
+    compileTime += waitTime;
 
     // supprime les shaders qui sont maintenant liés dans le programme et qui ne sont plus nécessaires
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+    glDetachShader(ID, pendingVertex);
+    glDetachShader(ID, pendingFragment);
+    glDeleteShader(pendingVertex);
+    glDeleteShader(pendingFragment);
+    pendingVertex = pendingFragment = 0;
+
+    if (success)
+        ProgramCache::store(ID, cacheKey);
+    // on récupère une fois pour toutes les locations des uniforms actifs
+    cacheUniformLocations();
+}
+
+// Remplit la table nom -> location des uniforms actifs du programme
+void Shader::cacheUniformLocations() const
+{
+    uniformLocations.clear();
+
+    GLint uniformCount = 0;
+    GLint maxNameLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &uniformCount);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::vector<GLchar> nameBuffer(maxNameLength > 0 ? maxNameLength : 1);
+    for (GLint i = 0; i < uniformCount; i++)
+    {
+        GLsizei nameLength = 0;
+        GLint arraySize = 0;
+        GLenum type;
+        glGetActiveUniform(ID, (GLuint)i, (GLsizei)nameBuffer.size(), &nameLength, &arraySize, &type, nameBuffer.data());
+
+        std::string name(nameBuffer.data(), nameLength);
+        GLint location = glGetUniformLocation(ID, name.c_str());
+        // Les uniforms des blocs (UBO) n'ont pas de location
+        if (location < 0)
+            continue;
+        uniformLocations[name] = location;
+
+        // Pour un tableau de types de base, le driver ne renvoie que "nom[0]" :
+        // on enregistre aussi "nom" et chacun des éléments "nom[i]"
+        size_t bracket = name.rfind("[0]");
+        if (bracket != std::string::npos && bracket + 3 == name.size())
+        {
+            std::string baseName = name.substr(0, bracket);
+            uniformLocations[baseName] = location;
+            for (GLint element = 1; element < arraySize; element++)
+            {
+                std::string elementName = baseName + "[" + std::to_string(element) + "]";
+                uniformLocations[elementName] = glGetUniformLocation(ID, elementName.c_str());
+            }
+        }
+    }
+}
+
+// Relie un bloc d'uniforms (UBO) du programme à un point de liaison (ignoré si le bloc n'existe pas)
+void Shader::bindUniformBlock(const std::string &blockName, GLuint bindingPoint) const
+{
+    finishLink();
+    GLuint blockIndex = glGetUniformBlockIndex(ID, blockName.c_str());
+    if (blockIndex != GL_INVALID_INDEX)
+        glUniformBlockBinding(ID, blockIndex, bindingPoint);
+}
+
+// Renvoie la location d'un uniform depuis la table (-1 si l'uniform n'est pas actif, ce qu'OpenGL ignore)
+GLint Shader::getUniformLocation(const std::string &name) const
+{
+    finishLink();
+    auto it = uniformLocations.find(name);
+    if (it == uniformLocations.end())
+        return -1;
+    return it->second;
 }
 
 // Suppression du shader program
 void Shader::deleteProgram()
 {
-    glDeleteProgram(ID);
+    finishLink();
+    GLState::deleteProgram(ID);
 }
 
 // Activation du shader program
 void Shader::use()
 {
-    glUseProgram(ID);
+    finishLink();
+    GLState::useProgram(ID);
 }
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "shaderVariants.hpp"
+
+#include <iostream>
+
+// Clé d'éclairage sans define : nombre de lumières et mode lus dans le bloc Lights
+static const uint32_t LIGHTING_DYNAMIC = 0;
+static const uint32_t LIGHTING_CLUSTERED = 1;
+static const uint32_t LIGHTING_FIXED = 2;
+
+void ShaderVariants::create(const std::string &vertexPath, const std::string &fragmentPath, std::function<void(Shader &)> setup)
+{
+    this->vertexPath = vertexPath;
+    this->fragmentPath = fragmentPath;
+    this->setup = std::move(setup);
+}
+
+void ShaderVariants::deleteResources()
+{
+    for (auto &entry : variants)
+        entry.second.shader->deleteProgram();
+    variants.clear();
+    current = nullptr;
+}
+
+void ShaderVariants::setLighting(int pointLightCount, int spotLightCount, bool clustered)
+{
+    lightingDefines.clear();
+    if (clustered)
+    {
+        // Seules les lumières du cluster du fragment sont parcourues
+        lightingKey = LIGHTING_CLUSTERED;
+        lightingDefines.push_back("LIGHTING_CLUSTERED");
+    }
+    else if (pointLightCount <= SHADER_VARIANT_MAX_FIXED_LIGHTS && spotLightCount <= SHADER_VARIANT_MAX_FIXED_LIGHTS)
+    {
+        // Peu de lumières : boucles de taille fixe (une boucle vide disparaît)
+        lightingKey = LIGHTING_FIXED | (uint32_t)pointLightCount << 8 | (uint32_t)spotLightCount << 16;
+        lightingDefines.push_back("NUM_POINT_LIGHTS " + std::to_string(pointLightCount));
+        lightingDefines.push_back("NUM_SPOT_LIGHTS " + std::to_string(spotLightCount));
+    }
+    else
+    {
+        lightingKey = LIGHTING_DYNAMIC;
+    }
+}
+
+ShaderVariants::Variant &ShaderVariants::find(uint32_t features, uint32_t lighting, const std::vector<std::string> &defines)
+{
+    uint64_t key = (uint64_t)lighting << 32 | features;
+    auto found = variants.find(key);
+    if (found != variants.end())
+        return found->second;
+
+    std::vector<std::string> variantDefines;
+    if (features & SHADER_FEATURE_SPECULAR_MAP)
+        variantDefines.push_back("HAS_SPECULAR_MAP");
+    variantDefines.insert(variantDefines.end(), defines.begin(), defines.end());
+
+    Variant &variant = variants[key];
+    variant.shader = std::make_unique<Shader>(vertexPath.c_str(), fragmentPath.c_str(), variantDefines);
+    variant.setupPending = true;
+    for (const std::string &define : variantDefines)
+        variant.description += (variant.description.empty() ? "" : ", ") + define;
+    if (variant.description.empty())
+        variant.description = "aucun define";
+    return variant;
+}
+
+bool ShaderVariants::finishVariant(Variant &variant, bool wait)
+{
+    if (!variant.setupPending)
+        return true;
+    // Avec GL_KHR_parallel_shader_compile, on sait si l'édition de liens est finie sans l'attendre
+    if (!wait && !variant.shader->isReady())
+        return false;
+    // setup lit le résultat de l'édition de liens (et l'attend si besoin)
+    if (setup)
+        setup(*variant.shader);
+    variant.setupPending = false;
+    return true;
+}
+
+ShaderVariants::Variant &ShaderVariants::find(uint32_t features)
+{
+    if (!enabled)
+        return getDefaultVariant();
+    Variant &variant = find(features, lightingKey, lightingDefines);
+    // Variante encore en compilation : le programme complet la remplace avec le même rendu (le mesh lie une texture
+    // spéculaire noire quand il n'en a pas), la frame n'attend pas le driver et rien ne change quand la variante est prête
+    if (!finishVariant(variant, false))
+        return getDefaultVariant();
+    return variant;
+}
+
+ShaderVariants::Variant &ShaderVariants::getDefaultVariant()
+{
+    Variant &variant = find(SHADER_FEATURE_ALL, LIGHTING_DYNAMIC, {});
+    finishVariant(variant, true);
+    return variant;
+}
+
+void ShaderVariants::prepare()
+{
+    // Le programme complet est envoyé en premier : il remplace les variantes tant qu'elles ne sont pas prêtes
+    find(SHADER_FEATURE_ALL, LIGHTING_DYNAMIC, {});
+    if (enabled)
+    {
+        // Toutes les compilations sont envoyées avant d'en attendre une : le driver peut les compiler en parallèle
+        for (uint32_t features = 0; features <= SHADER_FEATURE_ALL; features++)
+        {
+            if (features & ~SHADER_FEATURE_ALL)
+                continue;
+            find(features, lightingKey, lightingDefines);
+        }
+    }
+    // Seul le programme complet est attendu, les variantes sont terminées quand le driver les a finies
+    getDefaultVariant();
+}
+
+void ShaderVariants::finish()
+{
+    for (auto &entry : variants)
+        finishVariant(entry.second, true);
+}
+
+Shader &ShaderVariants::get(uint32_t features)
+{
+    return *find(features).shader;
+}
+
+Shader &ShaderVariants::getDefault()
+{
+    return *getDefaultVariant().shader;
+}
+
+Shader &ShaderVariants::use(uint32_t features)
+{
+    current = &find(features);
+    current->shader->use();
+    return *current->shader;
+}
+
+void ShaderVariants::addDraws(size_t drawCalls)
+{
+    if (current)
+        current->drawCalls += drawCalls;
+}
+
+void ShaderVariants::printStats() const
+{
+    std::cout << "Variantes de " << fragmentPath << " : " << variants.size() << std::endl;
+    for (const auto &entry : variants)
+    {
+        const Variant &variant = entry.second;
+        std::cout << "  [" << variant.description << "] programme " << variant.shader->ID << ", compile en "
+                  << variant.shader->getCompileTime() << " ms, " << variant.drawCalls << " draws" << std::endl;
+    }
+}
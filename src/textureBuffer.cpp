@@ -0,0 +1,50 @@
+#include "textureBuffer.hpp"
+#include "glState.hpp"
+
+#include <cstddef>
+
+// Crée le buffer et la texture qui l'expose avec le format de texel internalFormat
+void TextureBuffer::create(GLenum internalFormat)
+{
+    this->internalFormat = internalFormat;
+    glGenBuffers(1, &bufferID);
+    glGenTextures(1, &textureID);
+}
+
+// Ré-alloue le buffer à la taille size (le contenu précédent est perdu)
+void TextureBuffer::resize(GLsizeiptr size)
+{
+    this->size = size;
+    GLState::bindBuffer(GL_TEXTURE_BUFFER, bufferID);
+    glBufferData(GL_TEXTURE_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+    GLState::bindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    // La texture doit être ré-attachée au buffer après une ré-allocation
+    GLState::bindTexture(0, GL_TEXTURE_BUFFER, textureID);
+    glTexBuffer(GL_TEXTURE_BUFFER, internalFormat, bufferID);
+    GLState::bindTexture(0, GL_TEXTURE_BUFFER, 0);
+}
+
+// Ré-envoie uniquement la plage [offset, offset + size) du buffer
+void TextureBuffer::update(GLintptr offset, GLsizeiptr size, const void *data)
+{
+    GLState::bindBuffer(GL_TEXTURE_BUFFER, bufferID);
+    glBufferSubData(GL_TEXTURE_BUFFER, offset, size, data);
+    GLState::bindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+// Lie la texture à l'unité de texture unit
+void TextureBuffer::bind(GLuint unit) const
+{
+    GLState::bindTexture(unit, GL_TEXTURE_BUFFER, textureID);
+}
+
+// Suppression du buffer et de la texture
+void TextureBuffer::deleteBuffer()
+{
+    GLState::deleteTextures(1, &textureID);
+    GLState::deleteBuffers(1, &bufferID);
+    textureID = 0;
+    bufferID = 0;
+    size = 0;
+}
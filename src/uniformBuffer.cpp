@@ -0,0 +1,41 @@
+#include "uniformBuffer.hpp"
+#include "glState.hpp"
+
+#include <vector>
+
+// Alloue le buffer (contenu initialisé à zéro) et l'attache au point de liaison
+void UniformBuffer::create(GLsizeiptr size, GLuint bindingPoint)
+{
+    this->size = size;
+    this->bindingPoint = bindingPoint;
+
+    std::vector<unsigned char> zeros(size, 0);
+    glGenBuffers(1, &ID);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, ID);
+    glBufferData(GL_UNIFORM_BUFFER, size, zeros.data(), GL_DYNAMIC_DRAW);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // Tous les programmes dont le bloc est relié à ce point de liaison liront ce buffer
+    GLState::bindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, ID);
+}
+
+// Ré-envoie uniquement la plage [offset, offset + size) du buffer
+void UniformBuffer::update(GLintptr offset, GLsizeiptr size, const void *data)
+{
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, ID);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+// Relie le bloc blockName du shader au point de liaison de ce buffer
+void UniformBuffer::bindToShader(const Shader &shader, const std::string &blockName) const
+{
+    shader.bindUniformBlock(blockName, bindingPoint);
+}
+
+// Suppression du buffer
+void UniformBuffer::deleteBuffer()
+{
+    GLState::deleteBuffers(1, &ID);
+    ID = 0;
+}
@@ -0,0 +1,61 @@
+#include "vertexFormat.hpp"
+
+#include <glm/gtc/packing.hpp>
+#include <algorithm>
+#include <cmath>
+
+PositionDecode computePositionDecode(PositionEncoding encoding, const AABB &bounds)
+{
+    if (encoding == PositionEncoding::HalfFloat)
+        return {glm::vec3(0.0f), glm::vec3(1.0f)};
+    // Les valeurs 0 à 65535 couvrent la boîte, normalisées en 0 à 1 par le GPU
+    return {bounds.min, bounds.max - bounds.min};
+}
+
+void packPosition(const glm::vec3 &position, PositionEncoding encoding, const PositionDecode &decode, uint16_t out[4])
+{
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (encoding == PositionEncoding::HalfFloat)
+        {
+            out[axis] = packHalf(position[axis]);
+            continue;
+        }
+        // Boîte plate sur cet axe : toutes les positions valent offset
+        float t = decode.scale[axis] > 0.0f ? (position[axis] - decode.offset[axis]) / decode.scale[axis] : 0.0f;
+        out[axis] = (uint16_t)std::lround(std::clamp(t, 0.0f, 1.0f) * 65535.0f);
+    }
+    out[3] = 0;
+}
+
+static int16_t packSnorm16(float value)
+{
+    return (int16_t)std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f);
+}
+
+void packNormal(const glm::vec3 &normal, int16_t out[2])
+{
+    float sum = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (sum <= 0.0f)
+    {
+        // Normale nulle (mesh sans normales) : on garde une direction valide
+        out[0] = 0;
+        out[1] = 0;
+        return;
+    }
+    glm::vec2 p = glm::vec2(normal.x, normal.y) / sum;
+    // Hémisphère inférieur : on replie les triangles de l'octaèdre sur les coins du carré
+    if (normal.z < 0.0f)
+    {
+        glm::vec2 folded = 1.0f - glm::abs(glm::vec2(p.y, p.x));
+        p.x = p.x >= 0.0f ? folded.x : -folded.x;
+        p.y = p.y >= 0.0f ? folded.y : -folded.y;
+    }
+    out[0] = packSnorm16(p.x);
+    out[1] = packSnorm16(p.y);
+}
+
+uint16_t packHalf(float value)
+{
+    return glm::packHalf1x16(value);
+}
@@ -0,0 +1,72 @@
+#include "workerPool.hpp"
+
+WorkerPool::WorkerPool(unsigned int threadCount)
+{
+    for (unsigned int i = 1; i < threadCount; i++)
+        workers.emplace_back(&WorkerPool::workerLoop, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+void WorkerPool::run(unsigned int taskCount, const std::function<void(unsigned int)> &task)
+{
+    if (workers.empty() || taskCount <= 1)
+    {
+        for (unsigned int i = 0; i < taskCount; i++)
+            task(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task = &task;
+        this->taskCount = taskCount;
+        nextTask = 0;
+        activeWorkers = (unsigned int)workers.size();
+        generation++;
+    }
+    workAvailable.notify_all();
+    executeTasks();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    workDone.wait(lock, [this]
+                  { return activeWorkers == 0; });
+    this->task = nullptr;
+}
+
+// Prend les tâches une par une jusqu'à ce qu'il n'en reste plus
+void WorkerPool::executeTasks()
+{
+    unsigned int index;
+    while ((index = nextTask.fetch_add(1)) < taskCount)
+        (*task)(index);
+}
+
+void WorkerPool::workerLoop()
+{
+    unsigned int seenGeneration = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workAvailable.wait(lock, [this, seenGeneration]
+                               { return stopping || generation != seenGeneration; });
+            if (stopping)
+                return;
+            seenGeneration = generation;
+        }
+        executeTasks();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--activeWorkers == 0)
+            workDone.notify_one();
+    }
+}
@@ -0,0 +1,110 @@
+// Benchmark de l'occlusion culling logiciel sur une scène synthétique, sans fenêtre ni contexte OpenGL.
+// Exécutable séparé (tâche "Benchmark occlusion") : OcclusionBenchmark [frames] [threads]
+// Affiche la fraction d'objets cachés et le temps de rastérisation par frame, pour le chemin scalaire et le chemin AVX2.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "frustum.hpp"
+#include "occlusionScene.hpp"
+
+int main(int argc, char **argv)
+{
+    int frameCount = argc > 1 ? std::atoi(argv[1]) : 0;
+    if (frameCount <= 0)
+        frameCount = 240;
+    int threadArgument = argc > 2 ? std::atoi(argv[2]) : 0;
+    unsigned int threadCount = threadArgument > 0 ? (unsigned int)threadArgument : std::max(1u, std::thread::hardware_concurrency());
+
+    // Scène : une grille de petites boîtes et quelques grands murs, vue par une caméra qui tourne autour
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    OccluderMesh cube = makeCubeOccluder();
+    std::vector<glm::mat4> walls;
+    for (int i = 0; i < 8; i++)
+    {
+        glm::vec3 position((unit(generator) - 0.5f) * 40.0f, 2.0f, (unit(generator) - 0.5f) * 40.0f);
+        glm::mat4 wall = glm::translate(glm::mat4(1.0f), position);
+        wall = glm::rotate(wall, unit(generator) * 3.14159f, glm::vec3(0.0f, 1.0f, 0.0f));
+        walls.push_back(glm::scale(wall, glm::vec3(12.0f, 4.0f, 0.5f)));
+    }
+    std::vector<AABB> boxes;
+    for (int x = -30; x <= 30; x += 2)
+    {
+        for (int z = -30; z <= 30; z += 2)
+            boxes.push_back(makeBox(glm::vec3((float)x, 0.5f, (float)z), glm::vec3(0.5f + unit(generator))));
+    }
+
+    struct PathResult
+    {
+        double rasterizeTime = 0.0;
+        double testTime = 0.0;
+        size_t tested = 0;
+        size_t occluded = 0;
+        std::vector<uint8_t> decisions;
+    };
+    auto runPath = [&](bool useAVX2)
+    {
+        PathResult result;
+        OcclusionBuffer buffer(256, 144);
+        buffer.setUseAVX2(useAVX2);
+        std::vector<uint8_t> inFrustum(boxes.size());
+        for (int frame = 0; frame < frameCount; frame++)
+        {
+            float angle = 6.2831853f * frame / frameCount;
+            glm::vec3 eye(std::cos(angle) * 35.0f, 3.0f, std::sin(angle) * 35.0f);
+            glm::mat4 viewProjection = makeProjection() * glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+            buffer.begin(viewProjection);
+            for (const glm::mat4 &wall : walls)
+                buffer.addOccluder(cube, wall);
+            buffer.rasterize(threadCount);
+            result.rasterizeTime += buffer.getRasterizeTime();
+
+            // Comme dans le rendu, seules les boîtes dans le frustum sont testées
+            Frustum frustum(viewProjection);
+            frustum.intersects(boxes.data(), boxes.size(), inFrustum.data());
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < boxes.size(); i++)
+            {
+                if (!inFrustum[i])
+                    continue;
+                bool visible = buffer.isVisible(boxes[i]);
+                result.tested++;
+                result.occluded += visible ? 0 : 1;
+                result.decisions.push_back(visible);
+            }
+            result.testTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        std::cout << (useAVX2 ? "AVX2     " : "Scalaire ") << ": "
+                  << "rasterisation " << result.rasterizeTime / frameCount << " ms/frame, "
+                  << "tests " << result.testTime / frameCount << " ms/frame, "
+                  << "objets caches " << 100.0 * result.occluded / std::max<size_t>(result.tested, 1) << " % "
+                  << "(" << result.occluded << " / " << result.tested << ")" << std::endl;
+        return result;
+    };
+
+    std::cout << frameCount << " frames, " << walls.size() * cube.indices.size() / 3 << " triangles d'occulteurs, "
+              << boxes.size() << " boites, " << threadCount << " threads" << std::endl;
+    PathResult scalar = runPath(false);
+    if (OcclusionBuffer::supportsAVX2())
+    {
+        PathResult avx2 = runPath(true);
+        size_t differences = 0;
+        for (size_t i = 0; i < scalar.decisions.size() && i < avx2.decisions.size(); i++)
+            differences += scalar.decisions[i] != avx2.decisions[i];
+        std::cout << "Decisions differentes entre les deux chemins : " << differences << std::endl;
+    }
+    else
+    {
+        std::cout << "AVX2 non supporte par ce processeur" << std::endl;
+    }
+    return 0;
+}
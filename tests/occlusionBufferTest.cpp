@@ -0,0 +1,89 @@
+// Test de l'occlusion culling logiciel sur des cas dont on connaît la réponse.
+// Exécutable séparé (tâche "Test occlusion") : le code de sortie est différent de 0 si un cas échoue.
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+#include "occlusionScene.hpp"
+
+struct Check
+{
+    const char *name;
+    AABB box;
+    bool expectedVisible;
+};
+
+static int failures = 0;
+
+static void expect(const OcclusionBuffer &buffer, const Check &check, const char *path, unsigned int threadCount)
+{
+    bool visible = buffer.isVisible(check.box);
+    if (visible == check.expectedVisible)
+        return;
+    std::cout << "ERROR::OCCLUSION_TEST::" << path << "::" << threadCount << "_THREADS::" << check.name
+              << " : attendu " << (check.expectedVisible ? "visible" : "cachee") << std::endl;
+    failures++;
+}
+
+// Un mur devant la caméra et des boîtes autour
+static void testWall(bool useAVX2, unsigned int threadCount)
+{
+    const char *path = useAVX2 ? "AVX2" : "SCALAIRE";
+    OccluderMesh cube = makeCubeOccluder();
+    OcclusionBuffer buffer(256, 144);
+    buffer.setUseAVX2(useAVX2);
+    buffer.begin(makeProjection() * glm::lookAt(glm::vec3(0.0f, 0.0f, 5.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+    buffer.addOccluder(cube, glm::scale(glm::mat4(1.0f), glm::vec3(4.0f, 4.0f, 0.2f)));
+    buffer.rasterize(threadCount);
+
+    const Check checks[] = {
+        {"boite derriere le mur", makeBox(glm::vec3(0.0f, 0.0f, -3.0f), glm::vec3(0.5f)), false},
+        {"grande boite derriere le mur", makeBox(glm::vec3(0.0f, 0.0f, -10.0f), glm::vec3(3.0f)), false},
+        {"boite devant le mur", makeBox(glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(0.5f)), true},
+        {"boite a cote du mur", makeBox(glm::vec3(4.0f, 0.0f, -3.0f), glm::vec3(0.5f)), true},
+        {"boite qui depasse du mur", makeBox(glm::vec3(0.0f, 0.0f, -3.0f), glm::vec3(8.0f, 0.5f, 0.5f)), true},
+        {"boite qui traverse le mur", makeBox(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.5f)), true},
+        {"boite qui touche la camera", makeBox(glm::vec3(0.0f, 0.0f, 5.0f), glm::vec3(1.0f)), true},
+    };
+    for (const Check &check : checks)
+        expect(buffer, check, path, threadCount);
+}
+
+// Sans occulteur, tout ce qui est dans le champ est visible
+static void testEmpty(bool useAVX2, unsigned int threadCount)
+{
+    const char *path = useAVX2 ? "AVX2" : "SCALAIRE";
+    OcclusionBuffer buffer(256, 144);
+    buffer.setUseAVX2(useAVX2);
+    buffer.begin(makeProjection() * glm::lookAt(glm::vec3(0.0f, 0.0f, 5.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+    buffer.rasterize(threadCount);
+
+    const Check checks[] = {
+        {"boite proche sans occulteur", makeBox(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.5f)), true},
+        {"boite lointaine sans occulteur", makeBox(glm::vec3(0.0f, 0.0f, -80.0f), glm::vec3(0.5f)), true},
+    };
+    for (const Check &check : checks)
+        expect(buffer, check, path, threadCount);
+}
+
+int main()
+{
+    // Un seul thread, puis la rastérisation répartie sur plusieurs threads
+    unsigned int threadCounts[2] = {1, std::max(2u, std::thread::hardware_concurrency())};
+    for (unsigned int threadCount : threadCounts)
+    {
+        testWall(false, threadCount);
+        testEmpty(false, threadCount);
+        if (OcclusionBuffer::supportsAVX2())
+        {
+            testWall(true, threadCount);
+            testEmpty(true, threadCount);
+        }
+    }
+    if (!OcclusionBuffer::supportsAVX2())
+        std::cout << "AVX2 non supporte par ce processeur : seul le chemin scalaire est teste" << std::endl;
+
+    std::cout << "Tests de l'occlusion : " << (failures == 0 ? "OK" : "ECHEC") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
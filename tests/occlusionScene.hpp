@@ -0,0 +1,40 @@
+#ifndef OCCLUSIONSCENE_HPP
+#define OCCLUSIONSCENE_HPP
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "bounds.hpp"
+#include "occlusionBuffer.hpp"
+
+// Éléments communs au test et au benchmark de l'occlusion culling (sans fenêtre ni contexte OpenGL)
+
+// Cube unité centré sur l'origine (8 sommets, 12 triangles)
+inline OccluderMesh makeCubeOccluder()
+{
+    OccluderMesh cube;
+    for (int corner = 0; corner < 8; corner++)
+        cube.vertices.push_back(glm::vec3((corner & 1) ? 0.5f : -0.5f, (corner & 2) ? 0.5f : -0.5f, (corner & 4) ? 0.5f : -0.5f));
+    const unsigned int faces[6][4] = {{0, 2, 6, 4}, {1, 5, 7, 3}, {0, 4, 5, 1}, {2, 3, 7, 6}, {0, 1, 3, 2}, {4, 6, 7, 5}};
+    for (const auto &face : faces)
+    {
+        const unsigned int quad[6] = {face[0], face[1], face[2], face[0], face[2], face[3]};
+        cube.indices.insert(cube.indices.end(), quad, quad + 6);
+    }
+    return cube;
+}
+
+inline AABB makeBox(const glm::vec3 &center, const glm::vec3 &size)
+{
+    AABB box;
+    box.min = center - size * 0.5f;
+    box.max = center + size * 0.5f;
+    return box;
+}
+
+inline glm::mat4 makeProjection()
+{
+    return glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+}
+
+#endif